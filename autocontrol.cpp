@@ -0,0 +1,163 @@
+#include "autocontrol.h"
+#include <cmath>
+
+// --- SoftwareAutoExposure ---
+
+void SoftwareAutoExposure::setRange(const PropertyRange &range) {
+  m_range = range;
+  m_value = qBound(range.min, range.current, range.max);
+  m_wait = 0;
+  m_converged = false;
+}
+
+bool SoftwareAutoExposure::update(const ImageStatistics &stats, double &exposure) {
+  if (m_wait > 0) {
+    --m_wait;
+    return false;
+  }
+  double ratio = m_target / qMax(1.0, stats.mean);
+  // Con muchas zonas quemadas la media engaña: nunca se sube y se baja al menos un poco
+  if (stats.clippedHigh > 0.02) {
+    ratio = qMin(ratio, 0.8);
+  }
+  if (std::abs(std::log(ratio)) < std::log(1 + kDeadband)) {
+    m_converged = true;
+    return false;
+  }
+  m_converged = false;
+
+  const double stops = kGain * std::log2(ratio);
+  const bool logScale = m_range.min < 0;
+  const double next = qBound(
+      m_range.min, double(qRound(logScale ? m_value + stops : m_value * std::exp2(stops))),
+      m_range.max);
+  if (next == m_value) {
+    // En el límite del rango o por debajo de un paso del driver
+    if (logScale || next == m_range.min || next == m_range.max) {
+      return false;
+    }
+    const double nudged = qBound(m_range.min, m_value + (ratio > 1 ? 1 : -1), m_range.max);
+    if (nudged == m_value) {
+      return false;
+    }
+    m_value = nudged;
+  } else {
+    m_value = next;
+  }
+  m_wait = kSettleFrames;
+  exposure = m_value;
+  return true;
+}
+
+// --- SoftwareAutoFocus ---
+
+void SoftwareAutoFocus::setRange(const PropertyRange &range) {
+  m_range = range;
+  m_position = qBound(range.min, range.current, range.max);
+  m_state = State::Idle;
+}
+
+void SoftwareAutoFocus::trigger() {
+  const double span = m_range.max - m_range.min;
+  if (span <= 0) {
+    return;
+  }
+  m_state = State::Searching;
+  m_sweeping = true;
+  m_step = qMax(1.0, span / kCoarseSteps);
+  m_minStep = qMax(1.0, span / kFineSteps);
+  m_direction = 1;
+  m_best = -1;
+  m_position = m_range.min;
+  m_bestPosition = m_position;
+  m_worse = 0;
+  m_wait = 0;
+  m_moveNow = true;
+}
+
+void SoftwareAutoFocus::rescale() {
+  if (m_state == State::Locked) {
+    m_lockedSharpness = 0;
+  } else if (m_state == State::Searching) {
+    trigger();
+  }
+}
+
+bool SoftwareAutoFocus::update(const ImageStatistics &stats, double &focus) {
+  if (m_wait > 0) {
+    --m_wait;
+    return false;
+  }
+  const double sharpness = stats.sharpness;
+  switch (m_state) {
+  case State::Idle:
+    return false;
+  case State::Locked:
+    if (m_lockedSharpness <= 0) {
+      m_lockedSharpness = sharpness; // Primera medida ya en la posición final
+    } else if (sharpness < m_lockedSharpness * kRefocusRatio) {
+      trigger(); // La escena ha cambiado: buscar otra vez
+    }
+    return false;
+  case State::Searching:
+    break;
+  }
+
+  if (m_moveNow) {
+    // Recién empezada la búsqueda: primero ir al principio del recorrido
+    m_moveNow = false;
+    m_wait = kSettleFrames;
+    focus = m_position;
+    return true;
+  }
+
+  if (sharpness > m_best) {
+    m_best = sharpness;
+    m_bestPosition = m_position;
+    m_worse = 0;
+  } else if (!m_sweeping) {
+    ++m_worse;
+  }
+
+  if (m_sweeping) {
+    // Barrido grueso de todo el recorrido: en las zonas planas lejos del foco la subida de la
+    // colina no sabría hacia dónde ir
+    if (m_position + m_step <= m_range.max) {
+      m_position += m_step;
+      m_wait = kSettleFrames;
+      focus = m_position;
+      return true;
+    }
+    // Afinar alrededor del mejor punto del barrido
+    m_sweeping = false;
+    m_step /= 2;
+    m_direction = 1;
+    m_position = m_bestPosition;
+    m_worse = 0;
+  } else if (m_worse >= 2) {
+    // Dos medidas seguidas peores: el máximo ha quedado atrás. Se vuelve al mejor punto y se
+    // sigue en sentido contrario con la mitad de paso.
+    m_worse = 0;
+    m_direction = -m_direction;
+    m_step /= 2;
+    m_position = m_bestPosition;
+    if (m_step < m_minStep) {
+      m_state = State::Locked;
+      m_lockedSharpness = 0;
+      m_wait = kSettleFrames;
+      focus = m_position;
+      return true;
+    }
+  }
+
+  double next = m_position + m_direction * m_step;
+  if (next < m_range.min || next > m_range.max) {
+    // En un extremo del recorrido se da la vuelta
+    m_direction = -m_direction;
+    next = qBound(m_range.min, m_position + m_direction * m_step, m_range.max);
+  }
+  m_position = next;
+  m_wait = kSettleFrames;
+  focus = m_position;
+  return true;
+}
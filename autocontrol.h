@@ -0,0 +1,76 @@
+#ifndef AUTOCONTROL_H
+#define AUTOCONTROL_H
+
+#include "devicecapabilities.h"
+#include "framestatistics.h"
+
+// Exposición y enfoque automáticos por software, para cámaras sin modos automáticos fiables.
+//
+// Son bucles cerrados sobre ImageStatistics: cada update() recibe las estadísticas de un frame y,
+// si hay que mover el control, devuelve true con el nuevo valor en unidades del driver. Tras cada
+// cambio se ignoran unos frames mientras la cámara lo aplica. No usan hilos ni mutex: quien los
+// llama se encarga de serializar el acceso.
+
+// Lleva la luma media hacia un objetivo con pasos proporcionales al error en escala logarítmica
+class SoftwareAutoExposure {
+public:
+  // Con min < 0 se entiende que la exposición es log2 de segundos (DirectShow); si no, lineal
+  void setRange(const PropertyRange &range);
+  void setTarget(double meanLuma) { m_target = qBound(16.0, meanLuma, 240.0); }
+  double target() const { return m_target; }
+
+  bool update(const ImageStatistics &stats, double &exposure);
+  bool isConverged() const { return m_converged; }
+  double value() const { return m_value; }
+
+private:
+  static constexpr int kSettleFrames = 3;
+  static constexpr double kDeadband = 0.08; // Error relativo que se da por bueno
+  static constexpr double kGain = 0.6;      // Fracción del error que se corrige en cada paso
+
+  PropertyRange m_range;
+  double m_value = 0;
+  double m_target = 110;
+  int m_wait = 0;
+  bool m_converged = false;
+};
+
+// Enfoque por contraste: barre el recorrido con paso grueso, sube la colina de la nitidez desde el
+// mejor punto con pasos que se reducen a la mitad cada vez que se pasa del máximo, y vuelve a
+// buscar si la nitidez cae mucho una vez enfocado
+class SoftwareAutoFocus {
+public:
+  enum class State { Idle, Searching, Locked };
+
+  void setRange(const PropertyRange &range);
+  void trigger();
+  // Las medidas siguientes vienen de otra escala y no se comparan con las anteriores: si ya
+  // estaba enfocado toma la siguiente como referencia, y si estaba buscando vuelve a empezar
+  void rescale();
+
+  bool update(const ImageStatistics &stats, double &focus);
+  State state() const { return m_state; }
+  double value() const { return m_position; }
+
+private:
+  static constexpr int kSettleFrames = 2;
+  static constexpr int kCoarseSteps = 16; // Paso del barrido: 1/16 del recorrido
+  static constexpr int kFineSteps = 256;  // Paso mínimo antes de fijar el foco
+  static constexpr double kRefocusRatio = 0.6;
+
+  PropertyRange m_range;
+  State m_state = State::Idle;
+  double m_position = 0;
+  bool m_sweeping = false;
+  bool m_moveNow = false;
+  double m_step = 0;
+  double m_minStep = 1;
+  int m_direction = 1;
+  double m_best = -1;
+  double m_bestPosition = 0;
+  int m_worse = 0;
+  int m_wait = 0;
+  double m_lockedSharpness = 0;
+};
+
+#endif // AUTOCONTROL_H
@@ -0,0 +1,213 @@
+#include "batchprocessor.h"
+#include "filesource.h"
+#include "framerecorder.h"
+#include "framestages.h"
+#include "videofilesink.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QThread>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Trozo de frames consecutivos ya procesados, a la espera de escribirse en orden
+struct Chunk {
+  std::vector<cv::Mat> frames;
+  bool done = false;
+};
+
+// Nombre de salida: el del fichero sin extensión ni el %04d de las secuencias
+QString outputPathFor(const QString &input, const QString &outputDir) {
+  QString base = QFileInfo(input).completeBaseName();
+  base.remove(QRegularExpression("%0?\\d*d"));
+  if (base.isEmpty()) {
+    base = "secuencia";
+  }
+  // Sufijo para no pisar nunca la entrada si ya es un .avi dentro de outputDir
+  return QDir(outputDir).filePath(base + "_batch.avi");
+}
+
+} // namespace
+
+BatchProcessor::Result BatchProcessor::process(const QString &path) {
+  Result result;
+  result.input = path;
+  QElapsedTimer timer;
+  timer.start();
+
+  // Sondeo: número de frames, ritmo y tamaño del primero para repartir el trabajo
+  FileSource probe(path, false, false);
+  if (!probe.open()) {
+    result.error = "no se pudo abrir";
+    return result;
+  }
+  const double frameCount = probe.get(cv::CAP_PROP_FRAME_COUNT);
+  const double fps = probe.get(cv::CAP_PROP_FPS);
+  cv::Mat first;
+  if (!probe.grab() || !probe.retrieve(first) || first.empty()) {
+    result.error = "no tiene frames";
+    return result;
+  }
+  probe.release();
+
+  const int threads = m_config.threads > 0 ? m_config.threads : QThread::idealThreadCount();
+  const int window = 2 * threads; // Trozos en vuelo: procesándose o esperando a escribirse
+  int chunkFrames = m_config.chunkFrames;
+  if (chunkFrames <= 0) {
+    const qint64 frameBytes = qint64(first.total() * first.elemSize());
+    const qint64 budget = qint64(qMax(16, m_config.memoryBudgetMb)) * 1024 * 1024;
+    chunkFrames = int(qBound<qint64>(4, budget / (qint64(window) * frameBytes), 256));
+  }
+  // Si el contenedor no dice cuántos frames tiene no se puede saltar a ciegas: un solo trozo.
+  // El último trozo lee siempre hasta el final, por si la cuenta del contenedor se queda corta.
+  const qint64 total = frameCount >= 1 ? qint64(frameCount) : -1;
+  const int chunkCount = total > 0 ? int((total + chunkFrames - 1) / chunkFrames) : 1;
+  const int workerCount = qMax(1, qMin(threads, chunkCount));
+  result.chunks = chunkCount;
+  result.chunkFrames = chunkFrames;
+  result.threads = workerCount;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::vector<Chunk> chunks(chunkCount);
+  int nextChunk = 0;
+  int writtenChunks = 0;
+  bool abort = false;
+  QString workerError;
+  std::atomic<quint64> seeks{0};
+
+  auto worker = [&] {
+    // Cada hilo abre su propio lector y crea sus propias etapas, que guardan estado entre frames
+    FileSource source(path, false, false);
+    if (!source.open()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      workerError = "no se pudo abrir en paralelo";
+      abort = true;
+      changed.notify_all();
+      return;
+    }
+    const QVector<FramePipeline::Stage> stages = FrameStages::preset(m_config.preset);
+    qint64 position = 0;
+    for (;;) {
+      int index;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] {
+          return abort || nextChunk >= chunkCount || nextChunk < writtenChunks + window;
+        });
+        if (abort || nextChunk >= chunkCount) {
+          return;
+        }
+        index = nextChunk++;
+      }
+      const qint64 begin = qint64(index) * chunkFrames;
+      const qint64 end = index + 1 == chunkCount ? std::numeric_limits<qint64>::max()
+                                                 : begin + chunkFrames;
+      if (position != begin) {
+        source.set(cv::CAP_PROP_POS_FRAMES, double(begin));
+        seeks.fetch_add(1, std::memory_order_relaxed);
+        position = begin;
+      }
+      std::vector<cv::Mat> frames;
+      frames.reserve(size_t(qMin<qint64>(chunkFrames, end - begin)));
+      while (position < end && source.grab()) {
+        // Mat nuevos en cada frame: los del trozo se guardan hasta que el escritor los suelta
+        cv::Mat image;
+        if (!source.retrieve(image) || image.empty()) {
+          break;
+        }
+        ++position;
+        for (const FramePipeline::Stage &stage : stages) {
+          cv::Mat output;
+          stage.function(image, output);
+          image = output;
+        }
+        frames.push_back(image);
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      chunks[index].frames = std::move(frames);
+      chunks[index].done = true;
+      changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(workerCount);
+  for (int i = 0; i < workerCount; ++i) {
+    workers.emplace_back(worker);
+  }
+
+  // Escritura en orden desde este hilo mientras los trabajadores siguen con los trozos siguientes
+  FrameRecorder recorder;
+  if (!m_config.outputDir.isEmpty()) {
+    result.output = outputPathFor(path, m_config.outputDir);
+    recorder.setFrameRate(fps > 0 ? fps : 30);
+    recorder.start(std::make_shared<VideoFileSink>(result.output), FrameRecorder::Policy::Block);
+  }
+  quint64 sequence = 0;
+  bool writeFailed = false;
+  for (int index = 0; index < chunkCount && !writeFailed; ++index) {
+    std::vector<cv::Mat> frames;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&] { return abort || chunks[index].done; });
+      if (!chunks[index].done) {
+        break;
+      }
+      frames = std::move(chunks[index].frames);
+    }
+    for (cv::Mat &image : frames) {
+      CapturedFrame frame;
+      frame.image = image;
+      frame.sequence = sequence++;
+      if (recorder.isRecording() && !recorder.push(frame)) {
+        // Con Block solo falla si el destino no se pudo abrir o dejó de aceptar frames
+        writeFailed = true;
+        break;
+      }
+      image.release();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    ++writtenChunks;
+    changed.notify_all();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    abort = true; // Por si se salió antes de tiempo
+    changed.notify_all();
+  }
+  for (std::thread &thread : workers) {
+    thread.join();
+  }
+
+  result.seeks = seeks.load();
+  if (!m_config.outputDir.isEmpty()) {
+    recorder.stop(); // Espera a que se escriba lo que queda en cola
+    const FrameRecorder::Stats stats = recorder.stats();
+    result.frames = stats.written;
+    if (stats.failed || stats.dropped > 0) {
+      result.error = QString("error al escribir %1").arg(result.output);
+    }
+  } else {
+    result.frames = sequence;
+  }
+  if (result.error.isEmpty()) {
+    result.error = workerError;
+  }
+  result.ok = result.error.isEmpty();
+  result.seconds = timer.nsecsElapsed() / 1e9;
+  result.fps = result.seconds > 0 ? result.frames / result.seconds : 0;
+  if (!result.ok) {
+    qWarning() << "BatchProcessor -" << path << result.error;
+  }
+  return result;
+}
@@ -0,0 +1,52 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Procesado por lotes, sin ventana, de vídeos grabados o secuencias de imágenes con las mismas
+// piezas que la captura en vivo: FileSource para leer, las etapas de FrameStages para procesar y
+// FrameRecorder + VideoFileSink para escribir.
+//
+// Cada fichero se reparte en trozos de frames consecutivos que varios hilos leen y procesan a la
+// vez, cada uno con su propio FileSource y sus propias etapas (guardan estado entre frames). Un
+// hilo solo salta con CAP_PROP_POS_FRAMES cuando su siguiente trozo no sigue al anterior; en
+// vídeos intra (MJPEG, lo que graba la aplicación) y secuencias de imágenes saltar no cuesta nada,
+// y en H.264 cuesta como mucho decodificar desde el fotograma clave anterior, así que conviene
+// que los trozos sean más largos que el GOP (chunkFrames). Los trozos terminados se escriben en
+// orden mientras los siguientes se procesan; como mucho hay dos por hilo en vuelo, lo que acota
+// la memoria.
+class BatchProcessor {
+public:
+  struct Config {
+    int preset = 0;            // FrameStages::preset(): las mismas combinaciones que la GUI
+    QString outputDir;         // Vacío = solo procesar y medir, sin escribir
+    int threads = 0;           // 0 = uno por núcleo
+    int chunkFrames = 0;       // Frames por trozo; 0 = los que quepan en memoryBudgetMb
+    int memoryBudgetMb = 1024; // Para los frames procesados en espera de escribirse
+  };
+
+  struct Result {
+    QString input;
+    QString output;
+    bool ok = false;
+    QString error;
+    quint64 frames = 0;
+    int chunks = 0;
+    int chunkFrames = 0;
+    quint64 seeks = 0; // Saltos con CAP_PROP_POS_FRAMES entre trozos no consecutivos
+    int threads = 0;
+    double seconds = 0;
+    double fps = 0; // Frames escritos (o procesados, sin salida) por segundo de reloj
+  };
+
+  explicit BatchProcessor(const Config &config) : m_config(config) {}
+
+  // Bloquea hasta terminar el fichero. 'path' admite patrones de secuencia (img_%04d.png).
+  Result process(const QString &path);
+
+private:
+  const Config m_config;
+};
+
+#endif // BATCHPROCESSOR_H
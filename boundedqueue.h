@@ -0,0 +1,77 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Cola FIFO de capacidad fija entre hilos. push() bloquea si está llena, tryPush() no; tras
+// close() las esperas terminan y pop() devuelve lo que quede antes de fallar.
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+  bool tryPush(T item) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_closed || m_items.size() >= m_capacity) {
+        return false;
+      }
+      m_items.push_back(std::move(item));
+    }
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  bool push(T item) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+      if (m_closed) {
+        return false;
+      }
+      m_items.push_back(std::move(item));
+    }
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  bool pop(T &item) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+      if (m_items.empty()) {
+        return false;
+      }
+      item = std::move(m_items.front());
+      m_items.pop_front();
+    }
+    m_notFull.notify_one();
+    return true;
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_items.size();
+  }
+  size_t capacity() const { return m_capacity; }
+
+private:
+  const size_t m_capacity;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+  std::deque<T> m_items;
+  bool m_closed{false};
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,73 @@
+#include "cameracommandqueue.h"
+#include <iterator>
+
+void CameraCommandQueue::pushCameraChange(
+    int cameraId, const QSize &resolution, const QString &sourceSpec) {
+  CameraCommand command;
+  command.type = CameraCommand::Type::ChangeCamera;
+  command.cameraId = cameraId;
+  command.resolution = resolution;
+  command.sourceSpec = sourceSpec;
+  push(command);
+}
+
+void CameraCommandQueue::pushProperty(int propertyId, double value) {
+  CameraCommand command;
+  command.type = CameraCommand::Type::SetProperty;
+  command.propertyId = propertyId;
+  command.value = value;
+  push(command);
+}
+
+void CameraCommandQueue::push(const CameraCommand &command) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool merged = false;
+    if (command.type == CameraCommand::Type::ChangeCamera) {
+      // Abrir una cámara para cerrarla a continuación no aporta nada
+      if (!m_commands.empty() && m_commands.back().type == CameraCommand::Type::ChangeCamera) {
+        m_commands.back() = command;
+        merged = true;
+      }
+    } else {
+      // Solo se fusiona con órdenes posteriores al último cambio de cámara. La anterior se quita y
+      // la nueva va al final: adelantar el valor nuevo lo pondría por delante de órdenes que
+      // llegaron antes que él (EXPOSURE después de pasar AUTO_EXPOSURE a manual)
+      for (auto it = m_commands.rbegin(); it != m_commands.rend(); ++it) {
+        if (it->type == CameraCommand::Type::ChangeCamera) {
+          break;
+        }
+        if (it->propertyId == command.propertyId) {
+          m_commands.erase(std::next(it).base());
+          break;
+        }
+      }
+    }
+    if (!merged) {
+      m_commands.push_back(command);
+    }
+    m_hasPending.store(true, std::memory_order_release);
+  }
+  m_condition.notify_one();
+}
+
+void CameraCommandQueue::takeAll(std::vector<CameraCommand> &commands) {
+  commands.clear();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  commands.swap(m_commands);
+  m_hasPending.store(false, std::memory_order_release);
+}
+
+void CameraCommandQueue::waitForCommands() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_condition.wait(lock, [this] { return m_wakeRequested || !m_commands.empty(); });
+  m_wakeRequested = false;
+}
+
+void CameraCommandQueue::wake() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wakeRequested = true;
+  }
+  m_condition.notify_one();
+}
@@ -0,0 +1,53 @@
+#ifndef CAMERACOMMANDQUEUE_H
+#define CAMERACOMMANDQUEUE_H
+
+#include <QSize>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// Orden para el hilo de captura
+struct CameraCommand {
+  enum class Type { ChangeCamera, SetProperty };
+
+  Type type = Type::SetProperty;
+  int cameraId = -1;     // ChangeCamera (STOP_CAMERA para parar)
+  QSize resolution;      // ChangeCamera
+  QString sourceSpec;    // ChangeCamera: vacío = cámara cameraId con el backend nativo
+  int propertyId = 0;    // SetProperty (cv::CAP_PROP_*)
+  double value = 0;      // SetProperty
+};
+
+// Cola de órdenes de cámara con despertar por variable de condición.
+//
+// Las órdenes se ejecutan en el orden en que llegan. Las que se vuelven redundantes se fusionan:
+// mover un slider deja un único SetProperty pendiente por propiedad con el último valor, en el
+// sitio del último, y dos cambios de cámara seguidos se quedan en el último. Sin órdenes
+// pendientes, comprobar la cola cuesta una lectura atómica, y esperar en ella no consume CPU.
+class CameraCommandQueue {
+public:
+  void pushCameraChange(int cameraId, const QSize &resolution, const QString &sourceSpec = {});
+  void pushProperty(int propertyId, double value);
+
+  bool hasPending() const { return m_hasPending.load(std::memory_order_acquire); }
+
+  // Vacía la cola en 'commands' (se reutiliza su capacidad para no reservar memoria)
+  void takeAll(std::vector<CameraCommand> &commands);
+
+  // Bloquea hasta que haya órdenes o se llame a wake()
+  void waitForCommands();
+  void wake();
+
+private:
+  void push(const CameraCommand &command);
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::vector<CameraCommand> m_commands;
+  std::atomic<bool> m_hasPending{false};
+  bool m_wakeRequested{false};
+};
+
+#endif // CAMERACOMMANDQUEUE_H
@@ -0,0 +1,317 @@
+#include "camerasource.h"
+#include <QDebug>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+// Descriptor propio para las consultas que cv::VideoCapture no expone. V4L2 permite abrir el mismo
+// nodo varias veces: las consultas no interfieren con la captura en curso.
+class V4l2Device {
+public:
+  explicit V4l2Device(int index)
+      : m_fd(::open(QByteArray("/dev/video" + QByteArray::number(index)).constData(),
+                    O_RDWR | O_NONBLOCK)) {}
+  ~V4l2Device() {
+    if (m_fd >= 0) {
+      ::close(m_fd);
+    }
+  }
+
+  bool query(unsigned long request, void *argument) const {
+    if (m_fd < 0) {
+      return false;
+    }
+    int result;
+    do {
+      result = ::ioctl(m_fd, request, argument);
+    } while (result < 0 && errno == EINTR);
+    return result == 0;
+  }
+
+private:
+  const int m_fd;
+};
+
+quint32 v4l2Control(int propId) {
+  switch (propId) {
+  case cv::CAP_PROP_BRIGHTNESS:
+    return V4L2_CID_BRIGHTNESS;
+  case cv::CAP_PROP_CONTRAST:
+    return V4L2_CID_CONTRAST;
+  case cv::CAP_PROP_SATURATION:
+    return V4L2_CID_SATURATION;
+  case cv::CAP_PROP_SHARPNESS:
+    return V4L2_CID_SHARPNESS;
+  case cv::CAP_PROP_FOCUS:
+    return V4L2_CID_FOCUS_ABSOLUTE;
+  case cv::CAP_PROP_EXPOSURE:
+    return V4L2_CID_EXPOSURE_ABSOLUTE;
+  default:
+    return 0;
+  }
+}
+
+double framesPerSecond(const v4l2_fract &interval) {
+  return interval.numerator > 0 ? double(interval.denominator) / interval.numerator : 0;
+}
+
+// Límites y valor actual de un control; false si el driver no lo tiene o está desactivado
+bool queryControl(const V4l2Device &device, quint32 id, PropertyRange &range) {
+  v4l2_queryctrl control{};
+  control.id = id;
+  if (id == 0 || !device.query(VIDIOC_QUERYCTRL, &control) ||
+      (control.flags & V4L2_CTRL_FLAG_DISABLED)) {
+    return false;
+  }
+  // El backend V4L2 de OpenCV lee y escribe los valores en las unidades del driver
+  range.min = control.minimum;
+  range.max = control.maximum;
+  range.current = control.default_value;
+  v4l2_control value{};
+  value.id = id;
+  if (device.query(VIDIOC_G_CTRL, &value)) {
+    range.current = value.value;
+  }
+  return true;
+}
+
+QList<CaptureFormat> enumerateFormats(const V4l2Device &device) {
+  QList<CaptureFormat> formats;
+  v4l2_fmtdesc format{};
+  format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  for (format.index = 0; device.query(VIDIOC_ENUM_FMT, &format); ++format.index) {
+    const QString fourcc =
+        QString::fromLatin1(reinterpret_cast<const char *>(&format.pixelformat), 4);
+    v4l2_frmsizeenum size{};
+    size.pixel_format = format.pixelformat;
+    for (size.index = 0; device.query(VIDIOC_ENUM_FRAMESIZES, &size); ++size.index) {
+      if (size.type != V4L2_FRMSIZE_TYPE_DISCRETE) {
+        break; // Tamaño continuo o por pasos: no hay una lista que guardar
+      }
+      CaptureFormat entry;
+      entry.resolution = QSize(size.discrete.width, size.discrete.height);
+      entry.pixelFormat = fourcc;
+
+      v4l2_frmivalenum interval{};
+      interval.pixel_format = format.pixelformat;
+      interval.width = size.discrete.width;
+      interval.height = size.discrete.height;
+      for (interval.index = 0; device.query(VIDIOC_ENUM_FRAMEINTERVALS, &interval);
+           ++interval.index) {
+        if (interval.type != V4L2_FRMIVAL_TYPE_DISCRETE) {
+          // Intervalo continuo: el más corto da los fps máximos
+          entry.maxFps = framesPerSecond(interval.stepwise.min);
+          entry.minFps = framesPerSecond(interval.stepwise.max);
+          break;
+        }
+        const double fps = framesPerSecond(interval.discrete);
+        entry.maxFps = qMax(entry.maxFps, fps);
+        entry.minFps = entry.minFps > 0 ? qMin(entry.minFps, fps) : fps;
+      }
+      formats.append(entry);
+    }
+  }
+  return formats;
+}
+
+} // namespace
+#endif
+
+namespace {
+
+int fourccFor(FrameEncoding encoding) {
+  switch (encoding) {
+  case FrameEncoding::Mjpeg:
+    return cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+  case FrameEncoding::Yuyv:
+    return cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V');
+  case FrameEncoding::Nv12:
+    return cv::VideoWriter::fourcc('N', 'V', '1', '2');
+  case FrameEncoding::Decoded:
+    break;
+  }
+  return 0;
+}
+
+} // namespace
+
+CameraSource::CameraSource(
+    int cameraId, int apiPreference, const QSize &resolution, FrameEncoding encoding)
+    : m_cameraId(cameraId), m_apiPreference(apiPreference), m_resolution(resolution),
+      m_requested(encoding) {}
+
+int CameraSource::nativeBackend() {
+#if defined(Q_OS_WIN)
+  return cv::CAP_DSHOW;
+#elif defined(Q_OS_LINUX)
+  return cv::CAP_V4L2;
+#else
+  return cv::CAP_ANY;
+#endif
+}
+
+bool CameraSource::open() {
+  m_encoding = FrameEncoding::Decoded;
+  if (!m_capture.open(m_cameraId, m_apiPreference)) {
+    return false;
+  }
+  // El formato va antes que la resolución: muchas cámaras solo dan 1080p o 4K a 30 fps en MJPEG
+  const int fourcc = fourccFor(m_requested);
+  if (fourcc != 0) {
+    m_capture.set(cv::CAP_PROP_FOURCC, fourcc);
+  }
+  // Aplicar la resolución solicitada
+  if (m_resolution.width() > 0 && m_resolution.height() > 0) {
+    m_capture.set(cv::CAP_PROP_FRAME_WIDTH, m_resolution.width());
+    m_capture.set(cv::CAP_PROP_FRAME_HEIGHT, m_resolution.height());
+    qDebug() << "Solicitando resolución:" << m_resolution.width() << "x" << m_resolution.height();
+  }
+  if (fourcc != 0) {
+    // Sin CONVERT_RGB, retrieve() devuelve el buffer tal cual llega del driver
+    if (static_cast<int>(m_capture.get(cv::CAP_PROP_FOURCC)) == fourcc &&
+        m_capture.set(cv::CAP_PROP_CONVERT_RGB, 0)) {
+      m_encoding = m_requested;
+      m_frameSize = cv::Size(
+          static_cast<int>(m_capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+          static_cast<int>(m_capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+    } else {
+      qWarning() << "CameraSource::open() - La cámara" << m_cameraId
+                 << "no entrega el formato pedido sin convertir; se usa el modo normal";
+    }
+  }
+  return true;
+}
+
+qint64 CameraSource::timestampNs() const {
+  const double ms = m_capture.get(cv::CAP_PROP_POS_MSEC);
+  return ms > 0 ? qint64(ms * 1e6) : 0;
+}
+
+bool CameraSource::retrieve(cv::Mat &image) {
+  const bool yuv = m_encoding == FrameEncoding::Yuyv || m_encoding == FrameEncoding::Nv12;
+  if (yuv && !image.empty() && image.isContinuous()) {
+    image = image.reshape(1, 1); // Misma forma que da el backend: así reutiliza el buffer
+  }
+  if (!m_capture.retrieve(image)) {
+    return false;
+  }
+  if (!yuv) {
+    return true;
+  }
+  // El backend entrega el buffer del driver como 1xN bytes: se le da la forma del formato sin
+  // copiar. Un tamaño que no cuadra (filas con relleno) no se puede interpretar.
+  const size_t bytes = image.total() * image.elemSize();
+  const size_t pixels = size_t(m_frameSize.width) * m_frameSize.height;
+  if (m_encoding == FrameEncoding::Yuyv) {
+    if (!image.isContinuous() || bytes != pixels * 2) {
+      return false;
+    }
+    image = image.reshape(2, m_frameSize.height);
+  } else {
+    if (!image.isContinuous() || bytes != pixels * 3 / 2) {
+      return false;
+    }
+    image = image.reshape(1, m_frameSize.height * 3 / 2);
+  }
+  return true;
+}
+
+QString CameraSource::description() const {
+  return QStringLiteral("Cámara %1 (%2)")
+      .arg(m_cameraId)
+      .arg(QString::fromStdString(
+          m_capture.isOpened() ? m_capture.getBackendName() : std::to_string(m_apiPreference)));
+}
+
+QString CameraSource::deviceKey() const {
+#if defined(Q_OS_LINUX)
+  v4l2_capability capability{};
+  if (m_apiPreference == cv::CAP_V4L2 &&
+      V4l2Device(m_cameraId).query(VIDIOC_QUERYCAP, &capability)) {
+    // bus_info es el puerto físico: no cambia aunque cambie la numeración de /dev/videoN
+    return QStringLiteral("v4l2:%1@%2")
+        .arg(QString::fromUtf8(reinterpret_cast<const char *>(capability.card)))
+        .arg(QString::fromUtf8(reinterpret_cast<const char *>(capability.bus_info)));
+  }
+#endif
+  if (!m_capture.isOpened()) {
+    return QString();
+  }
+  return QStringLiteral("%1:%2")
+      .arg(QString::fromStdString(m_capture.getBackendName()).toLower())
+      .arg(m_cameraId);
+}
+
+bool CameraSource::propertyRange(int propId, PropertyRange &range) const {
+#if defined(Q_OS_LINUX)
+  PropertyRange driverRange;
+  if (m_apiPreference != cv::CAP_V4L2 ||
+      !queryControl(V4l2Device(m_cameraId), v4l2Control(propId), driverRange)) {
+    return false;
+  }
+  range.min = driverRange.min;
+  range.max = driverRange.max;
+  return range.max > range.min;
+#else
+  Q_UNUSED(propId);
+  Q_UNUSED(range);
+  return false;
+#endif
+}
+
+QList<CaptureFormat> CameraSource::captureFormats() const {
+#if defined(Q_OS_LINUX)
+  if (m_apiPreference == cv::CAP_V4L2) {
+    return enumerateFormats(V4l2Device(m_cameraId));
+  }
+#endif
+  return {};
+}
+
+FrameSource::CapabilityProbe CameraSource::capabilityProbe() const {
+#if defined(Q_OS_LINUX)
+  if (m_apiPreference != cv::CAP_V4L2) {
+    return {};
+  }
+  return [cameraId = m_cameraId](DeviceCapabilities &capabilities) {
+    const V4l2Device device(cameraId);
+    v4l2_capability capability{};
+    if (!device.query(VIDIOC_QUERYCAP, &capability)) {
+      return false; // Desconectada
+    }
+    CameraPropertiesSupport &support = capabilities.support;
+    CameraPropertyRanges &ranges = capabilities.ranges;
+    const struct {
+      int propId;
+      PropertyRange *range;
+      bool *supported;
+    } controls[] = {
+        {cv::CAP_PROP_BRIGHTNESS, &ranges.brightness, &support.brightness},
+        {cv::CAP_PROP_CONTRAST, &ranges.contrast, &support.contrast},
+        {cv::CAP_PROP_SATURATION, &ranges.saturation, &support.saturation},
+        {cv::CAP_PROP_SHARPNESS, &ranges.sharpness, &support.sharpness},
+        {cv::CAP_PROP_EXPOSURE, &ranges.exposure, &support.exposure},
+        {cv::CAP_PROP_FOCUS, &ranges.focus, &support.focus}};
+    for (const auto &control : controls) {
+      PropertyRange range;
+      *control.supported = queryControl(device, v4l2Control(control.propId), range) &&
+                           range.max > range.min;
+      // Sin el control, el rango genérico de siempre (ver VideoCaptureHandler::getPropertyRange)
+      *control.range = *control.supported ? range : PropertyRange{0, 255, 126};
+    }
+    PropertyRange mode;
+    support.autoExposure = queryControl(device, V4L2_CID_EXPOSURE_AUTO, mode);
+    support.autoFocus = queryControl(device, V4L2_CID_FOCUS_AUTO, mode);
+    capabilities.formats = enumerateFormats(device);
+    return true;
+  };
+#else
+  return {};
+#endif
+}
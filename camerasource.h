@@ -0,0 +1,52 @@
+#ifndef CAMERASOURCE_H
+#define CAMERASOURCE_H
+
+#include "framesource.h"
+#include <opencv2/videoio.hpp>
+
+// Cámara física a través de cv::VideoCapture con un backend concreto (CAP_V4L2, CAP_DSHOW...)
+class CameraSource : public FrameSource {
+public:
+  // Con 'encoding' Mjpeg, Yuyv o Nv12 se pide ese formato al driver y se entregan los frames tal
+  // cual llegan, sin decodificar ni pasar a BGR, si lo admite; si no, se queda en el modo normal
+  CameraSource(
+      int cameraId, int apiPreference, const QSize &resolution = {},
+      FrameEncoding encoding = FrameEncoding::Decoded);
+
+  // Backend por defecto de la plataforma: DirectShow en Windows, V4L2 en Linux
+  static int nativeBackend();
+
+  bool open() override;
+  bool isOpened() const override { return m_capture.isOpened(); }
+  void release() override { m_capture.release(); }
+
+  bool grab() override { return m_capture.grab(); }
+  bool retrieve(cv::Mat &image) override;
+  FrameEncoding encoding() const override { return m_encoding; }
+
+  bool set(int propId, double value) override { return m_capture.set(propId, value); }
+  double get(int propId) const override { return m_capture.get(propId); }
+  // V4L2 da en CAP_PROP_POS_MSEC la marca del buffer (CLOCK_MONOTONIC, con fracción de ms)
+  qint64 timestampNs() const override;
+
+  QString description() const override;
+
+  // En V4L2 se consultan directamente al driver (VIDIOC_QUERYCAP, QUERYCTRL, ENUM_FRAMESIZES)
+  // con un descriptor aparte; en los demás backends la identidad es el índice
+  QString deviceKey() const override;
+  bool propertyRange(int propId, PropertyRange &range) const override;
+  QList<CaptureFormat> captureFormats() const override;
+  // Solo con V4L2: controles y formatos por un descriptor propio, sin tocar m_capture
+  CapabilityProbe capabilityProbe() const override;
+
+private:
+  const int m_cameraId;
+  const int m_apiPreference;
+  const QSize m_resolution;
+  const FrameEncoding m_requested;
+  FrameEncoding m_encoding = FrameEncoding::Decoded;
+  cv::Size m_frameSize; // Para dar forma a los frames YUV, que el backend entrega como 1xN
+  cv::VideoCapture m_capture;
+};
+
+#endif // CAMERASOURCE_H
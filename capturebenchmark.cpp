@@ -0,0 +1,343 @@
+// Benchmark sin ventana de la cadena captura -> conversión -> entrega de VideoCaptureHandler.
+//
+// Recorre una matriz de resoluciones y formatos de píxel con el origen sintético (o un origen
+// fijo con --source) y escribe en JSON, por caso: fps sostenidos, percentiles de latencia desde
+// grab() hasta que el frame convertido llega al consumidor, tiempo de CPU del proceso y pico de
+// memoria residente. Pensado para compararse entre versiones:
+//
+//   OpenCVTestBenchmark --duration 5 --output resultados.json
+//
+// Con --check-changes solo comprueba que el suavizado con máscara de cambios sigue dando lo mismo
+// que el completo cuando se descarta un frame, y sale con código 3 si no.
+
+#include "changedetector.h"
+#include "framestages.h"
+#include "pixelconvert.h"
+#include "videocapturehandler.h"
+#include "workstealingpool.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+struct ProcessUsage {
+  double cpuSeconds = 0; // Usuario + sistema, todos los hilos
+  qint64 peakRssKb = 0;  // Pico desde el arranque del proceso (no baja entre casos)
+};
+
+ProcessUsage processUsage() {
+  ProcessUsage usage;
+#if defined(Q_OS_WIN)
+  FILETIME creation, exit, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+    auto seconds = [](const FILETIME &time) {
+      return ((quint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7;
+    };
+    usage.cpuSeconds = seconds(kernel) + seconds(user);
+  }
+  PROCESS_MEMORY_COUNTERS memory;
+  if (K32GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) {
+    usage.peakRssKb = static_cast<qint64>(memory.PeakWorkingSetSize / 1024);
+  }
+#else
+  rusage self{};
+  if (getrusage(RUSAGE_SELF, &self) == 0) {
+    usage.cpuSeconds = self.ru_utime.tv_sec + self.ru_utime.tv_usec * 1e-6 + self.ru_stime.tv_sec +
+                       self.ru_stime.tv_usec * 1e-6;
+#if defined(Q_OS_MACOS)
+    usage.peakRssKb = self.ru_maxrss / 1024; // En macOS viene en bytes
+#else
+    usage.peakRssKb = self.ru_maxrss;
+#endif
+  }
+#endif
+  return usage;
+}
+
+// Percentil por rango más cercano sobre muestras ya ordenadas
+double percentile(const std::vector<qint64> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+  return sorted[qBound<size_t>(1, rank, sorted.size()) - 1] / 1e6;
+}
+
+struct BenchmarkCase {
+  QString source; // Especificación para FrameSource::create()
+  QSize resolution;
+  QString format;
+};
+
+class LatencyRecorder {
+public:
+  void setRecording(bool recording) { m_recording.store(recording); }
+
+  // Se llama desde la tarea de conversión, con el frame ya convertido
+  void record(const FrameHandle &frame) {
+    if (!m_recording.load(std::memory_order_relaxed)) {
+      return;
+    }
+    const qint64 latency = monotonicNowNs() - frame.captureTimeNs();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_samples.push_back(latency);
+  }
+
+  std::vector<qint64> takeSamples() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<qint64> samples;
+    samples.swap(m_samples);
+    return samples;
+  }
+
+private:
+  std::atomic<bool> m_recording{false};
+  std::mutex m_mutex;
+  std::vector<qint64> m_samples;
+};
+
+QJsonObject runCase(const BenchmarkCase &benchCase, int warmupMs, int durationMs) {
+  QJsonObject result;
+  result["source"] = benchCase.source;
+  result["width"] = benchCase.resolution.width();
+  result["height"] = benchCase.resolution.height();
+  result["format"] = benchCase.format;
+
+  LatencyRecorder recorder;
+  std::atomic<bool> openFailed{false};
+
+  VideoCaptureHandler handler;
+  handler.setFrameCallback([&recorder](const FrameHandle &frame) { recorder.record(frame); });
+  // Sin bucle de eventos: el aviso llega directamente desde el hilo de captura
+  QObject::connect(
+      &handler, &VideoCaptureHandler::cameraOpenFailed, [&openFailed] { openFailed = true; },
+      Qt::DirectConnection);
+
+  handler.start();
+  handler.requestSourceChange(benchCase.source, benchCase.resolution);
+  QThread::msleep(warmupMs);
+
+  if (openFailed) {
+    handler.stop();
+    handler.wait();
+    result["error"] = QStringLiteral("No se pudo abrir el origen");
+    return result;
+  }
+
+  const CaptureStats statsBefore = handler.captureStats();
+  const FrameTimingStats::Snapshot timingBefore = handler.timingStats().snapshot();
+  const ProcessUsage usageBefore = processUsage();
+  QElapsedTimer elapsed;
+  recorder.setRecording(true);
+  elapsed.start();
+
+  QThread::msleep(durationMs);
+
+  recorder.setRecording(false);
+  const double seconds = elapsed.nsecsElapsed() / 1e9;
+  const ProcessUsage usageAfter = processUsage();
+  const CaptureStats statsAfter = handler.captureStats();
+  const FrameTimingStats::Snapshot timing = handler.timingStats().snapshot() - timingBefore;
+
+  handler.stop();
+  handler.wait();
+
+  std::vector<qint64> latencies = recorder.takeSamples();
+  std::sort(latencies.begin(), latencies.end());
+  double meanMs = 0;
+  for (qint64 latency : latencies) {
+    meanMs += latency / 1e6;
+  }
+  if (!latencies.empty()) {
+    meanMs /= latencies.size();
+  }
+
+  const double cpuSeconds = usageAfter.cpuSeconds - usageBefore.cpuSeconds;
+  result["seconds"] = seconds;
+  result["delivered"] = static_cast<qint64>(latencies.size());
+  result["fps"] = latencies.size() / seconds;
+  result["captureFps"] = (statsAfter.captured - statsBefore.captured) / seconds;
+  result["dropped"] = static_cast<qint64>(statsAfter.dropped - statsBefore.dropped);
+  result["poolExhausted"] =
+      static_cast<qint64>(statsAfter.poolExhausted - statsBefore.poolExhausted);
+  result["latencyMs"] = QJsonObject{
+      {"p50", percentile(latencies, 50)},
+      {"p99", percentile(latencies, 99)},
+      {"max", latencies.empty() ? 0.0 : latencies.back() / 1e6},
+      {"mean", meanMs}};
+  // Desglose por etapa hasta la conversión (histogramas de FrameTimingStats)
+  QJsonObject stages;
+  for (int interval = FrameTiming::Grab; interval <= FrameTiming::Convert; ++interval) {
+    const auto stage = FrameTiming::Interval(interval);
+    stages[QString::fromUtf8(FrameTiming::intervalName(stage))] = QJsonObject{
+        {"p50", timing.percentileMs(stage, 50)}, {"p99", timing.percentileMs(stage, 99)}};
+  }
+  result["stagesMs"] = stages;
+  result["cpuSeconds"] = cpuSeconds;
+  result["cpuPercent"] = 100.0 * cpuSeconds / seconds; // 100 = un núcleo entero
+  result["peakRssKb"] = usageAfter.peakRssKb;
+  return result;
+}
+
+QList<QSize> parseResolutions(const QString &text) {
+  QList<QSize> resolutions;
+  for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+    const QStringList dims = item.trimmed().split('x');
+    if (dims.size() == 2 && dims[0].toInt() > 0 && dims[1].toInt() > 0) {
+      resolutions << QSize(dims[0].toInt(), dims[1].toInt());
+    } else {
+      qWarning() << "Resolución no válida:" << item;
+    }
+  }
+  return resolutions;
+}
+
+// Un cuadrado que avanza una tesela por frame sobre un fondo de ruido fijo, con el detector y la
+// etapa de suavizado como en VideoCaptureHandler::convertPending(), y uno de los frames descartado
+// como si la primera etapa fuera retrasada. A 1024x576 la rejilla del detector es exactamente 1/4
+// y las teselas son de 64x64 en el frame, alineadas con el cuadrado: todo lo que cambia cae en
+// teselas cambiadas y el resultado tiene que coincidir con el suavizado completo.
+int checkChangeMasks() {
+  constexpr int kFrames = 8;
+  constexpr int kDroppedFrame = 3;
+  cv::Mat background(576, 1024, CV_8UC3);
+  cv::RNG rng(1);
+  rng.fill(background, cv::RNG::UNIFORM, 0, 256);
+
+  ChangeDetector detector;
+  const FramePipeline::Stage stage = FrameStages::denoise(5);
+  cv::Mat image, output, expected;
+  int failures = 0;
+  for (int i = 0; i < kFrames; ++i) {
+    background.copyTo(image);
+    cv::rectangle(image, cv::Rect(64 * i, 192, 128, 128), cv::Scalar::all(255), cv::FILLED);
+    ChangeMask mask;
+    detector.update(image, mask);
+    if (i == kDroppedFrame) {
+      continue; // FramePipeline::push() lo ha descartado: ni llega a la etapa ni a la referencia
+    }
+    detector.commit(mask);
+    stage.maskedFunction(image, &mask, output);
+    cv::GaussianBlur(image, expected, cv::Size(5, 5), 0);
+    const double error = cv::norm(output, expected, cv::NORM_INF);
+    if (error > 1) {
+      std::fprintf(
+          stderr, "Frame %d: el suavizado con máscara difiere del completo en %.0f\n", i, error);
+      ++failures;
+    }
+  }
+  std::fprintf(stderr, "Máscara de cambios tras un descarte: %s\n", failures ? "MAL" : "bien");
+  return failures ? 3 : 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("OpenCVTestBenchmark");
+  QCoreApplication::setApplicationVersion(QStringLiteral(PROJECT_VERSION));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Benchmark sin ventana de captura, conversión y entrega.");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  const QCommandLineOption resolutionsOption(
+      "resolutions", "Lista de resoluciones WxH separadas por comas.", "lista",
+      "640x480,1280x720,1920x1080,3840x2160");
+  const QCommandLineOption formatsOption(
+      "formats", "Formatos del origen sintético: bgr, gray, bgra.", "lista", "bgr,gray,bgra");
+  const QCommandLineOption sourceOption(
+      "source", "Origen fijo (file:..., v4l2:0...) en vez del sintético; varía solo la resolución.",
+      "spec");
+  const QCommandLineOption fpsOption(
+      "fps", "Ritmo del origen sintético (0 = lo más rápido posible).", "fps", "0");
+  const QCommandLineOption durationOption(
+      "duration", "Segundos medidos por caso.", "segundos", "5");
+  const QCommandLineOption warmupOption(
+      "warmup", "Segundos de calentamiento por caso.", "segundos", "1");
+  const QCommandLineOption outputOption(
+      {"o", "output"}, "Fichero JSON de salida (por defecto, la salida estándar).", "fichero");
+  const QCommandLineOption checkChangesOption(
+      "check-changes", "Solo comprobar la máscara de cambios tras descartar un frame.");
+  parser.addOptions(
+      {resolutionsOption, formatsOption, sourceOption, fpsOption, durationOption, warmupOption,
+       outputOption, checkChangesOption});
+  parser.process(app);
+
+  if (parser.isSet(checkChangesOption)) {
+    return checkChangeMasks();
+  }
+
+  const QList<QSize> resolutions = parseResolutions(parser.value(resolutionsOption));
+  const int durationMs = qMax(1, qRound(parser.value(durationOption).toDouble() * 1000));
+  const int warmupMs = qMax(0, qRound(parser.value(warmupOption).toDouble() * 1000));
+  const double fps = parser.value(fpsOption).toDouble();
+
+  QList<BenchmarkCase> cases;
+  for (const QSize &resolution : resolutions) {
+    if (parser.isSet(sourceOption)) {
+      cases << BenchmarkCase{parser.value(sourceOption), resolution, QStringLiteral("source")};
+      continue;
+    }
+    for (const QString &item : parser.value(formatsOption).split(',', Qt::SkipEmptyParts)) {
+      const QString format = item.trimmed().toLower();
+      // Sin sufijo de formato el patrón sale en BGR
+      const QString suffix = format == "bgr" ? QString() : ':' + format;
+      const QString spec = QStringLiteral("synthetic:%1x%2@%3%4")
+                               .arg(resolution.width())
+                               .arg(resolution.height())
+                               .arg(fps)
+                               .arg(suffix);
+      cases << BenchmarkCase{spec, resolution, format};
+    }
+  }
+
+  QJsonArray results;
+  for (const BenchmarkCase &benchCase : cases) {
+    std::fprintf(stderr, "%s ...\n", qPrintable(benchCase.source));
+    results.append(runCase(benchCase, warmupMs, durationMs));
+  }
+
+  QJsonObject report;
+  report["benchmark"] = QStringLiteral("capture");
+  report["version"] = QCoreApplication::applicationVersion();
+  report["isa"] = QString::fromLatin1(PixelConvert::isaName(PixelConvert::bestIsa()));
+  report["workerThreads"] = WorkStealingPool::shared().threadCount();
+  report["idealThreads"] = QThread::idealThreadCount();
+  report["warmupSeconds"] = warmupMs / 1000.0;
+  report["durationSeconds"] = durationMs / 1000.0;
+  report["cases"] = results;
+  const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+  if (parser.isSet(outputOption)) {
+    QFile file(parser.value(outputOption));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      qWarning() << "No se pudo escribir" << file.fileName();
+      return 1;
+    }
+    file.write(json);
+  } else {
+    std::fwrite(json.constData(), 1, json.size(), stdout);
+  }
+  return 0;
+}
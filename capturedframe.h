@@ -0,0 +1,29 @@
+#ifndef CAPTUREDFRAME_H
+#define CAPTUREDFRAME_H
+
+#include "changedetector.h"
+#include "frametiming.h"
+#include <QtGlobal>
+#include <memory>
+#include <opencv2/core.hpp>
+
+// Contenido de CapturedFrame::image
+enum class FrameEncoding {
+  Decoded, // Píxeles BGR, BGRA o GRAY
+  Mjpeg,   // JPEG comprimido tal y como lo entrega la cámara (1xN CV_8UC1); ver mjpeg.h
+  Yuyv,    // YUV 4:2:2 empaquetado (CV_8UC2: Y0 U Y1 V); ver yuvframe.h
+  Nv12,    // YUV 4:2:0: plano Y y plano UV entrelazado (CV_8UC1 de alto * 3 / 2 filas)
+};
+
+// Frame tal y como sale del hilo de captura, junto a sus metadatos básicos
+struct CapturedFrame {
+  cv::Mat image;
+  FrameEncoding encoding = FrameEncoding::Decoded;
+  quint64 sequence = 0;       // Número de frame desde que se abrió la cámara
+  qint64 captureTimeNs = 0;   // Instante de captura (reloj monotónico)
+  FrameTimestamps timestamps; // Marcas por etapa hasta la conversión
+  // Teselas cambiadas según ChangeDetector; nulo = desconocido (todo cambiado)
+  std::shared_ptr<const ChangeMask> changes;
+};
+
+#endif // CAPTUREDFRAME_H
@@ -0,0 +1,101 @@
+#include "changedetector.h"
+#include <cstdlib>
+#include <opencv2/imgproc.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CHANGEDETECTOR_SSE2 1
+#endif
+
+namespace {
+
+// Suma de |a - b| de una tesela de kTile x kTile bytes
+quint32 tileSad(const cv::Mat &a, const cv::Mat &b, int x0, int y0) {
+  constexpr int tile = ChangeDetector::kTile;
+#ifdef CHANGEDETECTOR_SSE2
+  __m128i sum = _mm_setzero_si128();
+  for (int y = y0; y < y0 + tile; ++y) {
+    const __m128i rowA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a.ptr<uchar>(y) + x0));
+    const __m128i rowB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b.ptr<uchar>(y) + x0));
+    // Dos sumas de 8 bytes cada una, en las mitades de 64 bits
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(rowA, rowB));
+  }
+  return quint32(_mm_cvtsi128_si32(sum)) + quint32(_mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+#else
+  quint32 sum = 0;
+  for (int y = y0; y < y0 + tile; ++y) {
+    const uchar *rowA = a.ptr<uchar>(y) + x0;
+    const uchar *rowB = b.ptr<uchar>(y) + x0;
+    for (int x = 0; x < tile; ++x) {
+      sum += quint32(std::abs(int(rowA[x]) - int(rowB[x])));
+    }
+  }
+  return sum;
+#endif
+}
+
+} // namespace
+
+cv::Rect ChangeMask::tileRect(int x, int y) const {
+  const int x0 = x * frameSize.width / tilesX;
+  const int y0 = y * frameSize.height / tilesY;
+  const int x1 = (x + 1) * frameSize.width / tilesX;
+  const int y1 = (y + 1) * frameSize.height / tilesY;
+  return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+bool ChangeDetector::update(const cv::Mat &image, ChangeMask &mask) {
+  if (image.empty() || image.depth() != CV_8U) {
+    return true;
+  }
+  // Rejilla de kGridWidth con el alto redondeado a teselas enteras; las teselas no son del todo
+  // cuadradas en el frame, pero da igual para detectar cambios
+  const int gridHeight = qMax(
+      kTile, (image.rows * kGridWidth / qMax(1, image.cols) + kTile / 2) / kTile * kTile);
+  cv::resize(image, m_small, cv::Size(kGridWidth, gridHeight), 0, 0, cv::INTER_AREA);
+  if (m_small.channels() == 1) {
+    m_small.copyTo(m_luma);
+  } else if (m_small.channels() == 2) {
+    cv::extractChannel(m_small, m_luma, 0); // YUYV: promediar la U y la V juntas no importa
+  } else {
+    cv::cvtColor(
+        m_small, m_luma, m_small.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+  }
+
+  mask.tilesX = kGridWidth / kTile;
+  mask.tilesY = gridHeight / kTile;
+  mask.frameSize = image.size();
+  mask.tiles.assign(size_t(mask.tilesX) * mask.tilesY, 1);
+  mask.changed = mask.tilesX * mask.tilesY;
+  if (m_reference.size() != m_luma.size()) {
+    return true; // Primer frame u otra resolución: todo cambiado
+  }
+
+  const quint32 limit = quint32(m_threshold * kTile * kTile);
+  mask.changed = 0;
+  for (int ty = 0; ty < mask.tilesY; ++ty) {
+    for (int tx = 0; tx < mask.tilesX; ++tx) {
+      const bool changed = tileSad(m_luma, m_reference, tx * kTile, ty * kTile) > limit;
+      mask.tiles[size_t(ty) * mask.tilesX + tx] = changed ? 1 : 0;
+      mask.changed += changed ? 1 : 0;
+    }
+  }
+  return mask.changed > 0;
+}
+
+void ChangeDetector::commit(const ChangeMask &mask) {
+  if (m_reference.size() != m_luma.size()) {
+    m_luma.copyTo(m_reference);
+    return;
+  }
+  // Solo las teselas cambiadas renuevan su referencia: en las demás se sigue acumulando la deriva
+  // lenta hasta que pase del umbral
+  for (int ty = 0; ty < mask.tilesY; ++ty) {
+    for (int tx = 0; tx < mask.tilesX; ++tx) {
+      if (mask.isChanged(tx, ty)) {
+        const cv::Rect rect(tx * kTile, ty * kTile, kTile, kTile);
+        m_luma(rect).copyTo(m_reference(rect));
+      }
+    }
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef CHANGEDETECTOR_H
+#define CHANGEDETECTOR_H
+
+#include <QtGlobal>
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Teselas de un frame que han cambiado respecto al último frame entregado (ChangeDetector)
+struct ChangeMask {
+  int tilesX = 0;
+  int tilesY = 0;
+  cv::Size frameSize;       // Tamaño del frame al que se refiere
+  std::vector<uchar> tiles; // tilesX * tilesY, por filas; 1 = cambiada
+  int changed = 0;
+
+  bool isChanged(int x, int y) const { return tiles[y * tilesX + x] != 0; }
+  // Rectángulo de la tesela en píxeles del frame (las del borde cubren el resto)
+  cv::Rect tileRect(int x, int y) const;
+};
+
+// Detector de cambios por teselas para no convertir ni repintar escenas estáticas.
+//
+// Reduce cada frame a una rejilla de luma de kGridWidth de ancho (promedio de áreas, que además
+// quita ruido del sensor) y la compara por teselas de kTile x kTile con la del último frame que
+// se dio por cambiada, con la suma de diferencias absolutas de SSE2 (_mm_sad_epu8: una fila de
+// tesela por instrucción). Una tesela cambia si su diferencia media pasa del umbral. Comparar con
+// esa referencia y no con el frame anterior hace que los cambios lentos (luz) acaben detectándose.
+//
+// Solo se usa desde un hilo a la vez.
+class ChangeDetector {
+public:
+  static constexpr int kGridWidth = 256;
+  static constexpr int kTile = 16;
+
+  // Diferencia media por píxel (0..255) a partir de la cual una tesela ha cambiado
+  void setThreshold(double meanDifference) { m_threshold = qBound(0.5, meanDifference, 64.0); }
+  double threshold() const { return m_threshold; }
+
+  // true si alguna tesela ha cambiado (o no hay referencia con la que compararla). 'mask' recibe
+  // las teselas cambiadas en cualquier caso. Admite GRAY, BGR, BGRA y YUYV (CV_8UC2, la luma en
+  // el canal 0).
+  bool update(const cv::Mat &image, ChangeMask &mask);
+  // Las teselas cambiadas del último update() pasan a ser la referencia. Solo si el frame se ha
+  // entregado: si se descarta, el siguiente se sigue comparando con lo que vio quien lo recibe,
+  // y su máscara incluye también lo que cambió en el descartado.
+  void commit(const ChangeMask &mask);
+  void reset() { m_reference.release(); }
+
+private:
+  double m_threshold = 4.0;
+  cv::Mat m_small;
+  cv::Mat m_luma; // Rejilla del último update(), hasta commit()
+  cv::Mat m_reference;
+};
+
+#endif // CHANGEDETECTOR_H
@@ -0,0 +1,184 @@
+#include "devicecapabilities.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+// Cambiarlo descarta las cachés escritas por versiones anteriores
+constexpr int kCacheVersion = 1;
+
+QJsonObject supportToJson(const CameraPropertiesSupport &support) {
+  return QJsonObject{
+      {"autoFocus", support.autoFocus},
+      {"focus", support.focus},
+      {"autoExposure", support.autoExposure},
+      {"exposure", support.exposure},
+      {"brightness", support.brightness},
+      {"contrast", support.contrast},
+      {"saturation", support.saturation},
+      {"sharpness", support.sharpness}};
+}
+
+CameraPropertiesSupport supportFromJson(const QJsonObject &json) {
+  CameraPropertiesSupport support;
+  support.autoFocus = json["autoFocus"].toBool(support.autoFocus);
+  support.focus = json["focus"].toBool(support.focus);
+  support.autoExposure = json["autoExposure"].toBool(support.autoExposure);
+  support.exposure = json["exposure"].toBool(support.exposure);
+  support.brightness = json["brightness"].toBool(support.brightness);
+  support.contrast = json["contrast"].toBool(support.contrast);
+  support.saturation = json["saturation"].toBool(support.saturation);
+  support.sharpness = json["sharpness"].toBool(support.sharpness);
+  return support;
+}
+
+// [min, max, valor]
+QJsonArray rangeToJson(const PropertyRange &range) {
+  return QJsonArray{range.min, range.max, range.current};
+}
+
+PropertyRange rangeFromJson(const QJsonValue &json) {
+  PropertyRange range;
+  const QJsonArray values = json.toArray();
+  if (values.size() == 3) {
+    range.min = values[0].toDouble();
+    range.max = values[1].toDouble();
+    range.current = values[2].toDouble();
+  }
+  return range;
+}
+
+QJsonObject capabilitiesToJson(const DeviceCapabilities &capabilities) {
+  const CameraPropertyRanges &ranges = capabilities.ranges;
+  QJsonArray formats;
+  for (const CaptureFormat &format : capabilities.formats) {
+    formats.append(QJsonObject{
+        {"width", format.resolution.width()},
+        {"height", format.resolution.height()},
+        {"pixelFormat", format.pixelFormat},
+        {"minFps", format.minFps},
+        {"maxFps", format.maxFps}});
+  }
+  return QJsonObject{
+      {"support", supportToJson(capabilities.support)},
+      {"ranges",
+       QJsonObject{
+           {"brightness", rangeToJson(ranges.brightness)},
+           {"contrast", rangeToJson(ranges.contrast)},
+           {"saturation", rangeToJson(ranges.saturation)},
+           {"sharpness", rangeToJson(ranges.sharpness)},
+           {"focus", rangeToJson(ranges.focus)},
+           {"exposure", rangeToJson(ranges.exposure)}}},
+      {"formats", formats}};
+}
+
+DeviceCapabilities capabilitiesFromJson(const QJsonObject &json) {
+  DeviceCapabilities capabilities;
+  capabilities.support = supportFromJson(json["support"].toObject());
+  const QJsonObject ranges = json["ranges"].toObject();
+  capabilities.ranges.brightness = rangeFromJson(ranges["brightness"]);
+  capabilities.ranges.contrast = rangeFromJson(ranges["contrast"]);
+  capabilities.ranges.saturation = rangeFromJson(ranges["saturation"]);
+  capabilities.ranges.sharpness = rangeFromJson(ranges["sharpness"]);
+  capabilities.ranges.focus = rangeFromJson(ranges["focus"]);
+  capabilities.ranges.exposure = rangeFromJson(ranges["exposure"]);
+  for (const QJsonValue &value : json["formats"].toArray()) {
+    const QJsonObject format = value.toObject();
+    CaptureFormat entry;
+    entry.resolution = QSize(format["width"].toInt(), format["height"].toInt());
+    entry.pixelFormat = format["pixelFormat"].toString();
+    entry.minFps = format["minFps"].toDouble();
+    entry.maxFps = format["maxFps"].toDouble();
+    capabilities.formats.append(entry);
+  }
+  return capabilities;
+}
+
+} // namespace
+
+DeviceCapabilityCache::DeviceCapabilityCache(const QString &path) : m_path(path) { load(); }
+
+DeviceCapabilityCache &DeviceCapabilityCache::shared() {
+  static DeviceCapabilityCache cache(
+      QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+          .filePath("camera_capabilities.json"));
+  return cache;
+}
+
+bool DeviceCapabilityCache::find(const QString &deviceKey, DeviceCapabilities &capabilities) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = m_devices.constFind(deviceKey);
+  if (it == m_devices.constEnd()) {
+    return false;
+  }
+  capabilities = it.value();
+  return true;
+}
+
+QString DeviceCapabilityCache::deviceKeyFor(const QString &sourceSpec) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_specs.value(sourceSpec);
+}
+
+void DeviceCapabilityCache::store(
+    const QString &sourceSpec, const QString &deviceKey, const DeviceCapabilities &capabilities) {
+  if (deviceKey.isEmpty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_devices.insert(deviceKey, capabilities);
+  if (!sourceSpec.isEmpty()) {
+    m_specs.insert(sourceSpec, deviceKey);
+  }
+  saveLocked();
+}
+
+void DeviceCapabilityCache::load() {
+  QFile file(m_path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return; // Primera ejecución: todavía no hay caché
+  }
+  const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+  if (root["version"].toInt() != kCacheVersion) {
+    qDebug() << "DeviceCapabilityCache - Caché descartada (otra versión):" << m_path;
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const QJsonObject devices = root["devices"].toObject();
+  for (auto it = devices.constBegin(); it != devices.constEnd(); ++it) {
+    m_devices.insert(it.key(), capabilitiesFromJson(it.value().toObject()));
+  }
+  const QJsonObject specs = root["specs"].toObject();
+  for (auto it = specs.constBegin(); it != specs.constEnd(); ++it) {
+    m_specs.insert(it.key(), it.value().toString());
+  }
+}
+
+bool DeviceCapabilityCache::saveLocked() const {
+  QJsonObject devices;
+  for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
+    devices.insert(it.key(), capabilitiesToJson(it.value()));
+  }
+  QJsonObject specs;
+  for (auto it = m_specs.constBegin(); it != m_specs.constEnd(); ++it) {
+    specs.insert(it.key(), it.value());
+  }
+  const QJsonObject root{{"version", kCacheVersion}, {"devices", devices}, {"specs", specs}};
+
+  // QSaveFile: otro proceso que lea a la vez nunca ve un fichero a medias
+  QDir().mkpath(QFileInfo(m_path).absolutePath());
+  QSaveFile file(m_path);
+  if (!file.open(QIODevice::WriteOnly) ||
+      file.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0 || !file.commit()) {
+    qWarning() << "DeviceCapabilityCache - No se pudo escribir" << m_path;
+    return false;
+  }
+  return true;
+}
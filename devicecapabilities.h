@@ -0,0 +1,89 @@
+#ifndef DEVICECAPABILITIES_H
+#define DEVICECAPABILITIES_H
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QSize>
+#include <QString>
+#include <mutex>
+
+// Estructura para informar qué propiedades de cámara son soportadas (bool)
+struct CameraPropertiesSupport {
+  bool autoFocus = false;
+  bool focus = true;
+  bool autoExposure = false;
+  bool exposure = false;
+  bool brightness = false;
+  bool contrast = false;
+  bool saturation = false;
+  bool sharpness = false;
+};
+Q_DECLARE_METATYPE(CameraPropertiesSupport)
+
+// Rango de una propiedad en las unidades del driver
+struct PropertyRange {
+  double min = 0;
+  double max = 255;
+  double current = 0; // Valor actual o por defecto
+};
+
+struct CameraPropertyRanges {
+  PropertyRange brightness;
+  PropertyRange contrast;
+  PropertyRange saturation;
+  PropertyRange sharpness;
+  PropertyRange focus;
+  PropertyRange exposure;
+};
+Q_DECLARE_METATYPE(CameraPropertyRanges)
+
+// Un modo de captura del dispositivo
+struct CaptureFormat {
+  QSize resolution;
+  QString pixelFormat; // FOURCC (MJPG, YUYV...)
+  double minFps = 0;
+  double maxFps = 0;
+};
+
+// Todo lo que se averigua sondeando un dispositivo al abrirlo
+struct DeviceCapabilities {
+  CameraPropertiesSupport support;
+  CameraPropertyRanges ranges;
+  QList<CaptureFormat> formats; // Vacío si el backend no sabe enumerarlos
+};
+
+// Caché en disco de las capacidades de cada dispositivo, por identidad del dispositivo
+// (FrameSource::deviceKey()) y no por índice, para que sobreviva a que cambie la numeración.
+//
+// Con el dispositivo en la caché, abrir la cámara cuesta solo la apertura del driver: la GUI
+// recibe soporte y rangos al instante y el sondeo completo no se repite nunca. Se guarda en JSON
+// en el directorio de caché de la aplicación; borrar el fichero obliga a sondear de nuevo.
+class DeviceCapabilityCache {
+public:
+  explicit DeviceCapabilityCache(const QString &path);
+
+  // Caché del proceso, cargada del disco la primera vez que se usa
+  static DeviceCapabilityCache &shared();
+
+  bool find(const QString &deviceKey, DeviceCapabilities &capabilities) const;
+  // Último dispositivo abierto con 'sourceSpec' (p.ej. camera:0), para consultarlo sin abrirlo
+  QString deviceKeyFor(const QString &sourceSpec) const;
+
+  // Guarda en memoria y en disco; se puede llamar desde cualquier hilo
+  void store(
+      const QString &sourceSpec, const QString &deviceKey, const DeviceCapabilities &capabilities);
+
+  QString path() const { return m_path; }
+
+private:
+  void load();
+  bool saveLocked() const;
+
+  const QString m_path;
+  mutable std::mutex m_mutex;
+  QHash<QString, DeviceCapabilities> m_devices;
+  QHash<QString, QString> m_specs; // Especificación -> identidad del dispositivo
+};
+
+#endif // DEVICECAPABILITIES_H
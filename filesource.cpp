@@ -0,0 +1,44 @@
+#include "filesource.h"
+
+FileSource::FileSource(const QString &path, bool loop, bool paced)
+    : m_path(path), m_loop(loop), m_paced(paced) {}
+
+bool FileSource::open() {
+  // CAP_ANY reconoce tanto vídeos como patrones de secuencia tipo img_%04d.png
+  if (!m_capture.open(m_path.toStdString(), cv::CAP_ANY)) {
+    return false;
+  }
+  const double fps = m_capture.get(cv::CAP_PROP_FPS);
+  m_pacer.setFps(m_paced ? (fps > 0 ? fps : 30) : 0);
+  return true;
+}
+
+bool FileSource::grab() {
+  m_pacer.wait();
+  if (m_capture.grab()) {
+    return true;
+  }
+  if (!m_loop) {
+    return false;
+  }
+  // Fin del fichero: volver al principio (las secuencias de imágenes se reabren)
+  if (!m_capture.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+    m_capture.open(m_path.toStdString(), cv::CAP_ANY);
+  }
+  return m_capture.grab();
+}
+
+double FileSource::get(int propId) const {
+  if (propId == cv::CAP_PROP_FPS && m_pacer.fps() > 0) {
+    return m_pacer.fps(); // Sin ritmo, el del fichero
+  }
+  return m_capture.get(propId);
+}
+
+bool FileSource::set(int propId, double value) {
+  if (propId == cv::CAP_PROP_FPS) {
+    m_pacer.setFps(m_paced ? value : 0);
+    return true;
+  }
+  return m_capture.set(propId, value);
+}
@@ -0,0 +1,33 @@
+#ifndef FILESOURCE_H
+#define FILESOURCE_H
+
+#include "framesource.h"
+#include <opencv2/videoio.hpp>
+
+// Vídeo grabado o secuencia de imágenes. Por defecto se reproduce en bucle al ritmo del fichero,
+// como una cámara; sin ritmo entrega los frames tan rápido como se lean (pruebas y benchmarks).
+class FileSource : public FrameSource {
+public:
+  explicit FileSource(const QString &path, bool loop = true, bool paced = true);
+
+  bool open() override;
+  bool isOpened() const override { return m_capture.isOpened(); }
+  void release() override { m_capture.release(); }
+
+  bool grab() override;
+  bool retrieve(cv::Mat &image) override { return m_capture.retrieve(image); }
+
+  bool set(int propId, double value) override;
+  double get(int propId) const override; // CAP_PROP_FPS: el ritmo al que se reproduce
+
+  QString description() const override { return m_path; }
+
+private:
+  const QString m_path;
+  const bool m_loop;
+  const bool m_paced;
+  cv::VideoCapture m_capture;
+  FramePacer m_pacer;
+};
+
+#endif // FILESOURCE_H
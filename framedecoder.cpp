@@ -0,0 +1,21 @@
+#include "framedecoder.h"
+#include "mjpeg.h"
+#include "yuvframe.h"
+
+bool FrameDecoder::toBgr(const CapturedFrame &in, CapturedFrame &out, int reduction) {
+  out.sequence = in.sequence;
+  out.captureTimeNs = in.captureTimeNs;
+  out.timestamps = in.timestamps;
+  out.encoding = FrameEncoding::Decoded;
+  switch (in.encoding) {
+  case FrameEncoding::Mjpeg:
+    return Mjpeg::decode(in.image, out.image, reduction);
+  case FrameEncoding::Yuyv:
+  case FrameEncoding::Nv12:
+    return Yuv::toBgr(in.image, in.encoding, out.image);
+  case FrameEncoding::Decoded:
+    break;
+  }
+  out.image = in.image;
+  return !out.image.empty();
+}
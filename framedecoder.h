@@ -0,0 +1,25 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include "capturedframe.h"
+#include <opencv2/core.hpp>
+
+// Paso a píxeles BGR de un frame en cualquier FrameEncoding, para quien no quiere saber cómo lo
+// entregó la cámara (etapas de procesado, grabación): MJPEG con Mjpeg::decode(), YUV con
+// Yuv::toBgr(), y los ya decodificados tal cual.
+namespace FrameDecoder {
+
+// Suelta el buffer de 'out' si alguien más lo conserva (cola del pipeline, grabador) para no
+// sobrescribirlo; si no, la conversión lo reutiliza
+inline void detachShared(cv::Mat &out) {
+  if (out.u && out.u->refcount > 1) {
+    out.release();
+  }
+}
+
+// Copia los metadatos de 'in' y pasa su imagen a BGR ('reduction' solo se aplica a MJPEG)
+bool toBgr(const CapturedFrame &in, CapturedFrame &out, int reduction = 1);
+
+} // namespace FrameDecoder
+
+#endif // FRAMEDECODER_H
@@ -0,0 +1,151 @@
+#include "framepipeline.h"
+#include <utility>
+
+FramePipeline::FramePipeline(int queueCapacity) : m_queueCapacity(qMax(1, queueCapacity)) {}
+
+FramePipeline::~FramePipeline() { stop(); }
+
+void FramePipeline::setStages(const QVector<Stage> &stages) {
+  std::lock_guard<std::mutex> lock(m_controlMutex);
+  stopRunners();
+  m_stages = stages;
+  if (m_running) {
+    startRunners();
+  }
+}
+
+void FramePipeline::start(Sink sink) {
+  std::lock_guard<std::mutex> lock(m_controlMutex);
+  stopRunners();
+  m_sink = std::move(sink);
+  m_running = true;
+  startRunners();
+}
+
+void FramePipeline::stop() {
+  std::lock_guard<std::mutex> lock(m_controlMutex);
+  stopRunners();
+  m_running = false;
+}
+
+bool FramePipeline::push(const CapturedFrame &frame) {
+  {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (!m_running) {
+      return false;
+    }
+    if (!m_runners.empty()) {
+      if (m_runners.front()->input->tryPush(frame)) {
+        return true;
+      }
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  // Sin etapas: paso directo. m_sink solo cambia en start(), que no coincide con push()
+  deliver(frame);
+  return true;
+}
+
+void FramePipeline::deliver(const CapturedFrame &frame) {
+  // Si setStages() arranca etapas mientras un frame va por el paso directo, la última etapa
+  // entregaría a la vez que él: el destino nunca recibe dos frames a la vez
+  std::lock_guard<std::mutex> lock(m_deliveryMutex);
+  m_sink(frame);
+}
+
+bool FramePipeline::hasStages() const {
+  std::lock_guard<std::mutex> lock(m_controlMutex);
+  return !m_stages.isEmpty();
+}
+
+QVector<FramePipeline::StageStats> FramePipeline::stageStats() const {
+  std::lock_guard<std::mutex> lock(m_controlMutex);
+  QVector<StageStats> result;
+  for (const auto &runner : m_runners) {
+    StageStats stats;
+    stats.name = runner->stage.name;
+    stats.processed = runner->processed.load(std::memory_order_relaxed);
+    stats.lastMs = runner->lastNs.load(std::memory_order_relaxed) / 1e6;
+    stats.maxMs = runner->maxNs.load(std::memory_order_relaxed) / 1e6;
+    if (stats.processed > 0) {
+      stats.averageMs = runner->totalNs.load(std::memory_order_relaxed) / 1e6 / stats.processed;
+    }
+    stats.queued = static_cast<int>(runner->input->size());
+    result.append(stats);
+  }
+  return result;
+}
+
+void FramePipeline::startRunners() {
+  for (const Stage &stage : std::as_const(m_stages)) {
+    auto runner = std::make_unique<StageRunner>();
+    runner->stage = stage;
+    runner->input = std::make_unique<BoundedQueue<CapturedFrame>>(m_queueCapacity);
+    m_runners.push_back(std::move(runner));
+  }
+  for (size_t i = 0; i < m_runners.size(); ++i) {
+    m_runners[i]->thread = std::thread([this, i] { runStage(static_cast<int>(i)); });
+  }
+}
+
+void FramePipeline::stopRunners() {
+  for (auto &runner : m_runners) {
+    runner->input->close();
+  }
+  for (auto &runner : m_runners) {
+    runner->thread.join();
+  }
+  m_runners.clear();
+}
+
+cv::Mat &FramePipeline::StageRunner::nextOutput() {
+  // Un buffer de salida está libre cuando ninguna etapa posterior conserva referencias a él
+  for (cv::Mat &output : outputs) {
+    if (!output.u || output.u->refcount <= 1) {
+      return output;
+    }
+  }
+  outputs.emplace_back();
+  return outputs.back();
+}
+
+void FramePipeline::runStage(int index) {
+  // m_runners no cambia mientras los hilos de las etapas están vivos
+  StageRunner &runner = *m_runners[index];
+  StageRunner *next = index + 1 < static_cast<int>(m_runners.size()) ? m_runners[index + 1].get()
+                                                                      : nullptr;
+  CapturedFrame input;
+  while (runner.input->pop(input)) {
+    cv::Mat &output = runner.nextOutput();
+    const qint64 startNs = monotonicNowNs();
+    if (runner.stage.maskedFunction) {
+      runner.stage.maskedFunction(input.image, input.changes.get(), output);
+    } else {
+      runner.stage.function(input.image, output);
+    }
+    const qint64 elapsedNs = monotonicNowNs() - startNs;
+
+    runner.processed.fetch_add(1, std::memory_order_relaxed);
+    runner.lastNs.store(elapsedNs, std::memory_order_relaxed);
+    runner.totalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    if (elapsedNs > runner.maxNs.load(std::memory_order_relaxed)) {
+      runner.maxNs.store(elapsedNs, std::memory_order_relaxed);
+    }
+
+    CapturedFrame result;
+    result.image = output;
+    result.sequence = input.sequence;
+    result.captureTimeNs = input.captureTimeNs;
+    result.timestamps = input.timestamps;
+    result.changes = std::move(input.changes);
+    input.image.release();
+
+    if (next) {
+      // Entre etapas se bloquea: la contrapresión llega hasta la primera cola, que descarta
+      next->input->push(std::move(result));
+    } else {
+      deliver(result);
+    }
+  }
+}
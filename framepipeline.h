@@ -0,0 +1,94 @@
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+
+#include "boundedqueue.h"
+#include "capturedframe.h"
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Cadena de etapas de procesado entre la captura y la conversión para mostrar.
+//
+// Cada etapa es una función cv::Mat -> cv::Mat que corre en su propio hilo, unida a la siguiente
+// por una cola acotada, de modo que las etapas trabajan a la vez sobre frames consecutivos: el
+// rendimiento lo marca la etapa más lenta y no la suma de todas. Si la primera cola está llena el
+// frame se descarta en lugar de frenar la captura. Sin etapas, push() entrega el frame al destino
+// directamente en el hilo que llama.
+class FramePipeline {
+public:
+  // 'output' se recicla entre frames: si ya tiene el tamaño adecuado no hace falta reservar
+  using StageFunction = std::function<void(const cv::Mat &input, cv::Mat &output)>;
+  // Variante que recibe además las teselas cambiadas del frame (nulo = todas), para procesar solo
+  // esas y reutilizar lo demás de su resultado anterior
+  using MaskedStageFunction =
+      std::function<void(const cv::Mat &input, const ChangeMask *changes, cv::Mat &output)>;
+  using Sink = std::function<void(const CapturedFrame &frame)>;
+
+  struct Stage {
+    QString name;
+    StageFunction function;
+    MaskedStageFunction maskedFunction; // Si está, se usa en lugar de 'function'
+  };
+
+  struct StageStats {
+    QString name;
+    quint64 processed = 0;
+    double lastMs = 0;
+    double averageMs = 0;
+    double maxMs = 0;
+    int queued = 0;
+  };
+
+  explicit FramePipeline(int queueCapacity = 2);
+  ~FramePipeline();
+
+  // Se puede llamar en marcha: para las etapas actuales y arranca las nuevas
+  void setStages(const QVector<Stage> &stages);
+
+  void start(Sink sink);
+  void stop();
+
+  // false si el frame se descarta porque la primera etapa va retrasada
+  bool push(const CapturedFrame &frame);
+
+  bool hasStages() const;
+  QVector<StageStats> stageStats() const;
+  quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+  struct StageRunner {
+    Stage stage;
+    std::unique_ptr<BoundedQueue<CapturedFrame>> input;
+    std::thread thread;
+    std::vector<cv::Mat> outputs;
+    std::atomic<quint64> processed{0};
+    std::atomic<qint64> lastNs{0};
+    std::atomic<qint64> totalNs{0};
+    std::atomic<qint64> maxNs{0};
+
+    cv::Mat &nextOutput();
+  };
+
+  void startRunners();
+  void stopRunners();
+  void runStage(int index);
+  void deliver(const CapturedFrame &frame); // Llama a m_sink de uno en uno
+
+  const int m_queueCapacity;
+  mutable std::mutex m_controlMutex;
+  QVector<Stage> m_stages;
+  std::vector<std::unique_ptr<StageRunner>> m_runners;
+  Sink m_sink;
+  // Nunca con m_controlMutex cogido: stopRunners() lo tiene mientras espera a la última etapa,
+  // que necesita este para entregar
+  std::mutex m_deliveryMutex;
+  bool m_running{false};
+  std::atomic<quint64> m_dropped{0};
+};
+
+#endif // FRAMEPIPELINE_H
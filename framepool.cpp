@@ -0,0 +1,99 @@
+#include "framepool.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+FrameHandle::FrameHandle(const FrameHandle &other) : m_slot(other.m_slot) {
+  if (m_slot) {
+    m_slot->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+FrameHandle::FrameHandle(FrameHandle &&other) noexcept : m_slot(other.m_slot) {
+  other.m_slot = nullptr;
+}
+
+FrameHandle &FrameHandle::operator=(const FrameHandle &other) {
+  if (m_slot != other.m_slot) {
+    FrameHandle copy(other);
+    std::swap(m_slot, copy.m_slot);
+  }
+  return *this;
+}
+
+FrameHandle &FrameHandle::operator=(FrameHandle &&other) noexcept {
+  if (this != &other) {
+    reset();
+    std::swap(m_slot, other.m_slot);
+  }
+  return *this;
+}
+
+FrameHandle::~FrameHandle() { reset(); }
+
+void FrameHandle::reset() {
+  if (m_slot && m_slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    m_slot->pool->release(m_slot);
+  }
+  m_slot = nullptr;
+}
+
+FramePool::FramePool(int size)
+    : m_size(std::clamp(size, 1, 64)), m_slots(new FramePoolSlot[m_size]),
+      m_freeMask(m_size == 64 ? ~quint64(0) : (quint64(1) << m_size) - 1) {
+  for (int i = 0; i < m_size; ++i) {
+    m_slots[i].pool = this;
+    m_slots[i].index = i;
+  }
+}
+
+bool FramePool::isIdle() const {
+  const quint64 all = m_size == 64 ? ~quint64(0) : (quint64(1) << m_size) - 1;
+  return m_freeMask.load(std::memory_order_acquire) == all;
+}
+
+int FramePool::matTypeFor(QImage::Format format) {
+  switch (format) {
+  case QImage::Format_Grayscale8:
+    return CV_8UC1;
+  case QImage::Format_BGR888:
+    return CV_8UC3;
+  default:
+    return CV_8UC4;
+  }
+}
+
+FrameHandle FramePool::acquire(int width, int height, QImage::Format format) {
+  quint64 mask = m_freeMask.load(std::memory_order_acquire);
+  int index = -1;
+  while (mask != 0) {
+    const int candidate = static_cast<int>(qCountTrailingZeroBits(mask));
+    if (m_freeMask.compare_exchange_weak(
+            mask, mask & ~(quint64(1) << candidate), std::memory_order_acq_rel)) {
+      index = candidate;
+      break;
+    }
+  }
+  if (index < 0) {
+    m_exhausted.fetch_add(1, std::memory_order_relaxed);
+    return FrameHandle();
+  }
+
+  FramePoolSlot &slot = m_slots[index];
+  slot.refs.store(1, std::memory_order_relaxed);
+
+  // Solo se reserva memoria si cambia la resolución o el formato
+  const int type = matTypeFor(format);
+  if (slot.mat.cols != width || slot.mat.rows != height || slot.mat.type() != type) {
+    slot.mat.create(height, width, type);
+    slot.image = QImage();
+  }
+  if (slot.image.isNull() || slot.image.format() != format) {
+    slot.image = QImage(
+        slot.mat.data, slot.mat.cols, slot.mat.rows, static_cast<int>(slot.mat.step), format);
+  }
+  return FrameHandle(&slot);
+}
+
+void FramePool::release(FramePoolSlot *slot) {
+  m_freeMask.fetch_or(quint64(1) << slot->index, std::memory_order_release);
+}
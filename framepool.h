@@ -0,0 +1,86 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include "frametiming.h"
+#include <QImage>
+#include <QMetaType>
+#include <atomic>
+#include <memory>
+#include <opencv2/core.hpp>
+
+class FramePool;
+
+// Slot del pool: buffer de imagen reservado una vez y un QImage que apunta a esa misma memoria
+struct FramePoolSlot {
+  FramePool *pool = nullptr;
+  int index = 0;
+  std::atomic<int> refs{0};
+  cv::Mat mat;
+  QImage image;
+  quint64 sequence = 0;
+  qint64 captureTimeNs = 0;
+  FrameTimestamps timestamps;
+};
+
+// Referencia con contador a un frame del pool. Copiarla no copia píxeles; cuando se destruye la
+// última copia el slot vuelve al pool. image() y mat() solo son válidos mientras vive el handle.
+class FrameHandle {
+public:
+  FrameHandle() = default;
+  FrameHandle(const FrameHandle &other);
+  FrameHandle(FrameHandle &&other) noexcept;
+  FrameHandle &operator=(const FrameHandle &other);
+  FrameHandle &operator=(FrameHandle &&other) noexcept;
+  ~FrameHandle();
+
+  bool isNull() const { return m_slot == nullptr; }
+  void reset();
+
+  const QImage &image() const { return m_slot->image; }
+  const cv::Mat &mat() const { return m_slot->mat; }
+  quint64 sequence() const { return m_slot->sequence; }
+  qint64 captureTimeNs() const { return m_slot->captureTimeNs; }
+  const FrameTimestamps &timestamps() const { return m_slot->timestamps; }
+
+  // Solo para quien rellena el frame, antes de compartir el handle
+  cv::Mat &mat() { return m_slot->mat; }
+  void setSequence(quint64 sequence) { m_slot->sequence = sequence; }
+  void setCaptureTimeNs(qint64 timeNs) { m_slot->captureTimeNs = timeNs; }
+  void setTimestamps(const FrameTimestamps &timestamps) { m_slot->timestamps = timestamps; }
+
+private:
+  friend class FramePool;
+  explicit FrameHandle(FramePoolSlot *slot) : m_slot(slot) {}
+
+  FramePoolSlot *m_slot = nullptr;
+};
+Q_DECLARE_METATYPE(FrameHandle)
+
+// Pool de tamaño fijo de buffers de frame (máx. 64). En régimen estacionario acquire() no reserva
+// memoria: solo la primera vez o si cambia la resolución. El pool debe sobrevivir a sus handles.
+class FramePool {
+public:
+  explicit FramePool(int size = 8);
+
+  // Handle nulo si todos los slots están en uso (el consumidor va retrasado)
+  FrameHandle acquire(int width, int height, QImage::Format format);
+
+  // Tipo de mat() para cada formato: Format_Grayscale8 -> CV_8UC1, Format_BGR888 (B,G,R en
+  // memoria, como OpenCV) -> CV_8UC3 y los de 32 bits -> CV_8UC4
+  static int matTypeFor(QImage::Format format);
+
+  int size() const { return m_size; }
+  bool isIdle() const; // Ningún handle vivo: ya se puede destruir
+  quint64 exhaustedCount() const { return m_exhausted.load(std::memory_order_relaxed); }
+
+private:
+  friend class FrameHandle;
+  void release(FramePoolSlot *slot);
+
+  const int m_size;
+  std::unique_ptr<FramePoolSlot[]> m_slots;
+  std::atomic<quint64> m_freeMask; // Bit i a 1 = slot i libre
+  std::atomic<quint64> m_exhausted{0};
+};
+
+#endif // FRAMEPOOL_H
@@ -0,0 +1,108 @@
+#include "framepresenter.h"
+#include <QGuiApplication>
+#include <QPixmap>
+#include <QScreen>
+#include <QtMath>
+
+// Ticks sin frames nuevos antes de parar el temporizador
+static constexpr int kMaxIdleTicks = 30;
+
+FramePresenter::FramePresenter(QLabel *target, QObject *parent)
+    : QObject(parent), m_target(target) {
+  m_refreshTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_refreshTimer, &QTimer::timeout, this, &FramePresenter::onRefreshTick);
+}
+
+void FramePresenter::submit(const FrameHandle &frame) {
+  const qint64 receivedNs = monotonicNowNs();
+  FrameHandle previous = frame;
+  bool wakeUp = false;
+  {
+    QMutexLocker locker(&m_pendingMutex);
+    std::swap(previous, m_pending);
+    m_pendingReceivedNs = receivedNs;
+    wakeUp = !m_ticking;
+    m_ticking = true;
+  }
+  // El frame sustituido se suelta fuera del mutex (puede devolver el slot al pool)
+  if (!previous.isNull()) {
+    m_skipped.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (wakeUp) {
+    QMetaObject::invokeMethod(this, [this] { startTicks(); }, Qt::QueuedConnection);
+  }
+}
+
+void FramePresenter::startTicks() {
+  // Intervalo según la frecuencia de la pantalla donde está el QLabel
+  QScreen *screen = m_target->screen() ? m_target->screen() : QGuiApplication::primaryScreen();
+  const qreal refreshRate = screen ? screen->refreshRate() : 60.0;
+  const int intervalMs = qMax(1, qFloor(1000.0 / (refreshRate > 0 ? refreshRate : 60.0)));
+  m_idleTicks = 0;
+  m_refreshTimer.start(intervalMs);
+  onRefreshTick();
+}
+
+void FramePresenter::onRefreshTick() {
+  FrameHandle next;
+  qint64 receivedNs = 0;
+  {
+    QMutexLocker locker(&m_pendingMutex);
+    std::swap(next, m_pending);
+    receivedNs = m_pendingReceivedNs;
+    if (next.isNull() && ++m_idleTicks > kMaxIdleTicks) {
+      m_ticking = false;
+      m_refreshTimer.stop();
+      return;
+    }
+  }
+  if (next.isNull()) {
+    return;
+  }
+  m_idleTicks = 0;
+  m_current = std::move(next);
+
+  FrameTimestamps timestamps = m_current.timestamps();
+  timestamps.ns[FrameTiming::Received] = receivedNs;
+  timestamps.mark(FrameTiming::PaintStart);
+  present();
+  timestamps.mark(FrameTiming::Painted);
+  m_presented.fetch_add(1, std::memory_order_relaxed);
+
+  if (m_timing) {
+    m_timing->record(timestamps, FrameTiming::Deliver, FrameTiming::Total);
+  }
+  m_trace.add(m_current.sequence(), timestamps);
+}
+
+void FramePresenter::refresh() {
+  if (!m_current.isNull()) {
+    present();
+  }
+}
+
+void FramePresenter::clear() {
+  FrameHandle pending;
+  {
+    QMutexLocker locker(&m_pendingMutex);
+    std::swap(pending, m_pending);
+  }
+  m_current.reset();
+}
+
+void FramePresenter::present() {
+  // La vista previa llega ya escalada desde el hilo de conversión y se pinta tal cual; solo se
+  // escala aquí si la etiqueta ha cambiado de tamaño desde que se generó el frame
+  const QImage &image = m_current.image();
+  const qreal ratio = m_target->devicePixelRatioF();
+  const QSize fitted = image.size().scaled(m_target->size() * ratio, Qt::KeepAspectRatio);
+  QPixmap pixmap;
+  if (qAbs(fitted.width() - image.width()) <= 1 && qAbs(fitted.height() - image.height()) <= 1) {
+    pixmap = QPixmap::fromImage(image);
+  } else {
+    pixmap =
+        QPixmap::fromImage(image.scaled(fitted, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+  }
+  pixmap.setDevicePixelRatio(ratio);
+  m_target->setPixmap(pixmap);
+}
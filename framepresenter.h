@@ -0,0 +1,61 @@
+#ifndef FRAMEPRESENTER_H
+#define FRAMEPRESENTER_H
+
+#include "framepool.h"
+#include "frametiming.h"
+#include <QLabel>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+
+// Muestra frames en un QLabel como mucho una vez por refresco de pantalla.
+//
+// submit() puede llamarse desde cualquier hilo y no encola eventos: solo guarda el frame como
+// pendiente, sustituyendo al anterior si aún no se había mostrado (gana el último). En cada tick
+// del refresco se pinta el pendiente, así que la latencia no crece aunque la GUI vaya más lenta
+// que la cámara. Sin frames nuevos el temporizador se detiene y no consume CPU.
+class FramePresenter : public QObject {
+  Q_OBJECT
+public:
+  explicit FramePresenter(QLabel *target, QObject *parent = nullptr);
+
+  void submit(const FrameHandle &frame);
+
+  // Registra entrega, espera y pintado de cada frame mostrado (nullptr = no registrar)
+  void setTimingStats(FrameTimingStats *stats) { m_timing = stats; }
+
+  // --- Solo desde el hilo de la GUI ---
+  void refresh(); // Vuelve a pintar el frame actual (p.ej. tras cambiar el tamaño)
+  void clear();   // Suelta los frames retenidos y deja de pintar
+  FrameHandle currentFrame() const { return m_current; }
+  FrameTraceRecorder &trace() { return m_trace; }
+
+  quint64 presentedCount() const { return m_presented.load(std::memory_order_relaxed); }
+  quint64 skippedCount() const { return m_skipped.load(std::memory_order_relaxed); }
+
+private slots:
+  void onRefreshTick();
+
+private:
+  void startTicks();
+  void present();
+
+  QLabel *m_target;
+  QTimer m_refreshTimer;
+  int m_idleTicks{0};
+
+  QMutex m_pendingMutex;
+  FrameHandle m_pending;
+  qint64 m_pendingReceivedNs{0};
+  bool m_ticking{false}; // Protegido por m_pendingMutex
+  FrameHandle m_current;
+
+  FrameTimingStats *m_timing{nullptr};
+  FrameTraceRecorder m_trace;
+
+  std::atomic<quint64> m_presented{0};
+  std::atomic<quint64> m_skipped{0};
+};
+
+#endif // FRAMEPRESENTER_H
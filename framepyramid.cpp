@@ -0,0 +1,91 @@
+#include "framepyramid.h"
+#include "yuvframe.h"
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// Por debajo de esto no compensa otro nivel
+constexpr int kMinLevelSide = 64;
+
+} // namespace
+
+void FramePyramid::reset(const cv::Mat &image, FrameEncoding encoding) {
+  m_source = image;
+  m_encoding = encoding;
+  m_fullSize = image.empty() || encoding == FrameEncoding::Mjpeg ? cv::Size() : sizeOf(image);
+  m_builtLevels = 0;
+  m_scaledCount = 0;
+  m_resizes = 0;
+}
+
+cv::Size FramePyramid::sizeOf(const cv::Mat &image) const {
+  return Yuv::isYuv(m_encoding) ? Yuv::imageSize(image, m_encoding) : image.size();
+}
+
+bool FramePyramid::resizeTo(const cv::Mat &src, const cv::Size &size, cv::Mat &dst) {
+  ++m_resizes;
+  if (Yuv::isYuv(m_encoding)) {
+    return Yuv::resize(src, m_encoding, size, dst);
+  }
+  cv::resize(src, dst, size, 0, 0, cv::INTER_AREA);
+  return true;
+}
+
+const cv::Mat &FramePyramid::scaled(const cv::Size &requested) {
+  cv::Size size = requested;
+  if (Yuv::isYuv(m_encoding)) {
+    size = cv::Size(qMax(2, size.width & ~1), qMax(2, size.height & ~1));
+  }
+  if (m_fullSize.empty() || size.width > m_fullSize.width || size.height > m_fullSize.height ||
+      size.empty()) {
+    return m_empty;
+  }
+  if (size == m_fullSize) {
+    return m_source;
+  }
+  for (int i = 0; i < m_scaledCount; ++i) {
+    if (m_scaled[i].size == size) {
+      return m_scaled[i].image;
+    }
+  }
+
+  // Bajar por la pirámide mientras el siguiente nivel siga cubriendo el tamaño pedido
+  const cv::Mat *base = &m_source;
+  cv::Size baseSize = m_fullSize;
+  for (int level = 0;; ++level) {
+    cv::Size half(baseSize.width / 2, baseSize.height / 2);
+    if (Yuv::isYuv(m_encoding)) {
+      half = cv::Size(half.width & ~1, half.height & ~1);
+    }
+    if (half.width < size.width || half.height < size.height ||
+        qMin(half.width, half.height) < kMinLevelSide) {
+      break;
+    }
+    if (level >= m_builtLevels) {
+      if (int(m_levels.size()) <= level) {
+        m_levels.resize(level + 1);
+      }
+      m_levels[level].size = half;
+      if (!resizeTo(*base, half, m_levels[level].image)) {
+        break;
+      }
+      m_builtLevels = level + 1;
+    }
+    base = &m_levels[level].image;
+    baseSize = m_levels[level].size;
+  }
+  if (baseSize == size) {
+    return *base;
+  }
+
+  if (int(m_scaled.size()) <= m_scaledCount) {
+    m_scaled.resize(m_scaledCount + 1);
+  }
+  Level &result = m_scaled[m_scaledCount];
+  result.size = size;
+  if (!resizeTo(*base, size, result.image)) {
+    return m_empty;
+  }
+  ++m_scaledCount;
+  return result.image;
+}
@@ -0,0 +1,58 @@
+#ifndef FRAMEPYRAMID_H
+#define FRAMEPYRAMID_H
+
+#include "capturedframe.h"
+#include <opencv2/core.hpp>
+#include <deque>
+
+// Pirámide de reducciones de un frame, compartida por todos los que lo quieren más pequeño
+// (vista previa, flujos de salida de VideoCaptureHandler).
+//
+// Los niveles se obtienen a mitades con promedio de áreas, cada uno a partir del anterior, y solo
+// hasta donde alguien los pide. scaled() parte del nivel más pequeño que aún cubre el tamaño
+// pedido, así que reducir 4K a 640 px lee un frame de 960 px en vez del original, y cada tamaño
+// se calcula una sola vez por frame aunque lo pidan varios. Trabaja en la codificación del
+// frame: BGR, BGRA, GRAY o YUV (Yuv::resize), nunca en MJPEG.
+//
+// No copia el frame. Reutiliza sus buffers entre frames: cada objeto solo se usa desde un hilo a
+// la vez y lo devuelto vale hasta el siguiente reset() o clear().
+class FramePyramid {
+public:
+  void reset(const cv::Mat &image, FrameEncoding encoding);
+  // Suelta el frame en cuanto se ha terminado con él, para que quien lo decodificó (Mjpeg,
+  // Yuv::toBgr) pueda reutilizar su buffer en el siguiente. Los buffers de los niveles, que no
+  // comparten memoria con el frame, se quedan para el siguiente reset().
+  void clear() { reset(cv::Mat(), FrameEncoding::Decoded); }
+
+  FrameEncoding encoding() const { return m_encoding; }
+  cv::Size fullSize() const { return m_fullSize; }
+
+  // El frame reducido exactamente a 'size' (en YUV, redondeado a par), en su codificación.
+  // Vacío si no hay frame o 'size' es mayor que el frame.
+  const cv::Mat &scaled(const cv::Size &size);
+
+  // Reducciones hechas desde el último reset(): niveles más tamaños finales
+  int resizeCount() const { return m_resizes; }
+
+private:
+  struct Level {
+    cv::Size size;
+    cv::Mat image;
+  };
+
+  cv::Size sizeOf(const cv::Mat &image) const;
+  bool resizeTo(const cv::Mat &src, const cv::Size &size, cv::Mat &dst);
+
+  cv::Mat m_source;
+  FrameEncoding m_encoding = FrameEncoding::Decoded;
+  cv::Size m_fullSize;
+  // deque: crecer no mueve los niveles ya hechos, a los que puede haber referencias
+  std::deque<Level> m_levels; // Mitad, cuarto... del frame; solo los m_builtLevels primeros valen
+  int m_builtLevels = 0;
+  std::deque<Level> m_scaled; // Tamaños finales pedidos en este frame
+  int m_scaledCount = 0;
+  int m_resizes = 0;
+  cv::Mat m_empty;
+};
+
+#endif // FRAMEPYRAMID_H
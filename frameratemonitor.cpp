@@ -0,0 +1,72 @@
+#include "frameratemonitor.h"
+#include <cmath>
+
+void FrameRateMonitor::reset(double nominalFps) {
+  m_last = -1;
+  m_intervalNs = nominalFps > 0 ? 1e9 / nominalFps : 0;
+  m_gapRun = 0;
+  m_gapRunLost = 0;
+  m_gapRunNs = 0;
+  m_lost = 0;
+  m_duplicates = 0;
+  m_achievedFps = 0;
+}
+
+void FrameRateMonitor::restartWindow(qint64 timestampNs) {
+  m_last = timestampNs;
+  m_windowStart = timestampNs;
+  m_windowFrames = 0;
+  m_gapRun = 0;
+  m_gapRunLost = 0;
+  m_gapRunNs = 0;
+}
+
+FrameRateMonitor::Arrival FrameRateMonitor::update(qint64 timestampNs) {
+  if (m_last < 0 || timestampNs < m_last) {
+    // Primer frame, fichero en bucle o reloj del driver reiniciado
+    restartWindow(timestampNs);
+    return Arrival::First;
+  }
+  const qint64 deltaNs = timestampNs - m_last;
+  if (deltaNs == 0) {
+    m_duplicates.fetch_add(1, std::memory_order_relaxed);
+    return Arrival::Duplicate;
+  }
+  m_last = timestampNs;
+
+  ++m_windowFrames;
+  if (timestampNs - m_windowStart >= 1000000000) {
+    m_achievedFps.store(
+        m_windowFrames * 1e9 / double(timestampNs - m_windowStart), std::memory_order_relaxed);
+    m_windowStart = timestampNs;
+    m_windowFrames = 0;
+  }
+
+  if (m_intervalNs <= 0) {
+    m_intervalNs = double(deltaNs);
+    return Arrival::Normal;
+  }
+  if (deltaNs > 1.5 * m_intervalNs) {
+    const quint64 missing =
+        quint64(qMax<qint64>(1, std::llround(deltaNs / m_intervalNs) - 1));
+    m_lost.fetch_add(missing, std::memory_order_relaxed);
+    ++m_gapRun;
+    m_gapRunLost += missing;
+    m_gapRunNs += double(deltaNs);
+    if (m_gapRun >= kRateChangeRun) {
+      // El origen va más lento de lo esperado, no está perdiendo frames: se deshace la cuenta
+      m_lost.fetch_sub(m_gapRunLost, std::memory_order_relaxed);
+      m_intervalNs = m_gapRunNs / m_gapRun;
+      m_gapRun = 0;
+      m_gapRunLost = 0;
+      m_gapRunNs = 0;
+    }
+    return Arrival::AfterGap;
+  }
+  m_gapRun = 0;
+  m_gapRunLost = 0;
+  m_gapRunNs = 0;
+  // Seguir al ritmo medido: el negociado es aproximado y el reloj de la cámara deriva
+  m_intervalNs += (double(deltaNs) - m_intervalNs) / 16;
+  return Arrival::Normal;
+}
@@ -0,0 +1,53 @@
+#ifndef FRAMERATEMONITOR_H
+#define FRAMERATEMONITOR_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Ritmo real de un origen a partir de las marcas de tiempo de sus frames (las del driver si las
+// da, FrameSource::timestampNs(); si no, el instante en que volvió grab()):
+//   - un hueco de más de 1,5 intervalos son frames que no llegaron (el driver se quedó sin
+//     buffers porque no se leían a tiempo, o la cámara o el bus los perdieron)
+//   - una marca igual a la anterior es el mismo frame entregado otra vez
+//   - los fps conseguidos se miden por ventanas de un segundo
+// El intervalo esperado parte del ritmo negociado y sigue al medido. Varios huecos seguidos se
+// toman como un cambio de ritmo (la exposición automática alarga el frame con poca luz) y dejan
+// de contar como perdidos.
+//
+// update() solo desde el hilo de captura; los contadores se pueden leer desde cualquier hilo.
+class FrameRateMonitor {
+public:
+  enum class Arrival {
+    First,     // Primer frame o discontinuidad (la marca retrocede): sin referencia previa
+    Normal,
+    Duplicate, // Misma marca que el anterior
+    AfterGap,  // Faltan frames antes de este (ver lost())
+  };
+
+  // Al abrir o renegociar el origen; 'nominalFps' <= 0 si no se sabe
+  void reset(double nominalFps);
+  Arrival update(qint64 timestampNs);
+
+  quint64 lost() const { return m_lost.load(std::memory_order_relaxed); }
+  quint64 duplicates() const { return m_duplicates.load(std::memory_order_relaxed); }
+  double achievedFps() const { return m_achievedFps.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr int kRateChangeRun = 8; // Huecos seguidos que se toman como cambio de ritmo
+
+  void restartWindow(qint64 timestampNs);
+
+  qint64 m_last = -1;
+  double m_intervalNs = 0; // Intervalo esperado; 0 = aún no se sabe
+  int m_gapRun = 0;
+  quint64 m_gapRunLost = 0;
+  double m_gapRunNs = 0;
+  qint64 m_windowStart = 0;
+  int m_windowFrames = 0;
+
+  std::atomic<quint64> m_lost{0};
+  std::atomic<quint64> m_duplicates{0};
+  std::atomic<double> m_achievedFps{0};
+};
+
+#endif // FRAMERATEMONITOR_H
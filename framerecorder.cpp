@@ -0,0 +1,117 @@
+#include "framerecorder.h"
+#include "framedecoder.h"
+#include <QDebug>
+
+FrameRecorder::FrameRecorder(int queueCapacity) : m_queueCapacity(qMax(1, queueCapacity)) {}
+
+FrameRecorder::~FrameRecorder() { stop(); }
+
+void FrameRecorder::start(std::shared_ptr<FrameSink> sink, Policy policy) {
+  stop();
+  std::lock_guard<std::mutex> lock(m_controlMutex);
+  m_policy = policy;
+  m_written = 0;
+  m_dropped = 0;
+  m_maxBacklog = 0;
+  m_failed = false;
+  m_queue = std::make_shared<BoundedQueue<CapturedFrame>>(m_queueCapacity);
+  // El hilo de escritura es el dueño del destino
+  m_thread = std::thread([this, queue = m_queue, sink = std::move(sink)] {
+    writeLoop(*queue, *sink);
+  });
+  m_recording.store(true, std::memory_order_release);
+}
+
+void FrameRecorder::stop() {
+  std::thread thread;
+  {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    if (!m_queue) {
+      return;
+    }
+    m_recording.store(false, std::memory_order_release);
+    m_queue->close(); // El hilo vacía la cola antes de salir
+    m_queue.reset();
+    thread = std::move(m_thread);
+  }
+  // Se espera fuera del mutex para que push() no se quede bloqueado mientras se vacía la cola
+  thread.join();
+}
+
+bool FrameRecorder::push(const CapturedFrame &frame) {
+  if (!isRecording()) {
+    return false;
+  }
+  std::shared_ptr<BoundedQueue<CapturedFrame>> queue;
+  Policy policy;
+  {
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    queue = m_queue;
+    policy = m_policy;
+  }
+  if (!queue) {
+    return false;
+  }
+  // Fuera del mutex: con Block la espera no debe impedir que stop() cierre la cola
+  const bool queued = policy == Policy::Block ? queue->push(frame) : queue->tryPush(frame);
+  if (!queued) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  const int backlog = static_cast<int>(queue->size());
+  if (backlog > m_maxBacklog.load(std::memory_order_relaxed)) {
+    m_maxBacklog.store(backlog, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+FrameRecorder::Stats FrameRecorder::stats() const {
+  Stats stats;
+  stats.recording = isRecording();
+  stats.failed = m_failed.load(std::memory_order_relaxed);
+  stats.written = m_written.load(std::memory_order_relaxed);
+  stats.dropped = m_dropped.load(std::memory_order_relaxed);
+  stats.maxBacklog = m_maxBacklog.load(std::memory_order_relaxed);
+  stats.capacity = m_queueCapacity;
+  std::lock_guard<std::mutex> lock(m_controlMutex);
+  if (m_queue) {
+    stats.backlog = static_cast<int>(m_queue->size());
+  }
+  return stats;
+}
+
+void FrameRecorder::writeLoop(BoundedQueue<CapturedFrame> &queue, FrameSink &sink) {
+  bool opened = false;
+  CapturedFrame frame;
+  while (queue.pop(frame)) {
+    // Los frames MJPEG se decodifican aquí, a resolución completa, solo si el destino lo necesita;
+    // los YUV se pasan a BGR siempre
+    const CapturedFrame *output = &frame;
+    const bool passMjpeg = frame.encoding == FrameEncoding::Mjpeg && sink.acceptsMjpeg();
+    if (frame.encoding != FrameEncoding::Decoded && !passMjpeg) {
+      if (!FrameDecoder::toBgr(frame, m_decoded)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        frame.image.release();
+        continue;
+      }
+      output = &m_decoded;
+    }
+    if (!opened && !m_failed) {
+      opened = sink.open(output->image.size(), output->image.type(), m_fps.load());
+      if (!opened) {
+        qWarning() << "FrameRecorder - No se pudo abrir el destino" << sink.description();
+        m_failed = true;
+        queue.close(); // Los siguientes push() fallan enseguida y cuentan como descartados
+      }
+    }
+    if (opened && sink.write(*output)) {
+      m_written.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    frame.image.release(); // Soltar los píxeles ya: el hilo de captura puede reutilizarlos
+  }
+  if (opened) {
+    sink.close();
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef FRAMERECORDER_H
+#define FRAMERECORDER_H
+
+#include "boundedqueue.h"
+#include "capturedframe.h"
+#include "framesink.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Grabación en segundo plano: el hilo de captura entrega cada frame con push(), que solo copia
+// la cabecera del cv::Mat (los píxeles se comparten por contador de referencias), y un hilo
+// propio lo codifica en el FrameSink. Entre ambos hay una cola acotada; qué pasa cuando se llena
+// lo decide la política:
+//   DropNewest  se descarta el frame que llega y la captura sigue a su ritmo (por defecto)
+//   Block       la captura espera al codificador: no se pierde nada, pero puede bajar el ritmo
+class FrameRecorder {
+public:
+  enum class Policy { DropNewest, Block };
+
+  struct Stats {
+    bool recording = false;
+    bool failed = false; // El destino no se pudo abrir o dejó de aceptar frames
+    quint64 written = 0;
+    quint64 dropped = 0;
+    int backlog = 0; // Frames en cola esperando al codificador
+    int maxBacklog = 0;
+    int capacity = 0;
+  };
+
+  explicit FrameRecorder(int queueCapacity = 16);
+  ~FrameRecorder();
+
+  // --- Desde el hilo de la GUI ---
+  // El destino se comparte para que quien lo creó pueda seguir consultándolo (PreTriggerBuffer)
+  void start(std::shared_ptr<FrameSink> sink, Policy policy = Policy::DropNewest);
+  void stop(); // Termina de escribir lo que haya en cola y cierra el destino
+  bool isRecording() const { return m_recording.load(std::memory_order_acquire); }
+
+  // --- Desde el hilo de captura ---
+  void setFrameRate(double fps) { m_fps.store(fps > 0 ? fps : 30.0, std::memory_order_relaxed); }
+  bool push(const CapturedFrame &frame);
+
+  Stats stats() const;
+
+private:
+  void writeLoop(BoundedQueue<CapturedFrame> &queue, FrameSink &sink);
+
+  CapturedFrame m_decoded; // Solo lo usa writeLoop(), para frames MJPEG
+
+  const int m_queueCapacity;
+  mutable std::mutex m_controlMutex;
+  std::shared_ptr<BoundedQueue<CapturedFrame>> m_queue; // Nulo sin grabación en curso
+  std::thread m_thread;
+  Policy m_policy{Policy::DropNewest};
+
+  std::atomic<bool> m_recording{false};
+  std::atomic<bool> m_failed{false};
+  std::atomic<double> m_fps{30.0};
+  std::atomic<quint64> m_written{0};
+  std::atomic<quint64> m_dropped{0};
+  std::atomic<int> m_maxBacklog{0};
+};
+
+#endif // FRAMERECORDER_H
@@ -0,0 +1,78 @@
+#include "framering.h"
+#include <algorithm>
+#include <utility>
+
+FrameRing::FrameRing(int depth)
+    : m_depth(std::clamp(depth, 2, 64)), m_buffers(m_depth + 2), m_slots(m_depth) {
+  // Buffers [0, depth) empiezan en el anillo; los dos últimos son del productor y del consumidor
+  for (int i = 0; i < m_depth; ++i) {
+    m_slots[i].store(pack(0, i), std::memory_order_relaxed);
+  }
+  m_producerIndex = m_depth;
+  m_consumerIndex = m_depth + 1;
+}
+
+CapturedFrame &FrameRing::producerFrame() {
+  CapturedFrame &frame = m_buffers[m_producerIndex];
+  // Un consumidor se quedó con una referencia a esta memoria: se suelta para no pisarla
+  if (frame.image.u && frame.image.u->refcount > 1) {
+    frame.image.release();
+  }
+  return frame;
+}
+
+void FrameRing::publish() {
+  const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+  const std::uint64_t previous = m_slots[head % m_depth].exchange(
+      pack(head + 1, m_producerIndex), std::memory_order_acq_rel);
+  m_producerIndex = indexOf(previous);
+  if (sequenceOf(previous) != 0) {
+    // El consumidor no llegó a leer ese frame: gana el más reciente
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+  m_head.store(head + 1, std::memory_order_seq_cst);
+}
+
+bool FrameRing::takeSlot(std::uint64_t position, CapturedFrame &frame) {
+  const std::uint64_t previous = m_slots[position % m_depth].exchange(
+      pack(0, m_consumerIndex), std::memory_order_acq_rel);
+  m_consumerIndex = indexOf(previous);
+  const std::uint64_t sequence = sequenceOf(previous);
+  if (sequence == 0) {
+    return false;
+  }
+  // Si el productor sobrescribió el slot mientras tanto, nos quedamos con el frame más nuevo
+  m_tail = sequence;
+  std::swap(frame, m_buffers[m_consumerIndex]);
+  return true;
+}
+
+bool FrameRing::popNext(CapturedFrame &frame) {
+  // El slot se publica antes que la cabeza, así que m_tail puede ir un frame por delante
+  const std::uint64_t head = m_head.load(std::memory_order_acquire);
+  if (m_tail >= head) {
+    return false;
+  }
+  std::uint64_t position = m_tail;
+  if (head - position > static_cast<std::uint64_t>(m_depth)) {
+    position = head - m_depth; // Los anteriores ya se sobrescribieron
+  }
+  for (; position < head; ++position) {
+    if (takeSlot(position, frame)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FrameRing::popLatest(CapturedFrame &frame) {
+  const std::uint64_t head = m_head.load(std::memory_order_acquire);
+  if (m_tail >= head) {
+    return false;
+  }
+  // Los frames intermedios se quedan en el anillo y cuentan como descartados al sobrescribirse
+  if (takeSlot(head - 1, frame)) {
+    return true;
+  }
+  return popNext(frame);
+}
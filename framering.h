@@ -0,0 +1,65 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include "capturedframe.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Anillo lock-free de un productor y un consumidor (SPSC) para frames capturados.
+//
+// Los buffers se reservan una sola vez y se reciclan: el productor escribe en su buffer privado y
+// lo publica intercambiándolo atómicamente con un slot del anillo; el consumidor hace lo mismo al
+// leer. Cada buffer está siempre en un único sitio (anillo, productor o consumidor), así que nadie
+// escribe sobre un frame que otro hilo está leyendo.
+//
+// Si el consumidor va retrasado, el productor sobrescribe el frame más antiguo (gana el último
+// frame) en lugar de bloquearse, y lo contabiliza como descartado.
+class FrameRing {
+public:
+  explicit FrameRing(int depth = 4);
+
+  int depth() const { return m_depth; }
+
+  // --- Lado productor (un único hilo) ---
+  // Buffer donde escribir el siguiente frame. Si un consumidor aún conserva una referencia a su
+  // memoria, se desvincula para no sobrescribirla.
+  CapturedFrame &producerFrame();
+  void publish();
+
+  // --- Lado consumidor (un único hilo) ---
+  // Intercambian el contenido de 'frame' con el frame leído: la memoria que el consumidor entrega
+  // vuelve al anillo y se reutiliza en capturas posteriores.
+  bool popNext(CapturedFrame &frame);
+  bool popLatest(CapturedFrame &frame);
+  bool hasFrames() const { return m_head.load(std::memory_order_seq_cst) > m_tail; }
+
+  quint64 publishedCount() const { return m_head.load(std::memory_order_relaxed); }
+  quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+  // Cada slot guarda (secuencia << 8 | índice de buffer); secuencia 0 significa slot vacío
+  static constexpr int kIndexBits = 8;
+  static constexpr std::uint64_t kIndexMask = (1u << kIndexBits) - 1;
+
+  static std::uint64_t pack(std::uint64_t sequence, int index) {
+    return (sequence << kIndexBits) | static_cast<std::uint64_t>(index);
+  }
+  static std::uint64_t sequenceOf(std::uint64_t slot) { return slot >> kIndexBits; }
+  static int indexOf(std::uint64_t slot) { return static_cast<int>(slot & kIndexMask); }
+
+  bool takeSlot(std::uint64_t position, CapturedFrame &frame);
+
+  const int m_depth;
+  std::vector<CapturedFrame> m_buffers;
+  std::vector<std::atomic<std::uint64_t>> m_slots;
+
+  int m_producerIndex;
+  int m_consumerIndex;
+  std::uint64_t m_tail{0}; // Solo lo toca el consumidor
+
+  std::atomic<std::uint64_t> m_head{0};
+  std::atomic<std::uint64_t> m_dropped{0};
+};
+
+#endif // FRAMERING_H
@@ -0,0 +1,24 @@
+#ifndef FRAMESINK_H
+#define FRAMESINK_H
+
+#include "capturedframe.h"
+#include <QString>
+
+// Destino de grabación de frames (fichero de vídeo, segmentos...). Lo usa FrameRecorder desde su
+// propio hilo, nunca desde el de captura, así que write() puede tardar lo que haga falta.
+class FrameSink {
+public:
+  virtual ~FrameSink() = default;
+
+  // Se llama con el primer frame, cuando ya se conocen tamaño y tipo
+  virtual bool open(const cv::Size &size, int type, double fps) = 0;
+  virtual bool write(const CapturedFrame &frame) = 0;
+  virtual void close() = 0;
+
+  // true si write() admite frames MJPEG sin decodificar; si no, FrameRecorder los decodifica antes
+  virtual bool acceptsMjpeg() const { return false; }
+
+  virtual QString description() const = 0;
+};
+
+#endif // FRAMESINK_H
@@ -0,0 +1,83 @@
+#include "framesource.h"
+#include "camerasource.h"
+#include "filesource.h"
+#include "syntheticsource.h"
+#include <QDebug>
+#include <QStringList>
+#include <thread>
+
+std::unique_ptr<FrameSource> FrameSource::create(const QString &spec, const QSize &resolution) {
+  const int colon = spec.indexOf(':');
+  const QString kind = (colon < 0 ? spec : spec.left(colon)).trimmed().toLower();
+  const QString argument = colon < 0 ? QString() : spec.mid(colon + 1);
+
+  if (kind == "camera" || kind == "v4l2" || kind == "dshow" || kind == "mjpeg" || kind == "yuyv" ||
+      kind == "nv12") {
+    bool ok = false;
+    const int cameraId = argument.toInt(&ok);
+    if (!ok) {
+      qWarning() << "FrameSource::create() - Índice de cámara no válido:" << spec;
+      return nullptr;
+    }
+    const int api = kind == "v4l2"    ? cv::CAP_V4L2
+                    : kind == "dshow" ? cv::CAP_DSHOW
+                                      : CameraSource::nativeBackend();
+    const FrameEncoding encoding = kind == "mjpeg"  ? FrameEncoding::Mjpeg
+                                   : kind == "yuyv" ? FrameEncoding::Yuyv
+                                   : kind == "nv12" ? FrameEncoding::Nv12
+                                                    : FrameEncoding::Decoded;
+    return std::make_unique<CameraSource>(cameraId, api, resolution, encoding);
+  }
+
+  if (kind == "file") {
+    return std::make_unique<FileSource>(argument);
+  }
+
+  if (kind == "synthetic") {
+    // synthetic[:WxH[@FPS][:gray|bgra]]
+    QSize size = resolution.isEmpty() ? QSize(1280, 720) : resolution;
+    double fps = 30;
+    int type = CV_8UC3;
+    const QStringList parts = argument.split(':', Qt::SkipEmptyParts);
+    if (!parts.isEmpty()) {
+      const QStringList rate = parts[0].split('@');
+      const QStringList dims = rate[0].split('x');
+      if (dims.size() == 2 && dims[0].toInt() > 0 && dims[1].toInt() > 0) {
+        size = QSize(dims[0].toInt(), dims[1].toInt());
+      }
+      if (rate.size() == 2) {
+        fps = rate[1].toDouble();
+      }
+    }
+    if (parts.size() > 1) {
+      const QString format = parts[1].toLower();
+      type = format == "gray" ? CV_8UC1 : format == "bgra" ? CV_8UC4 : CV_8UC3;
+    }
+    return std::make_unique<SyntheticSource>(size, fps, type);
+  }
+
+  qWarning() << "FrameSource::create() - Origen desconocido:" << spec;
+  return nullptr;
+}
+
+void FramePacer::setFps(double fps) {
+  m_fps = fps > 0 ? fps : 0;
+  m_started = false;
+}
+
+void FramePacer::wait() {
+  if (m_fps <= 0) {
+    return;
+  }
+  const auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / m_fps));
+  const Clock::time_point now = Clock::now();
+  // Si se va más de un frame por detrás no se intenta recuperar a ráfagas
+  if (!m_started || now - m_nextFrame > period) {
+    m_started = true;
+    m_nextFrame = now + period;
+    return;
+  }
+  std::this_thread::sleep_until(m_nextFrame);
+  m_nextFrame += period;
+}
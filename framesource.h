@@ -0,0 +1,84 @@
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include "capturedframe.h"
+#include "devicecapabilities.h"
+#include <QSize>
+#include <QString>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <opencv2/core.hpp>
+
+// Origen de frames para VideoCaptureHandler, con la misma forma que cv::VideoCapture (grab,
+// retrieve, get, set) para poder cambiar de backend sin tocar el bucle de captura.
+//
+// create() construye el origen a partir de una cadena:
+//   camera:N         cámara N con el backend nativo (DirectShow en Windows, V4L2 en Linux)
+//   v4l2:N, dshow:N  cámara N con un backend concreto
+//   mjpeg:N          cámara N en MJPEG sin decodificar: la decodificación se hace fuera del hilo
+//                    de captura y a escala reducida para la vista previa (ver mjpeg.h)
+//   yuyv:N, nv12:N   cámara N en YUV sin pasar a BGR: la vista previa se convierte en una pasada
+//                    y la luma se lee directamente (ver yuvframe.h)
+//   file:RUTA        vídeo o secuencia de imágenes (p.ej. file:/datos/img_%04d.png)
+//   synthetic[:WxH[@FPS][:gray|bgra]]  patrón determinista generado
+class FrameSource {
+public:
+  virtual ~FrameSource() = default;
+
+  static std::unique_ptr<FrameSource> create(const QString &spec, const QSize &resolution = {});
+  static QString cameraSpec(int cameraId) { return QStringLiteral("camera:%1").arg(cameraId); }
+
+  virtual bool open() = 0;
+  virtual bool isOpened() const = 0;
+  virtual void release() = 0;
+
+  // grab() bloquea hasta que hay un frame nuevo (el driver, o el ritmo del fichero o patrón)
+  virtual bool grab() = 0;
+  virtual bool retrieve(cv::Mat &image) = 0;
+  // Qué entrega retrieve(): píxeles, el frame comprimido de la cámara o su YUV
+  virtual FrameEncoding encoding() const { return FrameEncoding::Decoded; }
+
+  virtual bool set(int propId, double value) = 0;
+  virtual double get(int propId) const = 0;
+
+  // Instante en que el driver capturó el frame del último grab(), en nanosegundos de un reloj
+  // monotónico propio del driver; 0 si no lo da (entonces vale el instante en que volvió grab())
+  virtual qint64 timestampNs() const { return 0; }
+
+  virtual QString description() const = 0;
+
+  // Identidad estable del dispositivo para DeviceCapabilityCache; vacía = no se guarda en caché
+  virtual QString deviceKey() const { return QString(); }
+  // Límites reales de una propiedad (solo min y max) si el backend sabe consultarlos
+  virtual bool propertyRange(int propId, PropertyRange &range) const {
+    Q_UNUSED(propId);
+    Q_UNUSED(range);
+    return false;
+  }
+  virtual QList<CaptureFormat> captureFormats() const { return {}; }
+
+  // Sondeo completo (soporte, rangos con su valor actual y formatos) que se puede ejecutar en
+  // otro hilo mientras el origen captura: no usa el origen, solo lo que lleva capturado, así que
+  // sigue siendo válido aunque el origen se cierre. Vacío si el backend solo sabe consultar a
+  // través de get(), que no se puede llamar a la vez que grab().
+  using CapabilityProbe = std::function<bool(DeviceCapabilities &capabilities)>;
+  virtual CapabilityProbe capabilityProbe() const { return {}; }
+};
+
+// Espera entre frames para reproducir a un ritmo fijo los orígenes que no lo marcan solos
+class FramePacer {
+public:
+  void setFps(double fps);
+  double fps() const { return m_fps; }
+  void reset() { m_started = false; }
+  void wait();
+
+private:
+  using Clock = std::chrono::steady_clock;
+  double m_fps = 0; // 0 = sin esperas (lo más rápido posible)
+  bool m_started = false;
+  Clock::time_point m_nextFrame;
+};
+
+#endif // FRAMESOURCE_H
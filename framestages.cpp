@@ -0,0 +1,107 @@
+#include "framestages.h"
+#include <QObject>
+#include <memory>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace FrameStages {
+
+FramePipeline::Stage denoise(int kernelSize) {
+  const int size = kernelSize | 1; // El núcleo gaussiano tiene que ser impar
+  FramePipeline::Stage stage{
+      QObject::tr("Suavizado"), [size](const cv::Mat &input, cv::Mat &output) {
+        cv::GaussianBlur(input, output, cv::Size(size, size), 0);
+      }};
+  // Con máscara de cambios solo se vuelven a suavizar las teselas cambiadas, ampliadas con el
+  // radio del núcleo; el resto sale del resultado anterior. Sobre un trozo de la imagen el filtro
+  // lee los píxeles de alrededor, así que no aparecen costuras entre teselas.
+  auto previous = std::make_shared<cv::Mat>();
+  stage.maskedFunction = [size, previous](
+                             const cv::Mat &input, const ChangeMask *changes, cv::Mat &output) {
+    const cv::Rect frame(0, 0, input.cols, input.rows);
+    if (!changes || changes->frameSize != input.size() || previous->size() != input.size() ||
+        previous->type() != input.type()) {
+      cv::GaussianBlur(input, *previous, cv::Size(size, size), 0);
+    } else {
+      const int margin = size / 2;
+      for (int y = 0; y < changes->tilesY; ++y) {
+        for (int x = 0; x < changes->tilesX; ++x) {
+          if (!changes->isChanged(x, y)) {
+            continue;
+          }
+          const cv::Rect tile = changes->tileRect(x, y);
+          const cv::Rect rect =
+              cv::Rect(
+                  tile.x - margin, tile.y - margin, tile.width + 2 * margin,
+                  tile.height + 2 * margin) &
+              frame;
+          cv::Mat target = (*previous)(rect);
+          cv::GaussianBlur(input(rect), target, cv::Size(size, size), 0);
+        }
+      }
+    }
+    previous->copyTo(output);
+  };
+  return stage;
+}
+
+FramePipeline::Stage threshold(double value, bool adaptive) {
+  // El gris intermedio se reutiliza entre frames (cada etapa corre siempre en el mismo hilo)
+  auto gray = std::make_shared<cv::Mat>();
+  return {QObject::tr("Umbral"), [value, adaptive, gray](const cv::Mat &input, cv::Mat &output) {
+            const cv::Mat *source = &input;
+            if (input.channels() != 1) {
+              cv::cvtColor(input, *gray, input.channels() == 4 ? cv::COLOR_BGRA2GRAY
+                                                               : cv::COLOR_BGR2GRAY);
+              source = gray.get();
+            }
+            if (adaptive) {
+              cv::adaptiveThreshold(
+                  *source, output, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 15, 5);
+            } else {
+              cv::threshold(*source, output, value, 255, cv::THRESH_BINARY);
+            }
+          }};
+}
+
+FramePipeline::Stage undistort(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs) {
+  struct Maps {
+    cv::Size size;
+    cv::Mat mapX;
+    cv::Mat mapY;
+  };
+  auto maps = std::make_shared<Maps>();
+  const cv::Mat camera = cameraMatrix.clone();
+  const cv::Mat dist = distCoeffs.clone();
+  return {QObject::tr("Corrección de distorsión"),
+          [maps, camera, dist](const cv::Mat &input, cv::Mat &output) {
+            if (maps->size != input.size()) {
+              cv::initUndistortRectifyMap(
+                  camera, dist, cv::Mat(), camera, input.size(), CV_16SC2, maps->mapX,
+                  maps->mapY);
+              maps->size = input.size();
+            }
+            cv::remap(input, output, maps->mapX, maps->mapY, cv::INTER_LINEAR);
+          }};
+}
+
+QStringList presetNames() {
+  return {
+      QObject::tr("Sin procesado"), QObject::tr("Suavizado"), QObject::tr("Umbral"),
+      QObject::tr("Suavizado + Umbral adaptativo")};
+}
+
+QVector<FramePipeline::Stage> preset(int index) {
+  switch (index) {
+  case 1:
+    return {denoise()};
+  case 2:
+    return {threshold()};
+  case 3:
+    return {denoise(), threshold(128, true)};
+  default:
+    return {};
+  }
+}
+
+} // namespace FrameStages
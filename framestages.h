@@ -0,0 +1,21 @@
+#ifndef FRAMESTAGES_H
+#define FRAMESTAGES_H
+
+#include "framepipeline.h"
+#include <QStringList>
+
+// Etapas de procesado listas para usar en FramePipeline
+namespace FrameStages {
+
+FramePipeline::Stage denoise(int kernelSize = 5);
+FramePipeline::Stage threshold(double value = 128, bool adaptive = false);
+// Los mapas de corrección se calculan una vez, con el tamaño del primer frame
+FramePipeline::Stage undistort(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs);
+
+// Combinaciones ofrecidas en la GUI (mismo orden que presetNames())
+QStringList presetNames();
+QVector<FramePipeline::Stage> preset(int index);
+
+} // namespace FrameStages
+
+#endif // FRAMESTAGES_H
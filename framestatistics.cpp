@@ -0,0 +1,185 @@
+#include "framestatistics.h"
+#include "frametiming.h"
+#include <QtMath>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRAMESTATISTICS_SSE2 1
+#endif
+
+namespace {
+
+void accumulateHistogram(const cv::Mat &luma, ImageStatistics &stats) {
+  // Cuatro histogramas parciales: varios píxeles iguales seguidos no esperan unos a otros al
+  // incrementar el mismo contador
+  std::array<std::array<quint32, 256>, 4> partial{};
+  for (int y = 0; y < luma.rows; ++y) {
+    const uchar *row = luma.ptr<uchar>(y);
+    int x = 0;
+    for (; x + 4 <= luma.cols; x += 4) {
+      ++partial[0][row[x]];
+      ++partial[1][row[x + 1]];
+      ++partial[2][row[x + 2]];
+      ++partial[3][row[x + 3]];
+    }
+    for (; x < luma.cols; ++x) {
+      ++partial[0][row[x]];
+    }
+  }
+
+  quint64 sum = 0;
+  for (int value = 0; value < 256; ++value) {
+    const quint32 count = partial[0][value] + partial[1][value] + partial[2][value] +
+                          partial[3][value];
+    stats.histogram[value] = count;
+    sum += quint64(count) * value;
+  }
+  stats.samples = luma.rows * luma.cols;
+  stats.mean = double(sum) / stats.samples;
+}
+
+struct LaplacianSums {
+  qint64 sum = 0;
+  quint64 squares = 0;
+  qint64 count = 0;
+};
+
+// 4c - (izquierda + derecha + arriba + abajo), en [-1020, 1020]
+inline int laplacianAt(const uchar *up, const uchar *row, const uchar *down, int x) {
+  return 4 * row[x] - row[x - 1] - row[x + 1] - up[x] - down[x];
+}
+
+LaplacianSums laplacianSums(const cv::Mat &luma) {
+  LaplacianSums sums;
+  for (int y = 1; y + 1 < luma.rows; ++y) {
+    const uchar *up = luma.ptr<uchar>(y - 1);
+    const uchar *row = luma.ptr<uchar>(y);
+    const uchar *down = luma.ptr<uchar>(y + 1);
+    int x = 1;
+#ifdef FRAMESTATISTICS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    // Acumuladores de 32 bits por carril. Cada vuelta suma como mucho 4 * 1020^2 por carril a los
+    // cuadrados (sin signo), así que se vuelcan a 64 bits cada 256 vueltas
+    __m128i rowSum = zero;
+    __m128i rowSquares = zero;
+    int pending = 0;
+    auto flush = [&] {
+      alignas(16) qint32 lanes[4];
+      alignas(16) quint32 squareLanes[4];
+      _mm_store_si128(reinterpret_cast<__m128i *>(lanes), rowSum);
+      _mm_store_si128(reinterpret_cast<__m128i *>(squareLanes), rowSquares);
+      for (int lane = 0; lane < 4; ++lane) {
+        sums.sum += lanes[lane];
+        sums.squares += squareLanes[lane];
+      }
+      rowSum = zero;
+      rowSquares = zero;
+      pending = 0;
+    };
+    for (; x + 16 < luma.cols; x += 16) {
+      const __m128i center = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+      const __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x - 1));
+      const __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x + 1));
+      const __m128i above = _mm_loadu_si128(reinterpret_cast<const __m128i *>(up + x));
+      const __m128i below = _mm_loadu_si128(reinterpret_cast<const __m128i *>(down + x));
+      // Mitad baja y alta de los 16 píxeles en 16 bits
+      for (int half = 0; half < 2; ++half) {
+        auto widen = [&](__m128i v) {
+          return half == 0 ? _mm_unpacklo_epi8(v, zero) : _mm_unpackhi_epi8(v, zero);
+        };
+        const __m128i neighbours = _mm_add_epi16(
+            _mm_add_epi16(widen(left), widen(right)), _mm_add_epi16(widen(above), widen(below)));
+        const __m128i laplacian = _mm_sub_epi16(_mm_slli_epi16(widen(center), 2), neighbours);
+        rowSum = _mm_add_epi32(rowSum, _mm_madd_epi16(laplacian, ones));
+        rowSquares = _mm_add_epi32(rowSquares, _mm_madd_epi16(laplacian, laplacian));
+      }
+      if (++pending == 256) {
+        flush();
+      }
+    }
+    flush();
+#endif
+    for (; x + 1 < luma.cols; ++x) {
+      const int laplacian = laplacianAt(up, row, down, x);
+      sums.sum += laplacian;
+      sums.squares += quint64(laplacian * laplacian);
+    }
+    sums.count += luma.cols - 2;
+  }
+  return sums;
+}
+
+} // namespace
+
+int ImageStatistics::percentile(double percent) const {
+  const quint64 rank = qMax<quint64>(1, quint64(std::ceil(percent / 100.0 * samples)));
+  quint64 seen = 0;
+  for (int value = 0; value < 256; ++value) {
+    seen += histogram[value];
+    if (seen >= rank) {
+      return value;
+    }
+  }
+  return 255;
+}
+
+bool FrameStatistics::compute(const cv::Mat &image, ImageStatistics &stats) {
+  const int channels = image.channels();
+  if (image.empty() || image.depth() != CV_8U ||
+      (channels != 1 && channels != 2 && channels != 3 && channels != 4)) {
+    return false;
+  }
+  const qint64 start = monotonicNowNs();
+
+  const cv::Rect frame(0, 0, image.cols, image.rows);
+  cv::Rect area = frame;
+  if (!m_roi.isEmpty()) {
+    area = cv::Rect(
+               qRound(m_roi.x() * image.cols), qRound(m_roi.y() * image.rows),
+               qRound(m_roi.width() * image.cols), qRound(m_roi.height() * image.rows)) &
+           frame;
+  }
+  if (area.width < 3 || area.height < 3) {
+    return false;
+  }
+
+  // Rejilla: un píxel de cada 'step' en cada dirección, sin promediar (el promedio suavizaría
+  // justo los bordes finos que mide la nitidez)
+  const cv::Mat region = image(area);
+  const int step = qMax(1, qCeil(std::sqrt(double(area.area()) / kMaxSamples)));
+  const cv::Mat *grid = &region;
+  if (step > 1) {
+    cv::resize(
+        region, m_grid, cv::Size(qMax(3, area.width / step), qMax(3, area.height / step)), 0, 0,
+        cv::INTER_NEAREST);
+    grid = &m_grid;
+  }
+  const cv::Mat *luma = grid;
+  if (channels == 2) {
+    cv::extractChannel(*grid, m_luma, 0); // YUYV: la Y ya está, sin conversión de color
+    luma = &m_luma;
+  } else if (channels != 1) {
+    cv::cvtColor(*grid, m_luma, channels == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    luma = &m_luma;
+  }
+
+  accumulateHistogram(*luma, stats);
+  stats.p5 = stats.percentile(5);
+  stats.p50 = stats.percentile(50);
+  stats.p95 = stats.percentile(95);
+  quint64 clipped = 0;
+  for (int value = 250; value < 256; ++value) {
+    clipped += stats.histogram[value];
+  }
+  stats.clippedHigh = double(clipped) / stats.samples;
+
+  const LaplacianSums laplacian = laplacianSums(*luma);
+  const double mean = double(laplacian.sum) / laplacian.count;
+  stats.sharpness = double(laplacian.squares) / laplacian.count - mean * mean;
+
+  stats.computeNs = monotonicNowNs() - start;
+  return true;
+}
@@ -0,0 +1,51 @@
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+
+#include <QRectF>
+#include <QtGlobal>
+#include <array>
+#include <opencv2/core.hpp>
+
+// Resultado de FrameStatistics::compute() para un frame
+struct ImageStatistics {
+  std::array<quint32, 256> histogram{}; // Luma de las muestras de la rejilla
+  int samples = 0;
+  double mean = 0;
+  int p5 = 0;
+  int p50 = 0;
+  int p95 = 0;
+  double clippedHigh = 0; // Fracción de muestras casi blancas (>= 250)
+  double sharpness = 0;   // Varianza del laplaciano: sube al enfocar
+  quint64 sequence = 0;
+  qint64 computeNs = 0;
+
+  int percentile(double percent) const;
+};
+
+// Estadísticas de imagen por frame para la exposición y el enfoque por software.
+//
+// Se calculan sobre una rejilla submuestreada de la región de interés, de como mucho kMaxSamples
+// muestras (unos 600x340 a 1080p): histograma de luma, media, percentiles y nitidez como varianza
+// del laplaciano de 4 vecinos. El laplaciano usa SSE2 (siempre presente en x86-64) con una
+// variante escalar para el resto; a 1080p todo queda muy por debajo de 1 ms.
+//
+// Reutiliza sus buffers entre frames: cada objeto solo se usa desde un hilo a la vez.
+class FrameStatistics {
+public:
+  static constexpr int kMaxSamples = 1 << 18;
+
+  // Región relativa al frame (0..1); vacía = el frame completo
+  void setRoi(const QRectF &roi) { m_roi = roi; }
+  QRectF roi() const { return m_roi; }
+
+  // GRAY, BGR o BGRA de 8 bits, o YUYV (CV_8UC2, la luma en el canal 0, ver Yuv::luma()); false
+  // con otros formatos o regiones de menos de 3x3
+  bool compute(const cv::Mat &image, ImageStatistics &stats);
+
+private:
+  QRectF m_roi;
+  cv::Mat m_grid;
+  cv::Mat m_luma;
+};
+
+#endif // FRAMESTATISTICS_H
@@ -0,0 +1,213 @@
+#include "frametiming.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtAlgorithms>
+
+using namespace FrameTiming;
+
+const char *FrameTiming::intervalName(Interval interval) {
+  switch (interval) {
+  case Grab:
+    return "grab";
+  case Retrieve:
+    return "retrieve";
+  case Process:
+    return "cola+procesado";
+  case Convert:
+    return "conversión";
+  case Deliver:
+    return "entrega";
+  case Wait:
+    return "espera refresco";
+  case Paint:
+    return "pintado";
+  case Total:
+    return "total";
+  case IntervalCount:
+    break;
+  }
+  return "?";
+}
+
+qint64 FrameTimestamps::interval(Interval interval) const {
+  const Mark from = interval == Total ? Grabbed : Mark(interval);
+  const Mark to = interval == Total ? Painted : Mark(from + 1);
+  if (ns[from] == 0 || ns[to] == 0) {
+    return -1;
+  }
+  return ns[to] - ns[from];
+}
+
+// --- FrameTimingStats ---
+
+namespace {
+
+// Cada hilo se queda con un bloque de contadores la primera vez que registra algo
+int shardIndex(int shards) {
+  static std::atomic<int> nextShard{0};
+  thread_local const int index = nextShard.fetch_add(1, std::memory_order_relaxed);
+  return index % shards;
+}
+
+} // namespace
+
+FrameTimingStats::FrameTimingStats() : m_shards(new Shard[kShards]) {
+  for (int shard = 0; shard < kShards; ++shard) {
+    for (auto &interval : m_shards[shard].counts) {
+      for (std::atomic<quint64> &count : interval) {
+        count.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+int FrameTimingStats::bucketFor(qint64 durationNs) {
+  const quint64 us = durationNs > 0 ? static_cast<quint64>(durationNs) / 1000 : 0;
+  if (us < 4) {
+    return static_cast<int>(us);
+  }
+  const int octave = 63 - qCountLeadingZeroBits(us);
+  const int bucket = (octave - 1) * 4 + static_cast<int>((us >> (octave - 2)) & 3);
+  return qMin(bucket, kBuckets - 1);
+}
+
+double FrameTimingStats::bucketUpperMs(int bucket) {
+  // Límite inferior del bucket siguiente
+  const int next = bucket + 1;
+  const quint64 us = next < 4 ? next : quint64(4 + next % 4) << (next / 4 - 1);
+  return us / 1000.0;
+}
+
+void FrameTimingStats::record(Interval interval, qint64 durationNs) {
+  if (durationNs < 0) {
+    return;
+  }
+  m_shards[shardIndex(kShards)].counts[interval][bucketFor(durationNs)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void FrameTimingStats::record(const FrameTimestamps &timestamps, Interval first, Interval last) {
+  for (int interval = first; interval <= last; ++interval) {
+    record(Interval(interval), timestamps.interval(Interval(interval)));
+  }
+}
+
+FrameTimingStats::Snapshot FrameTimingStats::snapshot() const {
+  Snapshot snapshot;
+  for (int shard = 0; shard < kShards; ++shard) {
+    for (int interval = 0; interval < IntervalCount; ++interval) {
+      for (int bucket = 0; bucket < kBuckets; ++bucket) {
+        snapshot.counts[interval][bucket] +=
+            m_shards[shard].counts[interval][bucket].load(std::memory_order_relaxed);
+      }
+    }
+  }
+  return snapshot;
+}
+
+quint64 FrameTimingStats::Snapshot::count(Interval interval) const {
+  quint64 total = 0;
+  for (quint64 count : counts[interval]) {
+    total += count;
+  }
+  return total;
+}
+
+double FrameTimingStats::Snapshot::percentileMs(Interval interval, double percent) const {
+  const quint64 total = count(interval);
+  if (total == 0) {
+    return 0;
+  }
+  const quint64 rank = qMax<quint64>(1, static_cast<quint64>(percent / 100.0 * total + 0.5));
+  quint64 seen = 0;
+  for (int bucket = 0; bucket < kBuckets; ++bucket) {
+    seen += counts[interval][bucket];
+    if (seen >= rank) {
+      return bucketUpperMs(bucket);
+    }
+  }
+  return bucketUpperMs(kBuckets - 1);
+}
+
+FrameTimingStats::Snapshot FrameTimingStats::Snapshot::operator-(const Snapshot &older) const {
+  Snapshot delta;
+  for (int interval = 0; interval < IntervalCount; ++interval) {
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+      delta.counts[interval][bucket] = counts[interval][bucket] - older.counts[interval][bucket];
+    }
+  }
+  return delta;
+}
+
+// --- FrameTraceRecorder ---
+
+FrameTraceRecorder::FrameTraceRecorder(int capacity) : m_capacity(qMax(1, capacity)) {}
+
+void FrameTraceRecorder::setEnabled(bool enabled) {
+  if (enabled && m_entries.empty()) {
+    m_entries.resize(m_capacity);
+  }
+  m_enabled = enabled;
+}
+
+void FrameTraceRecorder::add(quint64 sequence, const FrameTimestamps &timestamps) {
+  if (!m_enabled) {
+    return;
+  }
+  Entry &entry = m_entries[m_next];
+  entry.sequence = sequence;
+  entry.timestamps = timestamps;
+  m_next = (m_next + 1) % static_cast<int>(m_entries.size());
+  m_count = qMin(m_count + 1, static_cast<int>(m_entries.size()));
+}
+
+void FrameTraceRecorder::clear() {
+  m_next = 0;
+  m_count = 0;
+}
+
+bool FrameTraceRecorder::save(const QString &path) const {
+  // Formato "Trace Event" de Chrome: un evento completo ("X") por etapa y frame, con una pista
+  // por etapa para que los frames consecutivos no se solapen en la misma fila
+  QJsonArray events;
+  for (int interval = 0; interval < Total; ++interval) {
+    events.append(QJsonObject{
+        {"name", "thread_name"},
+        {"ph", "M"},
+        {"pid", 1},
+        {"tid", interval + 1},
+        {"args", QJsonObject{{"name", QString::fromUtf8(intervalName(Interval(interval)))}}}});
+  }
+
+  const int capacity = qMax(1, static_cast<int>(m_entries.size()));
+  const int first = (m_next - m_count + capacity) % capacity;
+  for (int i = 0; i < m_count; ++i) {
+    const Entry &entry = m_entries[(first + i) % capacity];
+    for (int interval = 0; interval < Total; ++interval) {
+      const qint64 duration = entry.timestamps.interval(Interval(interval));
+      if (duration < 0) {
+        continue;
+      }
+      events.append(QJsonObject{
+          {"name", QString::fromUtf8(intervalName(Interval(interval)))},
+          {"cat", "frame"},
+          {"ph", "X"},
+          {"ts", entry.timestamps.ns[interval] / 1000.0},
+          {"dur", duration / 1000.0},
+          {"pid", 1},
+          {"tid", interval + 1},
+          {"args", QJsonObject{{"frame", static_cast<qint64>(entry.sequence)}}}});
+    }
+  }
+
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "FrameTraceRecorder::save() - No se pudo escribir" << path;
+    return false;
+  }
+  const QJsonObject trace{{"traceEvents", events}, {"displayTimeUnit", "ms"}};
+  return file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) > 0;
+}
@@ -0,0 +1,120 @@
+#ifndef FRAMETIMING_H
+#define FRAMETIMING_H
+
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Reloj monotónico común para todas las marcas de tiempo del pipeline
+inline qint64 monotonicNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Instrumentación por frame: cada frame lleva una marca de tiempo monotónica por etapa, desde que
+// se llama a grab() hasta que termina de pintarse.
+namespace FrameTiming {
+
+// Marcas, en el orden en que se producen
+enum Mark {
+  GrabStart,  // Hilo de captura: antes de grab()
+  Grabbed,    // grab() ha devuelto el frame (= captureTimeNs)
+  Retrieved,  // retrieve() ha decodificado los píxeles
+  Processed,  // Sale del anillo y de las etapas de procesado; empieza la conversión
+  Converted,  // Convertido a QImage en el buffer del pool
+  Received,   // El presentador lo recibe (callback o señal)
+  PaintStart, // Tick de refresco que lo pinta
+  Painted,    // QLabel actualizado
+  MarkCount
+};
+
+// Intervalos entre marcas consecutivas, más la latencia total (Grabbed -> Painted)
+enum Interval { Grab, Retrieve, Process, Convert, Deliver, Wait, Paint, Total, IntervalCount };
+
+const char *intervalName(Interval interval);
+
+} // namespace FrameTiming
+
+struct FrameTimestamps {
+  std::array<qint64, FrameTiming::MarkCount> ns{}; // 0 = etapa no alcanzada
+
+  void mark(FrameTiming::Mark mark) { ns[mark] = monotonicNowNs(); }
+  void reset() { ns.fill(0); }
+
+  // Duración en ns, o -1 si falta alguna de las dos marcas
+  qint64 interval(FrameTiming::Interval interval) const;
+};
+
+// Histogramas de duración por intervalo, acumulados desde el arranque.
+//
+// record() no usa mutex: cada hilo escribe en su propio bloque de contadores atómicos (relaxed) y
+// snapshot() los suma. Para una ventana móvil se restan dos snapshots tomados en instantes
+// distintos. Los buckets son logarítmicos, cuatro por potencia de dos de microsegundos (error
+// máximo ~19%), hasta ~2 s.
+class FrameTimingStats {
+public:
+  static constexpr int kBuckets = 80;
+
+  struct Snapshot {
+    std::array<std::array<quint64, kBuckets>, FrameTiming::IntervalCount> counts{};
+
+    quint64 count(FrameTiming::Interval interval) const;
+    double percentileMs(FrameTiming::Interval interval, double percent) const;
+    Snapshot operator-(const Snapshot &older) const;
+  };
+
+  FrameTimingStats();
+
+  void record(FrameTiming::Interval interval, qint64 durationNs);
+  // Registra todos los intervalos disponibles entre 'first' y 'last' (ambos incluidos)
+  void record(
+      const FrameTimestamps &timestamps, FrameTiming::Interval first, FrameTiming::Interval last);
+
+  Snapshot snapshot() const;
+
+  static int bucketFor(qint64 durationNs);
+  static double bucketUpperMs(int bucket);
+
+private:
+  static constexpr int kShards = 16;
+
+  struct alignas(64) Shard {
+    std::atomic<quint64> counts[FrameTiming::IntervalCount][kBuckets];
+  };
+  std::unique_ptr<Shard[]> m_shards;
+};
+
+// Últimos frames pintados con todas sus marcas, para exportarlos como traza de Chrome/Perfetto
+// (chrome://tracing o ui.perfetto.dev). Solo se usa desde un hilo (el de la GUI).
+class FrameTraceRecorder {
+public:
+  explicit FrameTraceRecorder(int capacity = 4096);
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const { return m_enabled; }
+
+  void add(quint64 sequence, const FrameTimestamps &timestamps);
+  void clear();
+  int size() const { return m_count; }
+
+  bool save(const QString &path) const;
+
+private:
+  struct Entry {
+    quint64 sequence = 0;
+    FrameTimestamps timestamps;
+  };
+
+  const int m_capacity;
+  std::vector<Entry> m_entries; // Se reserva al activarla por primera vez
+  int m_next{0};
+  int m_count{0};
+  bool m_enabled{false};
+};
+
+#endif // FRAMETIMING_H
@@ -0,0 +1,386 @@
+// Microbenchmark de los kernels por frame: conversión a RGB32 (PixelConvert) y reducción para la
+// vista previa, aislados de la captura (para la cadena completa, ver capturebenchmark.cpp).
+//
+// Cada caso se mide en varias tandas de al menos --batch-ms; se da la mediana en ns por píxel y
+// GB/s (bytes leídos + escritos) y la dispersión entre tandas (desviación absoluta mediana
+// relativa), que dice cuánto fiarse de la cifra. Las variantes paralelas se repiten con varios
+// números de hilos. Con --baseline se compara con un JSON anterior y se sale con código 2 si algún
+// caso es más lento que la tolerancia más su dispersión, para usarlo como control de regresiones:
+//
+//   OpenCVTestKernelBenchmark --output base.json
+//   OpenCVTestKernelBenchmark --baseline base.json --tolerance 10
+
+#include "pixelconvert.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+namespace {
+
+struct Measurement {
+  double nsPerPixel = 0;
+  double gbPerSecond = 0;
+  double spread = 0; // Desviación absoluta mediana / mediana, entre tandas
+  qint64 iterations = 0;
+};
+
+struct Settings {
+  int batchMs = 20;
+  int batches = 15;
+};
+
+double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const size_t middle = values.size() / 2;
+  return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+// Mide 'run' en tandas: la primera sirve para calentar cachés y elegir cuántas iteraciones caben
+// en batchMs; la mediana de las demás descarta las tandas interrumpidas por el sistema
+Measurement measure(
+    const Settings &settings, qint64 pixels, qint64 bytes, const std::function<void()> &run) {
+  QElapsedTimer timer;
+  qint64 iterations = 0;
+  timer.start();
+  do {
+    run();
+    ++iterations;
+  } while (timer.elapsed() < settings.batchMs);
+
+  std::vector<double> perIteration;
+  for (int batch = 0; batch < settings.batches; ++batch) {
+    timer.restart();
+    for (qint64 i = 0; i < iterations; ++i) {
+      run();
+    }
+    perIteration.push_back(double(timer.nsecsElapsed()) / iterations);
+  }
+  const double ns = median(perIteration);
+  std::vector<double> deviations;
+  for (double value : perIteration) {
+    deviations.push_back(std::abs(value - ns));
+  }
+
+  Measurement result;
+  result.nsPerPixel = ns / pixels;
+  result.gbPerSecond = bytes / ns; // bytes/ns = GB/s
+  result.spread = median(deviations) / ns;
+  result.iterations = iterations * settings.batches;
+  return result;
+}
+
+// Frame de prueba con textura y bordes, para que ningún kernel se beneficie de datos uniformes
+cv::Mat testImage(const cv::Size &size, int type) {
+  cv::Mat image(size, type);
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+  return image;
+}
+
+// YUYV (CV_8UC2) o NV12 (CV_8UC1 de alto * 3 / 2) de tamaño 'size'
+cv::Mat testYuv(const cv::Size &size, bool nv12) {
+  return nv12 ? testImage(cv::Size(size.width, size.height * 3 / 2), CV_8UC1)
+              : testImage(size, CV_8UC2);
+}
+
+QJsonObject toJson(const QString &name, const cv::Size &size, const Measurement &measurement) {
+  return QJsonObject{
+      {"name", name},
+      {"width", size.width},
+      {"height", size.height},
+      {"nsPerPixel", measurement.nsPerPixel},
+      {"gbPerSecond", measurement.gbPerSecond},
+      {"spread", measurement.spread},
+      {"iterations", measurement.iterations}};
+}
+
+QString sizeText(const cv::Size &size) {
+  return QStringLiteral("%1x%2").arg(size.width).arg(size.height);
+}
+
+class Runner {
+public:
+  Runner(const Settings &settings, QJsonArray &cases) : m_settings(settings), m_cases(cases) {}
+
+  void add(
+      const QString &name, const cv::Size &size, qint64 bytes, const std::function<void()> &run) {
+    const qint64 pixels = qint64(size.width) * size.height;
+    const Measurement measurement = measure(m_settings, pixels, bytes, run);
+    std::fprintf(
+        stderr, "%-48s %8.3f ns/px %7.2f GB/s  ±%.1f%%\n", qPrintable(name),
+        measurement.nsPerPixel, measurement.gbPerSecond, measurement.spread * 100);
+    m_cases.append(toJson(name, size, measurement));
+  }
+
+private:
+  const Settings &m_settings;
+  QJsonArray &m_cases;
+};
+
+void benchmarkConversions(
+    Runner &runner, const QList<cv::Size> &sizes, const QList<int> &threadCounts) {
+  using PixelConvert::Isa;
+  const Isa best = PixelConvert::bestIsa();
+  QList<Isa> isas{Isa::Scalar};
+  if (best >= Isa::Ssse3) {
+    isas << Isa::Ssse3;
+  }
+  if (best >= Isa::Avx2) {
+    isas << Isa::Avx2;
+  }
+
+  for (const cv::Size &size : sizes) {
+    const qint64 pixels = qint64(size.width) * size.height;
+    cv::Mat dst(size, CV_8UC4);
+    struct Input {
+      QString name;
+      cv::Mat image;
+      qint64 bytes; // Leídos + escritos por frame
+      std::function<bool(const cv::Mat &, cv::Mat &, Isa, bool)> convert;
+    };
+    const auto packed = [](const cv::Mat &src, cv::Mat &out, Isa isa, bool parallel) {
+      return PixelConvert::convertToRgb32(src, out, isa, parallel);
+    };
+    const QList<Input> inputs{
+        {"gray", testImage(size, CV_8UC1), pixels * 5, packed},
+        {"bgr", testImage(size, CV_8UC3), pixels * 7, packed},
+        {"bgra", testImage(size, CV_8UC4), pixels * 8, packed},
+        {"yuyv", testYuv(size, false), pixels * 6,
+         [](const cv::Mat &src, cv::Mat &out, Isa isa, bool parallel) {
+           return PixelConvert::yuyvToRgb32(src, out, isa, parallel);
+         }},
+        {"nv12", testYuv(size, true), pixels * 4 + pixels / 2,
+         [](const cv::Mat &src, cv::Mat &out, Isa isa, bool parallel) {
+           return PixelConvert::nv12ToRgb32(src, out, isa, parallel);
+         }},
+    };
+
+    for (const Input &input : inputs) {
+      const QString prefix = QStringLiteral("convert/%1/%2").arg(input.name, sizeText(size));
+      for (Isa isa : std::as_const(isas)) {
+        runner.add(
+            prefix + '/' + PixelConvert::isaName(isa), size, input.bytes,
+            [&] { input.convert(input.image, dst, isa, false); });
+      }
+      for (int threads : threadCounts) {
+        cv::setNumThreads(threads);
+        runner.add(
+            QStringLiteral("%1/%2/t%3").arg(prefix, PixelConvert::isaName(best)).arg(threads),
+            size, input.bytes, [&] { input.convert(input.image, dst, best, true); });
+      }
+      cv::setNumThreads(-1);
+    }
+
+    // Referencia: la conversión genérica de OpenCV que sustituye PixelConvert
+    const cv::Mat bgr = testImage(size, CV_8UC3);
+    runner.add(
+        QStringLiteral("convert/bgr/%1/cvtColor").arg(sizeText(size)), size, pixels * 7,
+        [&] { cv::cvtColor(bgr, dst, cv::COLOR_BGR2BGRA); });
+  }
+}
+
+void benchmarkScaling(
+    Runner &runner, const QList<cv::Size> &sizes, const QList<int> &threadCounts) {
+  // Reducción a la mitad, el caso típico de la vista previa en una ventana normal
+  const QList<QPair<QString, int>> methods{
+      {"nearest", cv::INTER_NEAREST}, {"linear", cv::INTER_LINEAR}, {"area", cv::INTER_AREA}};
+  for (const cv::Size &size : sizes) {
+    const cv::Size target(size.width / 2, size.height / 2);
+    const qint64 pixels = qint64(size.width) * size.height;
+    const qint64 targetPixels = qint64(target.width) * target.height;
+
+    for (const char *format : {"bgr", "rgb32"}) {
+      const int channels = qstrcmp(format, "bgr") == 0 ? 3 : 4;
+      const cv::Mat src = testImage(size, CV_MAKETYPE(CV_8U, channels));
+      cv::Mat dst(target, src.type());
+      const qint64 bytes = (pixels + targetPixels) * channels;
+      for (const auto &method : methods) {
+        const QString name =
+            QStringLiteral("scale/%1/%2/%3").arg(format, sizeText(size), method.first);
+        // cv::resize reparte las filas entre los hilos de OpenCV por su cuenta
+        for (int threads : threadCounts) {
+          cv::setNumThreads(threads);
+          runner.add(QStringLiteral("%1/t%2").arg(name).arg(threads), size, bytes, [&] {
+            cv::resize(src, dst, target, 0, 0, method.second);
+          });
+        }
+        cv::setNumThreads(-1);
+      }
+    }
+
+    // Referencia: el escalado de Qt que se usaba al pintar (QPixmap::scaled con
+    // SmoothTransformation sobre la imagen ya convertida)
+    const cv::Mat rgb32 = testImage(size, CV_8UC4);
+    const QImage image(rgb32.data, size.width, size.height, int(rgb32.step), QImage::Format_RGB32);
+    const qint64 bytes = (pixels + targetPixels) * 4;
+    const QSize qtTarget(target.width, target.height);
+    QImage scaled;
+    runner.add(QStringLiteral("scale/rgb32/%1/qt-smooth").arg(sizeText(size)), size, bytes, [&] {
+      scaled = image.scaled(qtTarget, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    });
+    runner.add(QStringLiteral("scale/rgb32/%1/qt-fast").arg(sizeText(size)), size, bytes, [&] {
+      scaled = image.scaled(qtTarget, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    });
+  }
+}
+
+QList<cv::Size> parseSizes(const QString &text) {
+  QList<cv::Size> sizes;
+  for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+    const QStringList dims = item.trimmed().split('x');
+    // Par en las dos dimensiones: YUYV y NV12 lo exigen
+    if (dims.size() == 2 && dims[0].toInt() > 1 && dims[1].toInt() > 1) {
+      sizes << cv::Size(dims[0].toInt() & ~1, dims[1].toInt() & ~1);
+    } else {
+      qWarning() << "Resolución no válida:" << item;
+    }
+  }
+  return sizes;
+}
+
+QList<int> parseThreads(const QString &text) {
+  QList<int> threads;
+  if (text == "auto") {
+    // 1, 2, 4... hasta los hilos de la máquina, que siempre se incluyen
+    const int ideal = QThread::idealThreadCount();
+    for (int count = 1; count < ideal; count *= 2) {
+      threads << count;
+    }
+    threads << ideal;
+    return threads;
+  }
+  for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+    if (item.trimmed().toInt() > 0) {
+      threads << item.trimmed().toInt();
+    }
+  }
+  return threads;
+}
+
+// Casos más lentos que en 'baseline' por encima de la tolerancia más la dispersión de ambos
+int compareWithBaseline(const QJsonArray &cases, const QJsonArray &baseline, double tolerance) {
+  QHash<QString, QJsonObject> previous;
+  for (const QJsonValue &value : baseline) {
+    previous.insert(value["name"].toString(), value.toObject());
+  }
+  int regressions = 0;
+  for (const QJsonValue &value : cases) {
+    const QString name = value["name"].toString();
+    if (!previous.contains(name)) {
+      continue;
+    }
+    const QJsonObject &old = previous[name];
+    const double ratio = value["nsPerPixel"].toDouble() / old["nsPerPixel"].toDouble();
+    const double allowed =
+        1 + tolerance / 100 + value["spread"].toDouble() + old["spread"].toDouble();
+    if (ratio > allowed) {
+      ++regressions;
+      std::fprintf(
+          stderr, "REGRESIÓN %-48s %+.1f%% (permitido %+.1f%%)\n", qPrintable(name),
+          (ratio - 1) * 100, (allowed - 1) * 100);
+    }
+  }
+  return regressions;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("OpenCVTestKernelBenchmark");
+  QCoreApplication::setApplicationVersion(QStringLiteral(PROJECT_VERSION));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Microbenchmark de conversión y escalado de frames.");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  const QCommandLineOption resolutionsOption(
+      "resolutions", "Lista de resoluciones WxH separadas por comas.", "lista",
+      "432x240,640x360,1280x720,1920x1080,3840x2160");
+  const QCommandLineOption threadsOption(
+      "threads", "Hilos de las variantes paralelas: lista o 'auto' (1, 2, 4... y todos).", "lista",
+      "auto");
+  const QCommandLineOption suiteOption(
+      "suite", "Qué medir: convert, scale o all.", "suite", "all");
+  const QCommandLineOption batchOption(
+      "batch-ms", "Duración mínima de cada tanda, en milisegundos.", "ms", "20");
+  const QCommandLineOption batchesOption("batches", "Tandas medidas por caso.", "n", "15");
+  const QCommandLineOption outputOption(
+      {"o", "output"}, "Fichero JSON de salida (por defecto, la salida estándar).", "fichero");
+  const QCommandLineOption baselineOption(
+      "baseline", "JSON de una ejecución anterior con el que comparar.", "fichero");
+  const QCommandLineOption toleranceOption(
+      "tolerance", "Porcentaje de empeoramiento admitido frente a --baseline.", "porcentaje", "10");
+  parser.addOptions(
+      {resolutionsOption, threadsOption, suiteOption, batchOption, batchesOption, outputOption,
+       baselineOption, toleranceOption});
+  parser.process(app);
+
+  Settings settings;
+  settings.batchMs = qMax(1, parser.value(batchOption).toInt());
+  settings.batches = qMax(3, parser.value(batchesOption).toInt());
+  const QList<cv::Size> sizes = parseSizes(parser.value(resolutionsOption));
+  const QList<int> threadCounts = parseThreads(parser.value(threadsOption));
+  const QString suite = parser.value(suiteOption);
+
+  QJsonArray cases;
+  Runner runner(settings, cases);
+  if (suite == "convert" || suite == "all") {
+    benchmarkConversions(runner, sizes, threadCounts);
+  }
+  if (suite == "scale" || suite == "all") {
+    benchmarkScaling(runner, sizes, threadCounts);
+  }
+
+  QJsonObject report;
+  report["benchmark"] = QStringLiteral("kernels");
+  report["version"] = QCoreApplication::applicationVersion();
+  report["isa"] = QString::fromLatin1(PixelConvert::isaName(PixelConvert::bestIsa()));
+  report["idealThreads"] = QThread::idealThreadCount();
+  report["batchMs"] = settings.batchMs;
+  report["batches"] = settings.batches;
+  report["cases"] = cases;
+  const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+  if (parser.isSet(outputOption)) {
+    QFile file(parser.value(outputOption));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      qWarning() << "No se pudo escribir" << file.fileName();
+      return 1;
+    }
+    file.write(json);
+  } else {
+    std::fwrite(json.constData(), 1, json.size(), stdout);
+  }
+
+  if (parser.isSet(baselineOption)) {
+    QFile file(parser.value(baselineOption));
+    if (!file.open(QIODevice::ReadOnly)) {
+      qWarning() << "No se pudo leer" << file.fileName();
+      return 1;
+    }
+    const QJsonArray baseline = QJsonDocument::fromJson(file.readAll())["cases"].toArray();
+    const int regressions =
+        compareWithBaseline(cases, baseline, parser.value(toleranceOption).toDouble());
+    if (regressions > 0) {
+      std::fprintf(
+          stderr, "%d casos más lentos que %s\n", regressions, qPrintable(file.fileName()));
+      return 2;
+    }
+  }
+  return 0;
+}
@@ -1,8 +1,181 @@
 #include "mainwindow.h"
+#include "batchprocessor.h"
+#include "framesource.h"
+#include "framestages.h"
+#include "mjpegserver.h"
+#include "videocapturehandler.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <cstdio>
+#include <cstring>
+#include <opencv2/core.hpp>
+
+namespace {
+
+// Sin ventana: captura un origen y lo sirve por HTTP (MjpegServer) hasta que se cierra el proceso
+//
+//   OpenCVTest --serve --source mjpeg:0 --resolution 1920x1080 --fps 15 --port 8080
+int runServer(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Servidor MJPEG por HTTP, sin interfaz");
+  parser.addHelpOption();
+  const QCommandLineOption serveOption("serve", "Servir el vídeo por HTTP sin abrir la ventana.");
+  const QCommandLineOption sourceOption(
+      "source", "Origen: camera:N, mjpeg:N, yuyv:N, synthetic o file:RUTA.", "origen",
+      FrameSource::cameraSpec(0));
+  const QCommandLineOption resolutionOption(
+      "resolution", "Resolución pedida al origen (AnchoxAlto).", "resolución", "1280x720");
+  const QCommandLineOption addressOption(
+      "address", "Dirección en la que escuchar.", "dirección", "127.0.0.1");
+  const QCommandLineOption portOption("port", "Puerto HTTP.", "puerto", "8080");
+  const QCommandLineOption fpsOption(
+      "fps", "Ritmo pedido al origen (0 = el suyo); el exceso se descarta.", "fps", "0");
+  const QCommandLineOption decimateOption(
+      "decimate", "Servir uno de cada N frames del origen.", "N", "1");
+  parser.addOptions(
+      {serveOption, sourceOption, resolutionOption, addressOption, portOption, fpsOption,
+       decimateOption});
+  parser.process(app);
+
+  const QStringList dims = parser.value(resolutionOption).split('x');
+  const QSize resolution =
+      dims.size() == 2 ? QSize(dims[0].toInt(), dims[1].toInt()) : QSize(0, 0);
+
+  MjpegServer server;
+  const QHostAddress address(parser.value(addressOption));
+  if (!server.listen(address, parser.value(portOption).toUShort())) {
+    return 1;
+  }
+  VideoCaptureHandler handler;
+  QObject::connect(
+      &handler, &VideoCaptureHandler::cameraOpenFailed, &app,
+      [](int cameraId, const QString &errorMsg) {
+        Q_UNUSED(cameraId);
+        qCritical().noquote() << errorMsg;
+        QCoreApplication::exit(1);
+      });
+  handler.startStreaming(server.sink());
+  handler.setTargetFrameRate(parser.value(fpsOption).toDouble());
+  handler.setCaptureDecimation(parser.value(decimateOption).toInt());
+  handler.start(QThread::HighestPriority);
+  handler.requestSourceChange(parser.value(sourceOption), resolution);
+  std::printf(
+      "Sirviendo %s en %s\n", qPrintable(parser.value(sourceOption)), qPrintable(server.url()));
+  std::fflush(stdout);
+
+  const int result = app.exec();
+  handler.stopStreaming();
+  handler.stop();
+  handler.wait();
+  return result;
+}
+
+// Sin ventana: procesa vídeos o secuencias de imágenes con un preset de etapas (BatchProcessor)
+// y escribe el resultado en otra carpeta, un fichero detrás de otro
+//
+//   OpenCVTest --batch --preset 1 --output salida grabaciones/ capturas/img_%04d.png
+int runBatch(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Procesado por lotes de vídeos y secuencias, sin interfaz");
+  parser.addHelpOption();
+  const QCommandLineOption batchOption("batch", "Procesar ficheros sin abrir la ventana.");
+  const QCommandLineOption presetOption(
+      "preset",
+      QString("Procesado (0-%1): %2.")
+          .arg(FrameStages::presetNames().size() - 1)
+          .arg(FrameStages::presetNames().join(", ")),
+      "n", "0");
+  const QCommandLineOption outputOption(
+      "output", "Carpeta de salida; sin ella solo se procesa y se mide.", "carpeta");
+  const QCommandLineOption threadsOption(
+      "threads", "Hilos de procesado (0 = uno por núcleo).", "n", "0");
+  const QCommandLineOption chunkOption(
+      "chunk-frames",
+      "Frames por trozo (0 = según --memory-mb). En H.264 conviene más que el GOP.", "n", "0");
+  const QCommandLineOption memoryOption(
+      "memory-mb", "Memoria para frames procesados pendientes de escribir.", "MB", "1024");
+  parser.addOptions(
+      {batchOption, presetOption, outputOption, threadsOption, chunkOption, memoryOption});
+  parser.addPositionalArgument(
+      "entradas", "Vídeos, carpetas con vídeos o patrones de secuencia (img_%04d.png).",
+      "entradas...");
+  parser.process(app);
+
+  QStringList inputs;
+  for (const QString &argument : parser.positionalArguments()) {
+    const QFileInfo info(argument);
+    if (info.isDir()) {
+      const QDir dir(argument);
+      for (const QString &name :
+           dir.entryList({"*.avi", "*.mp4", "*.mkv", "*.mov"}, QDir::Files, QDir::Name)) {
+        inputs << dir.filePath(name);
+      }
+    } else {
+      inputs << argument;
+    }
+  }
+  if (inputs.isEmpty()) {
+    parser.showHelp(1);
+  }
+  BatchProcessor::Config config;
+  config.preset = parser.value(presetOption).toInt();
+  config.outputDir = parser.value(outputOption);
+  config.threads = parser.value(threadsOption).toInt();
+  config.chunkFrames = parser.value(chunkOption).toInt();
+  config.memoryBudgetMb = parser.value(memoryOption).toInt();
+  if (!config.outputDir.isEmpty() && !QDir().mkpath(config.outputDir)) {
+    qCritical().noquote() << "No se pudo crear" << config.outputDir;
+    return 1;
+  }
+  // El paralelismo lo ponen los trozos: que OpenCV no reparta además cada frame entre núcleos
+  cv::setNumThreads(1);
+
+  BatchProcessor processor(config);
+  int failed = 0;
+  quint64 totalFrames = 0;
+  double totalSeconds = 0;
+  for (const QString &input : inputs) {
+    const BatchProcessor::Result result = processor.process(input);
+    if (!result.ok) {
+      std::printf("%s: %s\n", qPrintable(input), qPrintable(result.error));
+      ++failed;
+      continue;
+    }
+    std::printf(
+        "%s: %llu frames en %.2f s, %.1f fps (%d hilos, %d trozos de %d, %llu saltos)\n",
+        qPrintable(input), static_cast<unsigned long long>(result.frames), result.seconds,
+        result.fps, result.threads, result.chunks, result.chunkFrames,
+        static_cast<unsigned long long>(result.seeks));
+    std::fflush(stdout);
+    totalFrames += result.frames;
+    totalSeconds += result.seconds;
+  }
+  if (inputs.size() > 1) {
+    std::printf(
+        "Total: %llu frames en %.2f s, %.1f fps\n", static_cast<unsigned long long>(totalFrames),
+        totalSeconds, totalSeconds > 0 ? totalFrames / totalSeconds : 0.0);
+  }
+  return failed > 0 ? 1 : 0;
+}
+
+} // namespace
 
 int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--serve") == 0) {
+      return runServer(argc, argv);
+    }
+    if (std::strcmp(argv[i], "--batch") == 0) {
+      return runBatch(argc, argv);
+    }
+  }
   QApplication a(argc, argv);
   MainWindow w;
   w.show();
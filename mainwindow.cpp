@@ -1,22 +1,50 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "framesource.h"
+#include "framestages.h"
+#include "videofilesink.h"
 #include "videocapturehandler.h"
 #include <QCameraDevice>
+#include <QDateTime>
+#include <QDir>
+#include <QFileDialog>
 #include <QMediaDevices>
 #include <QMessageBox>
+#include <QStandardPaths>
+#include <QStatusBar>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow),
       m_videoCaptureHandler(new VideoCaptureHandler(this)) {
   ui->setupUi(this);
+  // Antes de rellenar las cámaras: cada cambio de cámara rehace la lista de resoluciones
+  for (int i = 0; i < ui->comboBoxResolution->count(); ++i) {
+    m_defaultResolutions << ui->comboBoxResolution->itemText(i);
+  }
 
-  // Conexión para recibir nuevos pixmaps capturados
-  connect(
-      m_videoCaptureHandler, &VideoCaptureHandler::newPixmapCaptured, this,
-      [=](const QPixmap &pixmap) {
-        m_currentPixmap = pixmap;
-        updateVideoLabel();
-      });
+  // Los frames llegan directamente desde el hilo de conversión al presentador, ya reducidos al
+  // tamaño de la etiqueta, y el presentador solo pinta el más reciente en cada refresco de pantalla
+  m_presenter = new FramePresenter(ui->videoLabel, this);
+  m_videoCaptureHandler->setPreviewCallback(
+      [presenter = m_presenter](const FrameHandle &frame) { presenter->submit(frame); });
+  m_presenter->setTimingStats(&m_videoCaptureHandler->timingStats());
+
+  m_statsOverlay = new QLabel(ui->videoLabel);
+  m_statsOverlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+  m_statsOverlay->setStyleSheet(
+      "background-color: rgba(0, 0, 0, 160); color: white; font-family: monospace; padding: 4px;");
+  m_statsOverlay->move(8, 8);
+  m_statsOverlay->hide();
+
+  // Mosaico para capturar todas las cámaras a la vez; sustituye a videoLabel mientras funciona
+  m_mosaicView = new MosaicView(this);
+  ui->verticalLayout->insertWidget(
+      ui->verticalLayout->indexOf(ui->videoLabel) + 1, m_mosaicView, 1);
+  m_mosaicView->hide();
+
+  connect(&m_statsTimer, &QTimer::timeout, this, &MainWindow::updateStats);
+  m_statsTimer.start(1000);
 
   // --- NUEVO: Conectar señales de rangos y errores ---
   connect(
@@ -30,51 +58,88 @@ MainWindow::MainWindow(QWidget *parent)
       &MainWindow::on_cameraOpenFailed);
   // --- FIN NUEVO ---
 
-  // Rellenar ComboBox de cámaras
-  QStringList cameraNames;
-  for (const QCameraDevice &camera : QMediaDevices::videoInputs()) {
-    cameraNames << camera.description();
+  // Rellenar ComboBox de orígenes: cámaras detectadas, patrón sintético y archivo de vídeo
+  const QList<QCameraDevice> cameras = QMediaDevices::videoInputs();
+  for (int i = 0; i < cameras.size(); ++i) {
+    ui->comboBoxCameras->addItem(cameras[i].description(), FrameSource::cameraSpec(i));
   }
-  ui->comboBoxCameras->addItems(cameraNames);
+  ui->comboBoxCameras->addItem("Patrón sintético", QStringLiteral("synthetic"));
+  ui->comboBoxCameras->addItem("Archivo de vídeo…", QStringLiteral("file:"));
 
-  if (cameraNames.isEmpty()) {
-    ui->startButton->setEnabled(false);
+  if (cameras.isEmpty()) {
     ui->videoLabel->setText("No se han detectado cámaras.");
   }
 
   setAllControlsEnabled(false);
 
+  // Etapas de procesado disponibles (sin disparar el slot mientras se rellena)
+  {
+    const QSignalBlocker blocker(ui->comboBoxProcesado);
+    ui->comboBoxProcesado->addItems(FrameStages::presetNames());
+  }
+
   m_videoCaptureHandler->start(QThread::HighestPriority);
 }
 
 MainWindow::~MainWindow() {
-  m_videoCaptureHandler->requestInterruption();
+  m_mosaicView->stop();
+  m_videoCaptureHandler->stopStreaming();
+  m_videoCaptureHandler->stop();
   m_videoCaptureHandler->wait();
+  m_presenter->clear(); // Devolver los frames al pool antes de destruir el manejador
   delete ui;
 }
 
 void MainWindow::on_startButton_clicked() {
   if (ui->startButton->isChecked()) {
     // Estado: ON (Iniciar)
-    int cameraId = ui->comboBoxCameras->currentIndex();
-
     QString resText = ui->comboBoxResolution->currentText();
     QSize resolution = parseResolution(resText);
 
-    m_videoCaptureHandler->requestCameraChange(cameraId, resolution);
+    if (ui->checkBoxMosaico->isChecked()) {
+      // Todas las cámaras a la vez; los ajustes de cámara solo aplican en modo individual
+      QList<int> cameraIds;
+      for (int i = 0; i < ui->comboBoxCameras->count(); ++i) {
+        if (ui->comboBoxCameras->itemData(i).toString().startsWith("camera:")) {
+          cameraIds << i;
+        }
+      }
+      ui->videoLabel->hide();
+      m_mosaicView->show();
+      m_mosaicView->start(cameraIds, resolution);
+      setAllControlsEnabled(false);
+    } else if (!requestSelectedSource()) {
+      ui->startButton->setChecked(false);
+      return;
+    }
 
     ui->startButton->setText("Stop");
-    ui->comboBoxCameras->setEnabled(false);
+    // Con el cambio sin corte se puede cambiar de cámara sin parar
+    ui->comboBoxCameras->setEnabled(
+        ui->checkBoxSinCorte->isChecked() && !m_mosaicView->isRunning());
     ui->comboBoxResolution->setEnabled(false);
+    ui->checkBoxMosaico->setEnabled(false);
+    ui->checkBoxMjpeg->setEnabled(false);
+    ui->checkBoxYuv->setEnabled(false);
   } else {
     // Estado: OFF (Detener)
-    m_videoCaptureHandler->requestCameraChange(-1, QSize());
+    if (m_mosaicView->isRunning()) {
+      m_mosaicView->stop();
+      m_mosaicView->hide();
+      ui->videoLabel->show();
+    } else {
+      m_videoCaptureHandler->requestCameraChange(-1, QSize());
+    }
 
     ui->startButton->setText("Start OpenCV");
     ui->comboBoxCameras->setEnabled(true);
     ui->comboBoxResolution->setEnabled(true);
+    ui->checkBoxMosaico->setEnabled(true);
+    ui->checkBoxMjpeg->setEnabled(true);
+    ui->checkBoxYuv->setEnabled(true);
+    updateResolutionList(); // La primera apertura de un dispositivo deja sus modos en la caché
 
-    m_currentPixmap = QPixmap();
+    m_presenter->clear();
     ui->videoLabel->clear();
     ui->videoLabel->setText("Cámara detenida.");
   }
@@ -107,6 +172,9 @@ void MainWindow::on_cameraOpenFailed(int cameraId, const QString &errorMsg) {
   ui->startButton->setText("Start OpenCV");
   ui->comboBoxCameras->setEnabled(true);
   ui->comboBoxResolution->setEnabled(true);
+  ui->checkBoxMosaico->setEnabled(true);
+  ui->checkBoxMjpeg->setEnabled(true);
+  ui->checkBoxYuv->setEnabled(true);
 }
 
 void MainWindow::on_rangesSupported(const CameraPropertyRanges &ranges) {
@@ -151,6 +219,136 @@ void MainWindow::on_rangesSupported(const CameraPropertyRanges &ranges) {
   ui->horizontalSliderExposicion->setEnabled(
       m_support.exposure && !ui->checkBoxExposicionAuto->isChecked());
 }
+void MainWindow::on_comboBoxProcesado_currentIndexChanged(int index) {
+  m_videoCaptureHandler->setProcessingStages(FrameStages::preset(index));
+}
+
+void MainWindow::on_comboBoxFps_currentIndexChanged(int index) {
+  // "30 fps" -> 30; "fps del origen" -> 0
+  const double fps = ui->comboBoxFps->itemText(index).section(' ', 0, 0).toDouble();
+  m_videoCaptureHandler->setTargetFrameRate(fps);
+}
+
+void MainWindow::on_pushButtonGrabar_toggled(bool checked) {
+  if (!checked) {
+    m_videoCaptureHandler->stopRecording(); // Espera a que se escriba lo que quede en cola
+    const FrameRecorder::Stats stats = m_videoCaptureHandler->recordingStats();
+    statusBar()->showMessage(
+        tr("Grabación terminada: %1 frames escritos, %2 descartados")
+            .arg(stats.written)
+            .arg(stats.dropped),
+        5000);
+    ui->checkBoxSinPerdidas->setEnabled(true);
+    return;
+  }
+  const QString path = QFileDialog::getSaveFileName(
+      this, tr("Grabar vídeo"), "grabacion.avi", tr("Vídeo (*.avi *.mp4 *.mkv)"));
+  if (path.isEmpty()) {
+    const QSignalBlocker blocker(ui->pushButtonGrabar);
+    ui->pushButtonGrabar->setChecked(false);
+    return;
+  }
+  const FrameRecorder::Policy policy = ui->checkBoxSinPerdidas->isChecked()
+                                           ? FrameRecorder::Policy::Block
+                                           : FrameRecorder::Policy::DropNewest;
+  m_videoCaptureHandler->startRecording(std::make_unique<VideoFileSink>(path), policy);
+  ui->checkBoxSinPerdidas->setEnabled(false);
+}
+
+// Segundos de pre-grabación y de grabación tras pulsar "Incidente"
+static constexpr double kPreTriggerSeconds = 10;
+static constexpr double kPostTriggerSeconds = 5;
+
+void MainWindow::on_checkBoxPreGrabacion_toggled(bool checked) {
+  if (checked) {
+    // MJPEG en un fichero proyectado de 512 MB: unos 10 s de 1080p caben con mucho margen
+    PreTriggerBuffer::Config config;
+    config.seconds = kPreTriggerSeconds;
+    m_videoCaptureHandler->startPreTrigger(config);
+  } else {
+    m_videoCaptureHandler->stopPreTrigger();
+  }
+  ui->pushButtonIncidente->setEnabled(checked);
+}
+
+void MainWindow::on_checkBoxCompartir_toggled(bool checked) {
+  if (checked) {
+    m_videoCaptureHandler->startSharing(SharedFramePublisher::Config());
+  } else {
+    m_videoCaptureHandler->stopSharing();
+  }
+}
+
+// Puerto del servidor MJPEG; solo escucha en localhost
+static constexpr quint16 kStreamPort = 8080;
+
+void MainWindow::on_checkBoxServidor_toggled(bool checked) {
+  if (!checked) {
+    m_videoCaptureHandler->stopStreaming();
+    m_streamServer->close();
+    return;
+  }
+  if (!m_streamServer) {
+    m_streamServer = new MjpegServer(WorkStealingPool::shared(), this);
+  }
+  if (!m_streamServer->listen(QHostAddress::LocalHost, kStreamPort)) {
+    QMessageBox::warning(
+        this, tr("Servidor HTTP"), tr("No se pudo abrir el puerto %1.").arg(kStreamPort));
+    const QSignalBlocker blocker(ui->checkBoxServidor);
+    ui->checkBoxServidor->setChecked(false);
+    return;
+  }
+  m_videoCaptureHandler->startStreaming(m_streamServer->sink());
+}
+
+void MainWindow::on_pushButtonIncidente_clicked() {
+  QString folder = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation);
+  if (folder.isEmpty()) {
+    folder = QDir::homePath();
+  }
+  const QString path = QDir(folder).filePath(
+      QDateTime::currentDateTime().toString("'incidente_'yyyyMMdd_hhmmss'.avi'"));
+  if (m_videoCaptureHandler->triggerClip(
+          std::make_unique<VideoFileSink>(path), kPostTriggerSeconds)) {
+    statusBar()->showMessage(tr("Guardando incidente en %1").arg(path), 5000);
+  } else {
+    statusBar()->showMessage(
+        tr("No hay frames almacenados o ya se está guardando un incidente"), 5000);
+  }
+}
+
+void MainWindow::on_checkBoxEstadisticas_toggled(bool checked) {
+  // La primera ventana empieza ahora, no desde el arranque
+  m_lastTiming = m_videoCaptureHandler->timingStats().snapshot();
+  m_lastCaptureStats = m_videoCaptureHandler->captureStats();
+  m_lastStatsTime.start();
+  m_videoCaptureHandler->setStatisticsEnabled(checked);
+  m_statsOverlay->setText(tr("Midiendo…"));
+  m_statsOverlay->adjustSize();
+  m_statsOverlay->setVisible(checked);
+}
+
+void MainWindow::on_pushButtonTraza_toggled(bool checked) {
+  FrameTraceRecorder &trace = m_presenter->trace();
+  if (checked) {
+    trace.clear();
+    trace.setEnabled(true);
+    ui->pushButtonTraza->setText(tr("Guardar traza"));
+    return;
+  }
+  trace.setEnabled(false);
+  ui->pushButtonTraza->setText(tr("Traza"));
+  if (trace.size() == 0) {
+    statusBar()->showMessage(tr("La traza está vacía: no se ha mostrado ningún frame."), 5000);
+    return;
+  }
+  const QString path = QFileDialog::getSaveFileName(
+      this, tr("Guardar traza"), "traza.json", tr("Traza de Chrome/Perfetto (*.json)"));
+  if (!path.isEmpty() && !trace.save(path)) {
+    QMessageBox::warning(this, tr("Traza"), tr("No se pudo guardar la traza en %1").arg(path));
+  }
+}
+
 // nuevo slot)
 void MainWindow::on_propertiesSupported(CameraPropertiesSupport support) { m_support = support; }
 
@@ -158,11 +356,37 @@ void MainWindow::on_propertiesSupported(CameraPropertiesSupport support) { m_sup
 void MainWindow::on_checkBoxFocoAuto_toggled(bool checked) {
   m_videoCaptureHandler->setAutoFocus(checked);
   ui->horizontalSliderFoco->setEnabled(m_support.focus && !checked);
+  if (checked) {
+    ui->checkBoxAfSoftware->setChecked(false);
+  }
 }
 
 void MainWindow::on_checkBoxExposicionAuto_toggled(bool checked) {
   m_videoCaptureHandler->setAutoExposure(checked);
   ui->horizontalSliderExposicion->setEnabled(m_support.exposure && !checked);
+  if (checked) {
+    ui->checkBoxAeSoftware->setChecked(false);
+  }
+}
+
+// Exposición y foco por software: mueven los mismos controles que los sliders, así que los modos
+// automáticos de la cámara tienen que estar desactivados
+void MainWindow::on_checkBoxAeSoftware_toggled(bool checked) {
+  if (checked) {
+    ui->checkBoxExposicionAuto->setChecked(false);
+  }
+  m_videoCaptureHandler->setSoftwareAutoExposure(checked);
+  ui->horizontalSliderExposicion->setEnabled(
+      m_support.exposure && !checked && !ui->checkBoxExposicionAuto->isChecked());
+}
+
+void MainWindow::on_checkBoxAfSoftware_toggled(bool checked) {
+  if (checked) {
+    ui->checkBoxFocoAuto->setChecked(false);
+  }
+  m_videoCaptureHandler->setSoftwareAutoFocus(checked);
+  ui->horizontalSliderFoco->setEnabled(
+      m_support.focus && !checked && !ui->checkBoxFocoAuto->isChecked());
 }
 
 void MainWindow::on_horizontalSliderFoco_sliderMoved(int value) {
@@ -213,15 +437,264 @@ void MainWindow::setAllControlsEnabled(bool enabled) {
 
 void MainWindow::resizeEvent(QResizeEvent *event) {
   QMainWindow::resizeEvent(event);
+  m_videoCaptureHandler->setPreviewSize(ui->videoLabel->size() * devicePixelRatio());
   updateVideoLabel();
 }
 
-void MainWindow::updateVideoLabel() {
-  if (m_currentPixmap.isNull()) {
+void MainWindow::updateVideoLabel() { m_presenter->refresh(); }
+
+void MainWindow::updateStats() {
+  // En modo mosaico cada cámara muestra sus propias estadísticas
+  if (!ui->startButton->isChecked() || m_mosaicView->isRunning()) {
     return;
   }
-  ui->videoLabel->setPixmap(m_currentPixmap.scaled(
-      ui->videoLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+  const CaptureStats stats = m_videoCaptureHandler->captureStats();
+  if (ui->checkBoxEstadisticas->isChecked()) {
+    updateStatsOverlay(stats);
+  }
+  QString message = tr("Capturados: %1 | Descartados: %2 | Mostrados: %3 | Omitidos: %4")
+                        .arg(stats.captured)
+                        .arg(stats.dropped + stats.poolExhausted + stats.processingDropped)
+                        .arg(m_presenter->presentedCount())
+                        .arg(m_presenter->skippedCount());
+  if (stats.requestedFps > 0) {
+    message += tr(" | Origen: %1 de %2 fps, %3 perdidos")
+                   .arg(stats.achievedFps, 0, 'f', 1)
+                   .arg(stats.requestedFps)
+                   .arg(stats.sourceLost);
+  } else {
+    message += tr(" | Origen: %1 fps, %2 perdidos")
+                   .arg(stats.achievedFps, 0, 'f', 1)
+                   .arg(stats.sourceLost);
+  }
+  const FrameRecorder::Stats recording = m_videoCaptureHandler->recordingStats();
+  if (recording.recording) {
+    if (recording.failed) {
+      message += tr(" | Grabación: error al escribir");
+    } else {
+      message += tr(" | Grabando: %1 escritos, cola %2/%3 (máx. %4), %5 descartados")
+                     .arg(recording.written)
+                     .arg(recording.backlog)
+                     .arg(recording.capacity)
+                     .arg(recording.maxBacklog)
+                     .arg(recording.dropped);
+    }
+  }
+  const FrameRecorder::Stats sharing = m_videoCaptureHandler->sharingStats();
+  if (sharing.recording) {
+    if (sharing.failed) {
+      message += tr(" | Compartir: error al crear la memoria compartida");
+    } else {
+      message +=
+          tr(" | Compartidos: %1 (%2 descartados)").arg(sharing.written).arg(sharing.dropped);
+    }
+  }
+  if (ui->checkBoxSoloCambios->isChecked()) {
+    // Por segundo desde la actualización anterior
+    const ChangeDetectionStats changes = m_videoCaptureHandler->changeDetectionStats();
+    const double seconds = qMax<qint64>(1, m_lastChangeStatsTime.restart()) / 1000.0;
+    const quint64 unchanged = changes.unchanged - m_lastChangeStats.unchanged;
+    const quint64 total = unchanged + changes.delivered - m_lastChangeStats.delivered;
+    message += tr(" | Sin cambios: %1 de %2 frames, CPU ahorrada ~%3 ms/s (detección %4 ms/s)")
+                   .arg(unchanged)
+                   .arg(total)
+                   .arg((changes.savedMs - m_lastChangeStats.savedMs) / seconds, 0, 'f', 1)
+                   .arg((changes.detectMs - m_lastChangeStats.detectMs) / seconds, 0, 'f', 1);
+    m_lastChangeStats = changes;
+  }
+  if (ui->checkBoxServidor->isChecked()) {
+    const MjpegServer::Stats streaming = m_streamServer->stats();
+    message += tr(" | %1: %2 clientes, %3 JPEG (%4 sin recodificar), %5 saltados")
+                   .arg(m_streamServer->url())
+                   .arg(streaming.clients)
+                   .arg(streaming.encoding.encoded)
+                   .arg(streaming.encoding.passedThrough)
+                   .arg(streaming.encoding.skipped + streaming.clientSkipped);
+  }
+  if (ui->checkBoxPreGrabacion->isChecked()) {
+    const PreTriggerBuffer::Stats preTrigger = m_videoCaptureHandler->preTriggerStats();
+    message += tr(" | Pre-grabación: %1 s (%2/%3 MB)")
+                   .arg(preTrigger.seconds, 0, 'f', 1)
+                   .arg(preTrigger.bytesUsed >> 20)
+                   .arg(preTrigger.capacityBytes >> 20);
+    if (preTrigger.exporting) {
+      message += tr(", guardando incidente (%1 frames)").arg(preTrigger.exported);
+    }
+  }
+  // Tiempo medio y máximo de cada etapa de procesado
+  for (const FramePipeline::StageStats &stage : m_videoCaptureHandler->processingStats()) {
+    message += tr(" | %1: %2 ms (máx. %3)")
+                   .arg(stage.name)
+                   .arg(stage.averageMs, 0, 'f', 1)
+                   .arg(stage.maxMs, 0, 'f', 1);
+  }
+  statusBar()->showMessage(message);
+}
+
+void MainWindow::updateStatsOverlay(const CaptureStats &stats) {
+  using namespace FrameTiming;
+  const FrameTimingStats::Snapshot now = m_videoCaptureHandler->timingStats().snapshot();
+  const FrameTimingStats::Snapshot window = now - m_lastTiming;
+  const double seconds = qMax<qint64>(1, m_lastStatsTime.restart()) / 1000.0;
+  const quint64 dropped = stats.dropped + stats.poolExhausted + stats.processingDropped;
+  const quint64 lastDropped = m_lastCaptureStats.dropped + m_lastCaptureStats.poolExhausted +
+                              m_lastCaptureStats.processingDropped;
+  m_lastTiming = now;
+  m_lastCaptureStats = stats;
+
+  QString text = tr("%1 fps | descartados %2/s\nlatencia p50 %3 ms | p99 %4 ms")
+                     .arg(window.count(Total) / seconds, 0, 'f', 1)
+                     .arg((dropped - lastDropped) / seconds, 0, 'f', 1)
+                     .arg(window.percentileMs(Total, 50), 0, 'f', 1)
+                     .arg(window.percentileMs(Total, 99), 0, 'f', 1);
+  // Ritmo del origen según sus marcas de tiempo, frente al pedido y al negociado
+  text += tr("\norigen %1 fps (pedidos %2, negociados %3) | perdidos %4 | repetidos %5")
+              .arg(stats.achievedFps, 0, 'f', 1)
+              .arg(stats.requestedFps > 0 ? QString::number(stats.requestedFps) : tr("auto"))
+              .arg(stats.negotiatedFps > 0 ? QString::number(stats.negotiatedFps, 'f', 1) : "?")
+              .arg(stats.sourceLost)
+              .arg(stats.sourceDuplicates);
+  if (!stats.driverTimestamps) {
+    text += tr(" (sin marcas del driver)");
+  }
+  for (int interval = 0; interval < Total; ++interval) {
+    text += QStringLiteral("\n%1 %2 / %3 ms")
+                .arg(QString::fromUtf8(intervalName(Interval(interval))), -16)
+                .arg(window.percentileMs(Interval(interval), 50), 6, 'f', 2)
+                .arg(window.percentileMs(Interval(interval), 99), 6, 'f', 2);
+  }
+  const ImageAnalysis analysis = m_videoCaptureHandler->imageAnalysis();
+  const ImageStatistics &image = analysis.statistics;
+  if (image.samples > 0) {
+    text += tr("\nluma %1 (p5 %2, p50 %3, p95 %4) | nitidez %5 | %6 ms")
+                .arg(image.mean, 0, 'f', 0)
+                .arg(image.p5)
+                .arg(image.p50)
+                .arg(image.p95)
+                .arg(image.sharpness, 0, 'f', 0)
+                .arg(image.computeNs / 1e6, 0, 'f', 2);
+  }
+  if (analysis.exposureEnabled) {
+    text += tr("\nAE %1: %2")
+                .arg(analysis.exposureConverged ? tr("estable") : tr("ajustando"))
+                .arg(analysis.exposure, 0, 'f', 0);
+  }
+  if (analysis.focusEnabled) {
+    const bool locked = analysis.focusState == SoftwareAutoFocus::State::Locked;
+    text += tr("\nAF %1: %2")
+                .arg(locked ? tr("enfocado") : tr("buscando"))
+                .arg(analysis.focus, 0, 'f', 0);
+  }
+  m_statsOverlay->setText(text);
+  m_statsOverlay->adjustSize();
+}
+
+QString MainWindow::selectedSourceSpec() const {
+  QString sourceSpec = ui->comboBoxCameras->currentData().toString();
+  if (ui->checkBoxMjpeg->isChecked() && sourceSpec.startsWith("camera:")) {
+    sourceSpec.replace(0, 6, "mjpeg");
+  } else if (ui->checkBoxYuv->isChecked() && sourceSpec.startsWith("camera:")) {
+    sourceSpec.replace(0, 6, "yuyv");
+  }
+  return sourceSpec;
+}
+
+// Orígenes que se dejan abiertos en reserva con el cambio sin corte
+static constexpr int kWarmSources = 2;
+
+bool MainWindow::requestSelectedSource() {
+  QString sourceSpec = selectedSourceSpec();
+  if (sourceSpec == "file:") {
+    const QString path = QFileDialog::getOpenFileName(
+        this, "Abrir vídeo", QString(), "Vídeo (*.mp4 *.avi *.mkv *.mov);;Todos (*)");
+    if (path.isEmpty()) {
+      return false;
+    }
+    sourceSpec += path;
+  }
+  m_videoCaptureHandler->setPreviewSize(ui->videoLabel->size() * devicePixelRatio());
+  m_videoCaptureHandler->requestSourceChange(
+      sourceSpec, parseResolution(ui->comboBoxResolution->currentText()));
+  return true;
+}
+
+void MainWindow::on_comboBoxCameras_currentIndexChanged(int index) {
+  Q_UNUSED(index);
+  updateResolutionList();
+  // Solo puede cambiar en marcha con el cambio sin corte: la imagen actual sigue hasta que la
+  // cámara nueva está lista
+  if (ui->startButton->isChecked() && !m_mosaicView->isRunning()) {
+    requestSelectedSource();
+  }
+}
+
+void MainWindow::on_checkBoxSoloCambios_toggled(bool checked) {
+  m_videoCaptureHandler->setChangeDetection(checked);
+  m_lastChangeStats = m_videoCaptureHandler->changeDetectionStats();
+  m_lastChangeStatsTime.start();
+}
+
+void MainWindow::on_checkBoxSinCorte_toggled(bool checked) {
+  m_videoCaptureHandler->setHotSwap(checked, kWarmSources);
+  if (ui->startButton->isChecked() && !m_mosaicView->isRunning()) {
+    ui->comboBoxCameras->setEnabled(checked);
+  }
+}
+
+void MainWindow::on_checkBoxMjpeg_toggled(bool checked) {
+  if (checked) {
+    ui->checkBoxYuv->setChecked(false); // Un solo formato de captura
+  }
+  updateResolutionList();
+}
+
+void MainWindow::on_checkBoxYuv_toggled(bool checked) {
+  if (checked) {
+    ui->checkBoxMjpeg->setChecked(false);
+  }
+  updateResolutionList();
+}
+
+void MainWindow::updateResolutionList() {
+  // Si el dispositivo ya se ha abierto alguna vez se ofrecen sus modos reales, sin abrirlo; si no,
+  // la lista fija del formulario
+  DeviceCapabilityCache &cache = DeviceCapabilityCache::shared();
+  const QString deviceKey = cache.deviceKeyFor(selectedSourceSpec());
+  DeviceCapabilities capabilities;
+  QList<CaptureFormat> formats;
+  if (!deviceKey.isEmpty() && cache.find(deviceKey, capabilities)) {
+    formats = capabilities.formats;
+  }
+  std::sort(formats.begin(), formats.end(), [](const CaptureFormat &a, const CaptureFormat &b) {
+    const qint64 areaA = qint64(a.resolution.width()) * a.resolution.height();
+    const qint64 areaB = qint64(b.resolution.width()) * b.resolution.height();
+    return areaA != areaB ? areaA > areaB : a.maxFps > b.maxFps;
+  });
+
+  const QString current = ui->comboBoxResolution->currentText();
+  const QSignalBlocker blocker(ui->comboBoxResolution);
+  ui->comboBoxResolution->clear();
+  if (formats.isEmpty()) {
+    ui->comboBoxResolution->addItems(m_defaultResolutions);
+  } else {
+    ui->comboBoxResolution->addItem("Default");
+    for (const CaptureFormat &format : std::as_const(formats)) {
+      const QString text =
+          QStringLiteral("%1x%2").arg(format.resolution.width()).arg(format.resolution.height());
+      const int existing = ui->comboBoxResolution->findText(text);
+      const QString mode = tr("%1: hasta %2 fps").arg(format.pixelFormat).arg(format.maxFps);
+      if (existing < 0) {
+        ui->comboBoxResolution->addItem(text);
+        ui->comboBoxResolution->setItemData(
+            ui->comboBoxResolution->count() - 1, mode, Qt::ToolTipRole);
+      } else {
+        const QString tooltip =
+            ui->comboBoxResolution->itemData(existing, Qt::ToolTipRole).toString();
+        ui->comboBoxResolution->setItemData(existing, tooltip + '\n' + mode, Qt::ToolTipRole);
+      }
+    }
+  }
+  ui->comboBoxResolution->setCurrentIndex(qMax(0, ui->comboBoxResolution->findText(current)));
 }
 
 QSize MainWindow::parseResolution(const QString &text) {
@@ -1,11 +1,18 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "framepresenter.h"
+#include "mjpegserver.h"
+#include "mosaicview.h"
 #include "videocapturehandler.h"
+#include <QElapsedTimer>
+#include <QLabel>
 #include <QMainWindow>
 #include <QPixmap>
 #include <QResizeEvent>
 #include <QSize>
+#include <QStringList>
+#include <QTimer>
 
 namespace Ui {
 class MainWindow;
@@ -30,6 +37,22 @@ private slots:
   void on_propertiesSupported(CameraPropertiesSupport support);
   void on_rangesSupported(const CameraPropertyRanges &ranges);
   void on_cameraOpenFailed(int cameraId, const QString &errorMsg);
+  void on_comboBoxProcesado_currentIndexChanged(int index);
+  void on_comboBoxFps_currentIndexChanged(int index);
+  void on_checkBoxEstadisticas_toggled(bool checked);
+  void on_pushButtonTraza_toggled(bool checked);
+  void on_pushButtonGrabar_toggled(bool checked);
+  void on_checkBoxPreGrabacion_toggled(bool checked);
+  void on_pushButtonIncidente_clicked();
+  void on_checkBoxCompartir_toggled(bool checked);
+  void on_checkBoxServidor_toggled(bool checked);
+  void on_checkBoxSoloCambios_toggled(bool checked);
+  void on_comboBoxCameras_currentIndexChanged(int index);
+  void on_checkBoxMjpeg_toggled(bool checked);
+  void on_checkBoxYuv_toggled(bool checked);
+  void on_checkBoxSinCorte_toggled(bool checked);
+  void on_checkBoxAeSoftware_toggled(bool checked);
+  void on_checkBoxAfSoftware_toggled(bool checked);
 
   void on_checkBoxFocoAuto_toggled(bool checked);
   void on_checkBoxExposicionAuto_toggled(bool checked);
@@ -44,15 +67,35 @@ private:
   Ui::MainWindow *ui;
   VideoCaptureHandler *m_videoCaptureHandler;
 
-  QPixmap m_currentPixmap;
+  FramePresenter *m_presenter;
+  MosaicView *m_mosaicView;
+  MjpegServer *m_streamServer = nullptr; // Se crea la primera vez que se activa
+  QTimer m_statsTimer;
+
+  // Estadísticas sobre la imagen: ventana móvil entre dos actualizaciones de updateStats()
+  QLabel *m_statsOverlay;
+  FrameTimingStats::Snapshot m_lastTiming;
+  CaptureStats m_lastCaptureStats;
+  QElapsedTimer m_lastStatsTime;
+  // Detección de cambios en la última actualización de la barra de estado
+  ChangeDetectionStats m_lastChangeStats;
+  QElapsedTimer m_lastChangeStatsTime;
 
   CameraPropertiesSupport m_support;
   CameraPropertyRanges m_ranges;
 
   void updateVideoLabel();
+  void updateStats();
+  void updateStatsOverlay(const CaptureStats &stats);
 
   void setAllControlsEnabled(bool enabled);
 
+  // Resoluciones del formulario, para dispositivos que aún no están en la caché de capacidades
+  QStringList m_defaultResolutions;
+  void updateResolutionList();
+  QString selectedSourceSpec() const;
+  bool requestSelectedSource(); // false si se cancela la elección del archivo
+
   QSize parseResolution(const QString &text);
 
   int mapSliderToOpenCV(int sliderValue, const PropertyRange &range);
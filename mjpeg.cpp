@@ -0,0 +1,73 @@
+#include "mjpeg.h"
+#include "framedecoder.h"
+#include <opencv2/imgcodecs.hpp>
+
+cv::Size Mjpeg::peekSize(const cv::Mat &data) {
+  if (data.empty() || !data.isContinuous() || data.depth() != CV_8U) {
+    return cv::Size();
+  }
+  const uchar *bytes = data.ptr<uchar>();
+  const size_t size = data.total() * data.elemSize();
+  if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+    return cv::Size();
+  }
+  size_t pos = 2;
+  while (pos + 4 <= size) {
+    if (bytes[pos] != 0xFF) {
+      return cv::Size();
+    }
+    const uchar marker = bytes[pos + 1];
+    if (marker == 0xFF) { // Relleno entre marcadores
+      ++pos;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) { // Sin longitud
+      pos += 2;
+      continue;
+    }
+    const size_t length = (size_t(bytes[pos + 2]) << 8) | bytes[pos + 3];
+    // SOF0..SOF15 salvo DHT (C4), JPG (C8) y DAC (CC): precisión, alto y ancho
+    const bool isFrameHeader =
+        marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+    if (isFrameHeader && pos + 9 <= size) {
+      const int height = (bytes[pos + 5] << 8) | bytes[pos + 6];
+      const int width = (bytes[pos + 7] << 8) | bytes[pos + 8];
+      return cv::Size(width, height);
+    }
+    if (marker == 0xDA) { // Empiezan los datos comprimidos sin haber visto SOF
+      return cv::Size();
+    }
+    pos += 2 + length;
+  }
+  return cv::Size();
+}
+
+int Mjpeg::reductionFor(const cv::Size &fullSize, const QSize &target) {
+  if (fullSize.empty() || target.isEmpty()) {
+    return 1;
+  }
+  int reduction = 1;
+  while (reduction < 8 && fullSize.width / (reduction * 2) >= target.width() &&
+         fullSize.height / (reduction * 2) >= target.height()) {
+    reduction *= 2;
+  }
+  return reduction;
+}
+
+bool Mjpeg::decode(const cv::Mat &data, cv::Mat &out, int reduction) {
+  int flags = cv::IMREAD_COLOR;
+  switch (reduction) {
+  case 2:
+    flags = cv::IMREAD_REDUCED_COLOR_2;
+    break;
+  case 4:
+    flags = cv::IMREAD_REDUCED_COLOR_4;
+    break;
+  case 8:
+    flags = cv::IMREAD_REDUCED_COLOR_8;
+    break;
+  }
+  FrameDecoder::detachShared(out);
+  cv::imdecode(data, flags, &out);
+  return !out.empty();
+}
@@ -0,0 +1,25 @@
+#ifndef MJPEG_H
+#define MJPEG_H
+
+#include <QSize>
+#include <opencv2/core.hpp>
+
+// Decodificación de frames MJPEG tal y como los entrega la cámara (CAP_PROP_CONVERT_RGB a 0).
+//
+// libjpeg puede decodificar directamente a 1/2, 1/4 y 1/8 del tamaño escalando en el dominio de
+// la DCT, lo que cuesta una fracción de la decodificación completa: es lo que usa la vista previa.
+// La resolución completa solo se decodifica para quien la pide (grabación, etapas de análisis).
+namespace Mjpeg {
+
+// Tamaño de la imagen leído de la cabecera (marcador SOF), sin decodificar; vacío si no es JPEG
+cv::Size peekSize(const cv::Mat &data);
+
+// Mayor reducción (1, 2, 4 u 8) que deja la imagen al menos tan grande como 'target'
+int reductionFor(const cv::Size &fullSize, const QSize &target);
+
+// Decodifica a BGR. Reutiliza el buffer de 'out' si nadie más lo está usando.
+bool decode(const cv::Mat &data, cv::Mat &out, int reduction = 1);
+
+} // namespace Mjpeg
+
+#endif // MJPEG_H
@@ -0,0 +1,342 @@
+#include "mjpegserver.h"
+#include "mjpeg.h"
+#include <QDebug>
+#include <QTcpSocket>
+#include <QUrl>
+#include <QUrlQuery>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+namespace {
+
+constexpr int kDefaultQuality = 80;
+constexpr int kWidths[] = {320, 480, 640, 960, 1280, 1920}; // Niveles de ancho de ?w=
+constexpr int kMaxRequestBytes = 8192;
+
+// Redondea lo pedido a los niveles fijos, para que clientes parecidos compartan codificación
+MjpegTier tierFromQuery(const QUrlQuery &query) {
+  MjpegTier tier;
+  bool ok = false;
+  const int quality = query.queryItemValue("q").toInt(&ok);
+  if (ok && quality > 0) {
+    tier.quality = qBound(10, (quality + 5) / 10 * 10, 100);
+  }
+  const int width = query.queryItemValue("w").toInt(&ok);
+  if (ok && width > 0) {
+    for (int level : kWidths) {
+      if (level >= width) {
+        tier.maxWidth = level;
+        break;
+      }
+    }
+  }
+  return tier;
+}
+
+void reply(
+    QTcpSocket *socket, const QByteArray &status, const QByteArray &type,
+    const QByteArray &body) {
+  socket->write(
+      "HTTP/1.0 " + status + "\r\nContent-Type: " + type +
+      "\r\nContent-Length: " + QByteArray::number(body.size()) +
+      "\r\nConnection: close\r\n\r\n");
+  socket->write(body);
+  socket->disconnectFromHost(); // Cierra cuando se haya enviado todo
+}
+
+} // namespace
+
+// --- MjpegStreamHub ---
+
+MjpegStreamHub::MjpegStreamHub(WorkStealingPool &pool) : m_pool(pool) {}
+
+void MjpegStreamHub::setListener(Listener listener) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_listener = std::move(listener);
+}
+
+void MjpegStreamHub::subscribe(const MjpegTier &tier) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::shared_ptr<TierState> &state = m_tiers[tier.key()];
+  if (!state) {
+    state = std::make_shared<TierState>();
+    state->tier = tier;
+  }
+  ++state->subscribers;
+}
+
+void MjpegStreamHub::unsubscribe(const MjpegTier &tier) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = m_tiers.find(tier.key());
+  if (it != m_tiers.end() && --it->second->subscribers <= 0) {
+    m_tiers.erase(it); // Una codificación en curso termina sobre su propia referencia
+  }
+}
+
+bool MjpegStreamHub::latest(int tierKey, Encoded &encoded) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = m_tiers.find(tierKey);
+  if (it == m_tiers.end() || it->second->latest.number == 0) {
+    return false;
+  }
+  encoded = it->second->latest;
+  return true;
+}
+
+MjpegStreamHub::Stats MjpegStreamHub::stats() const {
+  Stats stats;
+  stats.encoded = m_encoded.load(std::memory_order_relaxed);
+  stats.passedThrough = m_passedThrough.load(std::memory_order_relaxed);
+  stats.skipped = m_skipped.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  stats.tiers = static_cast<int>(m_tiers.size());
+  return stats;
+}
+
+bool MjpegStreamHub::open(const cv::Size &size, int type, double fps) {
+  Q_UNUSED(size);
+  Q_UNUSED(type);
+  Q_UNUSED(fps);
+  return true;
+}
+
+bool MjpegStreamHub::write(const CapturedFrame &frame) {
+  std::vector<std::shared_ptr<TierState>> tiers;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &entry : m_tiers) {
+      tiers.push_back(entry.second);
+    }
+  }
+  for (const std::shared_ptr<TierState> &state : tiers) {
+    // Como mucho una codificación por nivel: si va por detrás, este frame no se codifica
+    if (state->busy.exchange(true, std::memory_order_acq_rel)) {
+      m_skipped.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    // La tarea comparte los píxeles (o el JPEG de la cámara) por contador de referencias
+    m_pool.submit([self = shared_from_this(), state, frame] {
+      self->encode(state, frame);
+      state->busy.store(false, std::memory_order_release);
+    });
+  }
+  return true;
+}
+
+void MjpegStreamHub::encode(const std::shared_ptr<TierState> &state, const CapturedFrame &frame) {
+  const MjpegTier &tier = state->tier;
+  const bool mjpeg = frame.encoding == FrameEncoding::Mjpeg;
+  QByteArray jpeg;
+  if (mjpeg && tier.quality == 0 && tier.maxWidth == 0) {
+    // Ya viene en JPEG de la cámara y nadie ha pedido otra cosa: se sirve tal cual
+    jpeg = QByteArray(
+        reinterpret_cast<const char *>(frame.image.data),
+        static_cast<int>(frame.image.total() * frame.image.elemSize()));
+    m_passedThrough.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    const cv::Size size = mjpeg ? Mjpeg::peekSize(frame.image) : frame.image.size();
+    if (size.empty()) {
+      return;
+    }
+    cv::Size target = size;
+    if (tier.maxWidth > 0 && size.width > tier.maxWidth) {
+      target = cv::Size(
+          tier.maxWidth, qMax(1, qRound(double(size.height) * tier.maxWidth / size.width)));
+    }
+    cv::Mat image;
+    if (mjpeg) {
+      const int reduction = Mjpeg::reductionFor(size, QSize(target.width, target.height));
+      if (!Mjpeg::decode(frame.image, image, reduction)) {
+        return;
+      }
+    } else {
+      image = frame.image;
+    }
+    cv::Mat scaled;
+    if (image.size() != target) {
+      cv::resize(image, scaled, target, 0, 0, cv::INTER_AREA);
+      image = scaled;
+    }
+    if (image.channels() == 4) {
+      cv::cvtColor(image, scaled, cv::COLOR_BGRA2BGR);
+      image = scaled;
+    }
+    std::vector<uchar> buffer;
+    const int quality = tier.quality > 0 ? tier.quality : kDefaultQuality;
+    if (!cv::imencode(".jpg", image, buffer, {cv::IMWRITE_JPEG_QUALITY, quality})) {
+      return;
+    }
+    jpeg = QByteArray(reinterpret_cast<const char *>(buffer.data()), int(buffer.size()));
+    m_encoded.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  state->latest.jpeg = jpeg;
+  state->latest.number = ++state->encodedCount;
+  state->latest.sequence = frame.sequence;
+  // Bajo el mutex: setListener(nullptr) garantiza que después ya no se llama
+  if (m_listener) {
+    m_listener(tier.key());
+  }
+}
+
+// --- MjpegServer ---
+
+MjpegServer::MjpegServer(WorkStealingPool &pool, QObject *parent)
+    : QObject(parent), m_hub(std::make_shared<MjpegStreamHub>(pool)) {
+  connect(&m_server, &QTcpServer::newConnection, this, &MjpegServer::onNewConnection);
+  // Cada JPEG nuevo se reparte desde el hilo del servidor, que es el dueño de los sockets
+  m_hub->setListener([this](int tierKey) {
+    QMetaObject::invokeMethod(this, [this, tierKey] { deliver(tierKey); }, Qt::QueuedConnection);
+  });
+}
+
+MjpegServer::~MjpegServer() {
+  m_hub->setListener(nullptr);
+  close();
+}
+
+bool MjpegServer::listen(const QHostAddress &address, quint16 port) {
+  if (!m_server.listen(address, port)) {
+    qWarning() << "MjpegServer - No se pudo escuchar en" << address.toString() << port
+               << m_server.errorString();
+    return false;
+  }
+  qDebug() << "MjpegServer - Sirviendo en" << url();
+  return true;
+}
+
+void MjpegServer::close() {
+  m_server.close();
+  for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+    if (it.value().streaming) {
+      m_hub->unsubscribe(it.value().tier);
+    }
+    it.key()->disconnect(this);
+    it.key()->abort();
+    it.key()->deleteLater();
+  }
+  m_clients.clear();
+}
+
+QString MjpegServer::url() const {
+  return QStringLiteral("http://%1:%2/")
+      .arg(m_server.serverAddress().toString())
+      .arg(m_server.serverPort());
+}
+
+MjpegServer::Stats MjpegServer::stats() const {
+  Stats stats;
+  for (const Client &client : m_clients) {
+    stats.clients += client.streaming ? 1 : 0;
+  }
+  stats.sent = m_sent;
+  stats.clientSkipped = m_clientSkipped;
+  stats.encoding = m_hub->stats();
+  return stats;
+}
+
+void MjpegServer::onNewConnection() {
+  while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_clients.insert(socket, Client());
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket] { onReadyRead(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket] { onDisconnected(socket); });
+    // Al vaciarse el envío anterior, el cliente recibe el JPEG más reciente de su nivel
+    connect(socket, &QTcpSocket::bytesWritten, this, [this, socket] {
+      const auto it = m_clients.find(socket);
+      if (it != m_clients.end() && it.value().streaming) {
+        trySend(socket, it.value());
+      }
+    });
+  }
+}
+
+void MjpegServer::onReadyRead(QTcpSocket *socket) {
+  const auto it = m_clients.find(socket);
+  if (it == m_clients.end()) {
+    return;
+  }
+  Client &client = it.value();
+  if (client.streaming) {
+    socket->readAll(); // Una vez emitiendo, lo que mande el cliente no importa
+    return;
+  }
+  client.request += socket->readAll();
+  if (client.request.contains("\r\n\r\n")) {
+    handleRequest(socket, client);
+  } else if (client.request.size() > kMaxRequestBytes) {
+    reply(socket, "400 Bad Request", "text/plain", "Petición demasiado larga\n");
+  }
+}
+
+void MjpegServer::onDisconnected(QTcpSocket *socket) {
+  const auto it = m_clients.find(socket);
+  if (it != m_clients.end()) {
+    if (it.value().streaming) {
+      m_hub->unsubscribe(it.value().tier);
+    }
+    m_clients.erase(it);
+  }
+  socket->deleteLater();
+}
+
+void MjpegServer::handleRequest(QTcpSocket *socket, Client &client) {
+  const QList<QByteArray> requestLine =
+      client.request.left(client.request.indexOf("\r\n")).split(' ');
+  if (requestLine.size() < 2 || requestLine[0] != "GET") {
+    reply(socket, "405 Method Not Allowed", "text/plain", "Solo GET\n");
+    return;
+  }
+  const QUrl url(QString::fromLatin1(requestLine[1]));
+  const QString path = url.path();
+  if (path == "/") {
+    // La misma consulta (?q=..&w=..) pasa al flujo
+    const QByteArray query = url.hasQuery() ? "?" + url.query(QUrl::FullyEncoded).toLatin1() : "";
+    reply(
+        socket, "200 OK", "text/html; charset=utf-8",
+        "<!DOCTYPE html><html><body style=\"margin:0;background:#000\">"
+        "<img src=\"/stream" + query + "\" style=\"max-width:100%\"></body></html>");
+  } else if (path == "/stream") {
+    client.streaming = true;
+    client.tier = tierFromQuery(QUrlQuery(url));
+    m_hub->subscribe(client.tier);
+    socket->write(
+        "HTTP/1.0 200 OK\r\nCache-Control: no-cache\r\nPragma: no-cache\r\nConnection: close\r\n"
+        "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n\r\n");
+    trySend(socket, client);
+  } else {
+    reply(socket, "404 Not Found", "text/plain", "No encontrado\n");
+  }
+}
+
+void MjpegServer::deliver(int tierKey) {
+  for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+    if (it.value().streaming && it.value().tier.key() == tierKey) {
+      trySend(it.key(), it.value());
+    }
+  }
+}
+
+void MjpegServer::trySend(QTcpSocket *socket, Client &client) {
+  // Si aún no ha salido el frame anterior el cliente va lento: no se le acumula nada y, cuando
+  // se vacíe (bytesWritten), recibe el más reciente
+  if (socket->bytesToWrite() > 0) {
+    return;
+  }
+  MjpegStreamHub::Encoded encoded;
+  if (!m_hub->latest(client.tier.key(), encoded) || encoded.number <= client.lastSent) {
+    return;
+  }
+  if (client.lastSent > 0) {
+    m_clientSkipped += encoded.number - client.lastSent - 1;
+  }
+  client.lastSent = encoded.number;
+  socket->write(
+      "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: " +
+      QByteArray::number(encoded.jpeg.size()) + "\r\n\r\n");
+  socket->write(encoded.jpeg);
+  socket->write("\r\n");
+  ++m_sent;
+}
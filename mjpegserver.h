@@ -0,0 +1,146 @@
+#ifndef MJPEGSERVER_H
+#define MJPEGSERVER_H
+
+#include "framesink.h"
+#include "workstealingpool.h"
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+class QTcpSocket;
+
+// Calidad y ancho máximo de un flujo JPEG; los clientes que piden lo mismo comparten codificación
+struct MjpegTier {
+  int quality = 0;  // 0 = la de la cámara si ya entrega MJPEG (sin recodificar); si no, 80
+  int maxWidth = 0; // 0 = resolución original
+
+  int key() const { return quality * 100000 + maxWidth; }
+};
+
+// Codificación JPEG de los frames capturados, una vez por frame y nivel, para MjpegServer.
+//
+// Se alimenta como cualquier FrameSink (VideoCaptureHandler::startStreaming()). write() no
+// codifica: reparte una tarea por nivel con clientes al WorkStealingPool, y un nivel que aún está
+// codificando el frame anterior se salta este. Cada nivel guarda solo su último JPEG, en un
+// QByteArray que se comparte sin copiar con todos sus clientes. Los frames MJPEG de la cámara se
+// decodifican ya reducidos (Mjpeg) y, en el nivel por defecto, se sirven tal cual.
+// Se crea siempre con std::make_shared: las tareas del pool se quedan una referencia.
+class MjpegStreamHub : public FrameSink, public std::enable_shared_from_this<MjpegStreamHub> {
+public:
+  struct Encoded {
+    QByteArray jpeg;
+    quint64 number = 0; // Cuenta de JPEG del nivel: los huecos son frames que un cliente no vio
+    quint64 sequence = 0;
+  };
+
+  struct Stats {
+    quint64 encoded = 0;
+    quint64 passedThrough = 0; // JPEG de la cámara servidos sin recodificar
+    quint64 skipped = 0;       // Frames que un nivel no codificó por ir ocupado
+    int tiers = 0;
+  };
+
+  // Se llama desde un hilo del pool cada vez que un nivel tiene un JPEG nuevo
+  using Listener = std::function<void(int tierKey)>;
+
+  explicit MjpegStreamHub(WorkStealingPool &pool);
+
+  void setListener(Listener listener);
+  void subscribe(const MjpegTier &tier);
+  void unsubscribe(const MjpegTier &tier);
+  bool latest(int tierKey, Encoded &encoded) const;
+  Stats stats() const;
+
+  // --- FrameSink (hilo del FrameRecorder) ---
+  bool open(const cv::Size &size, int type, double fps) override;
+  bool write(const CapturedFrame &frame) override;
+  void close() override {}
+  bool acceptsMjpeg() const override { return true; }
+  QString description() const override { return QStringLiteral("MJPEG HTTP"); }
+
+private:
+  struct TierState {
+    MjpegTier tier;
+    int subscribers = 0;
+    std::atomic<bool> busy{false};
+    quint64 encodedCount = 0; // Protegido por m_mutex, como 'latest'
+    Encoded latest;
+  };
+
+  void encode(const std::shared_ptr<TierState> &state, const CapturedFrame &frame);
+
+  WorkStealingPool &m_pool;
+  mutable std::mutex m_mutex;
+  std::map<int, std::shared_ptr<TierState>> m_tiers;
+  Listener m_listener;
+
+  std::atomic<quint64> m_encoded{0};
+  std::atomic<quint64> m_passedThrough{0};
+  std::atomic<quint64> m_skipped{0};
+};
+
+// Servidor HTTP mínimo que emite los frames como multipart MJPEG, para ver la cámara desde un
+// navegador o VLC sin la interfaz:
+//
+//   http://127.0.0.1:8080/                       página con la imagen
+//   http://127.0.0.1:8080/stream?q=60&w=640      flujo MJPEG; q = calidad, w = ancho máximo
+//
+// Calidad y ancho se redondean a unos pocos niveles para que los clientes compartan codificación:
+// un espectador más solo cuesta escribir en su socket. A un cliente lento no se le acumulan
+// frames: mientras no haya vaciado el anterior se le saltan, y al vaciarlo recibe el más reciente.
+// Vive en el hilo que lo crea, que necesita bucle de eventos.
+class MjpegServer : public QObject {
+  Q_OBJECT
+public:
+  struct Stats {
+    int clients = 0;
+    quint64 sent = 0;
+    quint64 clientSkipped = 0; // Frames que algún cliente no recibió por ir lento
+    MjpegStreamHub::Stats encoding;
+  };
+
+  explicit MjpegServer(
+      WorkStealingPool &pool = WorkStealingPool::shared(), QObject *parent = nullptr);
+  ~MjpegServer() override;
+
+  bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 8080);
+  void close();
+  QString url() const;
+
+  // Para VideoCaptureHandler::startStreaming()
+  std::shared_ptr<MjpegStreamHub> sink() const { return m_hub; }
+
+  Stats stats() const;
+
+private slots:
+  void onNewConnection();
+
+private:
+  struct Client {
+    QByteArray request;
+    bool streaming = false;
+    MjpegTier tier;
+    quint64 lastSent = 0;
+  };
+
+  void onReadyRead(QTcpSocket *socket);
+  void onDisconnected(QTcpSocket *socket);
+  void handleRequest(QTcpSocket *socket, Client &client);
+  void deliver(int tierKey);
+  void trySend(QTcpSocket *socket, Client &client);
+
+  QTcpServer m_server;
+  std::shared_ptr<MjpegStreamHub> m_hub;
+  QHash<QTcpSocket *, Client> m_clients;
+  quint64 m_sent{0};
+  quint64 m_clientSkipped{0};
+};
+
+#endif // MJPEGSERVER_H
@@ -0,0 +1,112 @@
+#include "mosaicview.h"
+#include <QResizeEvent>
+#include <QVBoxLayout>
+#include <QtMath>
+#include <utility>
+
+MosaicView::MosaicView(QWidget *parent) : QWidget(parent), m_layout(new QGridLayout(this)) {
+  m_layout->setContentsMargins(0, 0, 0, 0);
+  m_layout->setSpacing(4);
+  connect(&m_statsTimer, &QTimer::timeout, this, &MosaicView::updateStats);
+}
+
+MosaicView::~MosaicView() { stop(); }
+
+void MosaicView::start(const QList<int> &cameraIds, const QSize &resolution) {
+  stop();
+
+  const int columns = qMax(1, qCeil(qSqrt(cameraIds.size())));
+  for (int i = 0; i < cameraIds.size(); ++i) {
+    Tile tile;
+    tile.cameraId = cameraIds[i];
+
+    tile.widget = new QWidget(this);
+    auto *tileLayout = new QVBoxLayout(tile.widget);
+    tileLayout->setContentsMargins(0, 0, 0, 0);
+    tile.videoLabel = new QLabel(tile.widget);
+    tile.videoLabel->setAlignment(Qt::AlignCenter);
+    // Que el pixmap no empuje el tamaño de la rejilla
+    tile.videoLabel->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+    tile.videoLabel->setMinimumSize(160, 90);
+    tile.statsLabel = new QLabel(tr("Cámara %1").arg(tile.cameraId), tile.widget);
+    tileLayout->addWidget(tile.videoLabel, 1);
+    tileLayout->addWidget(tile.statsLabel);
+    m_layout->addWidget(tile.widget, i / columns, i % columns);
+
+    tile.handler = new VideoCaptureHandler(this);
+    tile.handler->setParallelConversion(false);
+    tile.presenter = new FramePresenter(tile.videoLabel, this);
+    connect(
+        tile.handler, &VideoCaptureHandler::cameraOpenFailed, tile.statsLabel,
+        [label = tile.statsLabel](int cameraId, const QString &errorMsg) {
+          label->setText(tr("Cámara %1: %2").arg(cameraId).arg(errorMsg));
+        });
+    tile.handler->start(QThread::HighestPriority);
+    tile.handler->requestCameraChange(tile.cameraId, resolution);
+
+    m_tiles.append(tile);
+  }
+
+  // Los tamaños de las celdas se conocen cuando la rejilla termina de colocarlas
+  QTimer::singleShot(0, this, &MosaicView::updateStreams);
+  m_statsClock.start();
+  m_statsTimer.start(1000);
+}
+
+void MosaicView::stop() {
+  m_statsTimer.stop();
+  for (Tile &tile : m_tiles) {
+    tile.handler->stop();
+    tile.handler->wait();
+    tile.presenter->clear(); // Devolver los frames al pool antes de destruir el manejador
+    delete tile.presenter;
+    delete tile.handler;
+    delete tile.widget;
+  }
+  m_tiles.clear();
+}
+
+void MosaicView::resizeEvent(QResizeEvent *event) {
+  QWidget::resizeEvent(event);
+  updateStreams();
+  for (const Tile &tile : std::as_const(m_tiles)) {
+    tile.presenter->refresh();
+  }
+}
+
+void MosaicView::updateStreams() {
+  for (Tile &tile : m_tiles) {
+    const QSize size = tile.videoLabel->size() * devicePixelRatio();
+    if (size.isEmpty() || size == tile.streamSize) {
+      continue; // Vacía hasta que la rejilla coloca la celda: sería un flujo a tamaño completo
+    }
+    // El nuevo antes de quitar el anterior, para que la celda no se quede sin frames entre medias
+    OutputStreamConfig config;
+    config.maxSize = size;
+    const int previous = tile.streamId;
+    tile.streamId = tile.handler->addOutputStream(
+        config,
+        [presenter = tile.presenter](const FrameHandle &frame) { presenter->submit(frame); });
+    tile.streamSize = size;
+    if (previous != 0) {
+      tile.replacedStreamsDropped += tile.handler->outputStreamStats(previous).dropped;
+      tile.handler->removeOutputStream(previous);
+    }
+  }
+}
+
+void MosaicView::updateStats() {
+  const double seconds = qMax(1e-3, m_statsClock.restart() / 1000.0);
+  for (Tile &tile : m_tiles) {
+    const CaptureStats stats = tile.handler->captureStats();
+    const quint64 dropped = stats.dropped + stats.poolExhausted + tile.replacedStreamsDropped +
+                            tile.handler->outputStreamStats(tile.streamId).dropped;
+    tile.statsLabel->setText(tr("Cámara %1 | %2 fps | Descartados: %3 (+%4)")
+                                 .arg(tile.cameraId)
+                                 .arg((stats.captured - tile.lastCaptured) / seconds, 0, 'f', 1)
+                                 .arg(dropped)
+                                 .arg(dropped - tile.lastDropped));
+    tile.lastCaptured = stats.captured;
+    tile.lastDropped = dropped;
+  }
+}
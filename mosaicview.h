@@ -0,0 +1,58 @@
+#ifndef MOSAICVIEW_H
+#define MOSAICVIEW_H
+
+#include "framepresenter.h"
+#include "videocapturehandler.h"
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QLabel>
+#include <QList>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+
+// Vista en mosaico de varias cámaras capturando a la vez.
+//
+// Cada cámara tiene su propio hilo de captura (el driver bloquea en grab()), pero todas convierten
+// en el pool compartido de WorkStealingPool. Cada mosaico recibe un flujo de salida de su cámara
+// (VideoCaptureHandler::addOutputStream()) al tamaño de su celda, que se sustituye cuando la
+// celda cambia de tamaño, y muestra los fps y descartes de su cámara.
+class MosaicView : public QWidget {
+  Q_OBJECT
+public:
+  explicit MosaicView(QWidget *parent = nullptr);
+  ~MosaicView();
+
+  void start(const QList<int> &cameraIds, const QSize &resolution);
+  void stop();
+  bool isRunning() const { return !m_tiles.isEmpty(); }
+
+protected:
+  void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+  void updateStats();
+  void updateStreams();
+
+private:
+  struct Tile {
+    int cameraId = -1;
+    QWidget *widget = nullptr;
+    QLabel *videoLabel = nullptr;
+    QLabel *statsLabel = nullptr;
+    VideoCaptureHandler *handler = nullptr;
+    FramePresenter *presenter = nullptr;
+    int streamId = 0;
+    QSize streamSize;
+    quint64 replacedStreamsDropped = 0; // Descartes de los flujos ya sustituidos
+    quint64 lastCaptured = 0;
+    quint64 lastDropped = 0;
+  };
+
+  QGridLayout *m_layout;
+  QVector<Tile> m_tiles;
+  QTimer m_statsTimer;
+  QElapsedTimer m_statsClock;
+};
+
+#endif // MOSAICVIEW_H
@@ -0,0 +1,222 @@
+#include "pixelconvert.h"
+#include "pixelconvert_p.h"
+#include <algorithm>
+#include <opencv2/core/utility.hpp>
+
+namespace PixelConvert {
+namespace detail {
+
+void bgrToRgb32RowScalar(const unsigned char *src, unsigned char *dst, int width) {
+  for (int x = 0; x < width; ++x, src += 3, dst += 4) {
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = src[2];
+    dst[3] = 0xFF;
+  }
+}
+
+void bgraToArgb32PmRowScalar(const unsigned char *src, unsigned char *dst, int width) {
+  for (int x = 0; x < width; ++x, src += 4, dst += 4) {
+    const unsigned int a = src[3];
+    dst[0] = premultiply(src[0], a);
+    dst[1] = premultiply(src[1], a);
+    dst[2] = premultiply(src[2], a);
+    dst[3] = static_cast<unsigned char>(a);
+  }
+}
+
+void grayToRgb32RowScalar(const unsigned char *src, unsigned char *dst, int width) {
+  for (int x = 0; x < width; ++x, dst += 4) {
+    dst[0] = dst[1] = dst[2] = src[x];
+    dst[3] = 0xFF;
+  }
+}
+
+void yuyvToRgb32RowScalar(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width) {
+  Q_UNUSED(chroma);
+  for (int x = 0; x < width; ++x, dst += 4) {
+    const unsigned char *pair = luma + (x & ~1) * 2; // Y0 U Y1 V
+    yuvToRgb32(luma[x * 2], pair[1], pair[3], dst);
+  }
+}
+
+void nv12ToRgb32RowScalar(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width) {
+  for (int x = 0; x < width; ++x, dst += 4) {
+    const unsigned char *uv = chroma + (x & ~1);
+    yuvToRgb32(luma[x], uv[0], uv[1], dst);
+  }
+}
+
+} // namespace detail
+
+namespace {
+
+// Por debajo de este tamaño repartir filas entre hilos cuesta más de lo que ahorra
+constexpr int kParallelMinPixels = 640 * 480;
+constexpr int kMinRowsPerStripe = 16;
+
+detail::RowKernel selectKernel(int matType, Isa isa) {
+  using namespace detail;
+#ifdef PIXELCONVERT_X86
+  if (isa == Isa::Avx2) {
+    switch (matType) {
+    case CV_8UC3:
+      return bgrToRgb32RowAvx2;
+    case CV_8UC4:
+      return bgraToArgb32PmRowAvx2;
+    case CV_8UC1:
+      return grayToRgb32RowAvx2;
+    }
+  } else if (isa == Isa::Ssse3) {
+    switch (matType) {
+    case CV_8UC3:
+      return bgrToRgb32RowSsse3;
+    case CV_8UC4:
+      return bgraToArgb32PmRowSsse3;
+    case CV_8UC1:
+      return grayToRgb32RowSsse3;
+    }
+  }
+#else
+  Q_UNUSED(isa);
+#endif
+  switch (matType) {
+  case CV_8UC3:
+    return bgrToRgb32RowScalar;
+  case CV_8UC4:
+    return bgraToArgb32PmRowScalar;
+  case CV_8UC1:
+    return grayToRgb32RowScalar;
+  }
+  return nullptr;
+}
+
+detail::YuvRowKernel selectYuvKernel(bool nv12, Isa isa) {
+  using namespace detail;
+#ifdef PIXELCONVERT_X86
+  if (isa == Isa::Avx2) {
+    return nv12 ? nv12ToRgb32RowAvx2 : yuyvToRgb32RowAvx2;
+  }
+  if (isa == Isa::Ssse3) {
+    return nv12 ? nv12ToRgb32RowSsse3 : yuyvToRgb32RowSsse3;
+  }
+#else
+  Q_UNUSED(isa);
+#endif
+  return nv12 ? nv12ToRgb32RowScalar : yuyvToRgb32RowScalar;
+}
+
+// Reparte las filas [0, rows) en franjas entre los hilos de OpenCV si compensa
+template <typename RowRange>
+void forEachStripe(int rows, size_t pixels, bool parallel, const RowRange &convertRows) {
+  const int stripes = std::min(cv::getNumThreads(), std::max(1, rows / kMinRowsPerStripe));
+  if (!parallel || stripes <= 1 || pixels < static_cast<size_t>(kParallelMinPixels)) {
+    convertRows(0, rows);
+    return;
+  }
+  cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range &range) {
+    convertRows(rows * range.start / stripes, rows * range.end / stripes);
+  });
+}
+
+} // namespace
+
+Isa bestIsa() {
+#ifdef PIXELCONVERT_X86
+  static const Isa isa = cv::checkHardwareSupport(CV_CPU_AVX2)    ? Isa::Avx2
+                         : cv::checkHardwareSupport(CV_CPU_SSSE3) ? Isa::Ssse3
+                                                                  : Isa::Scalar;
+  return isa;
+#else
+  return Isa::Scalar;
+#endif
+}
+
+const char *isaName(Isa isa) {
+  switch (isa) {
+  case Isa::Avx2:
+    return "avx2";
+  case Isa::Ssse3:
+    return "ssse3";
+  case Isa::Scalar:
+    break;
+  }
+  return "scalar";
+}
+
+QImage::Format targetFormat(int matType) {
+  switch (matType) {
+  case CV_8UC3:
+  case CV_8UC1:
+    return QImage::Format_RGB32;
+  case CV_8UC4:
+    return QImage::Format_ARGB32_Premultiplied;
+  }
+  return QImage::Format_Invalid;
+}
+
+bool convertToRgb32(const cv::Mat &src, cv::Mat &dst, bool parallel) {
+  return convertToRgb32(src, dst, bestIsa(), parallel);
+}
+
+bool convertToRgb32(const cv::Mat &src, cv::Mat &dst, Isa isa, bool parallel) {
+  const detail::RowKernel kernel = selectKernel(src.type(), isa);
+  if (!kernel || src.empty()) {
+    return false;
+  }
+  dst.create(src.rows, src.cols, CV_8UC4);
+
+  const int width = src.cols;
+  forEachStripe(src.rows, src.total(), parallel, [&](int firstRow, int lastRow) {
+    for (int y = firstRow; y < lastRow; ++y) {
+      kernel(src.ptr<unsigned char>(y), dst.ptr<unsigned char>(y), width);
+    }
+  });
+  return true;
+}
+
+bool yuyvToRgb32(const cv::Mat &src, cv::Mat &dst, bool parallel) {
+  return yuyvToRgb32(src, dst, bestIsa(), parallel);
+}
+
+bool yuyvToRgb32(const cv::Mat &src, cv::Mat &dst, Isa isa, bool parallel) {
+  if (src.empty() || src.type() != CV_8UC2) {
+    return false;
+  }
+  const detail::YuvRowKernel kernel = selectYuvKernel(false, isa);
+  dst.create(src.rows, src.cols, CV_8UC4);
+  const int width = src.cols;
+  forEachStripe(src.rows, src.total(), parallel, [&](int firstRow, int lastRow) {
+    for (int y = firstRow; y < lastRow; ++y) {
+      kernel(src.ptr<unsigned char>(y), nullptr, dst.ptr<unsigned char>(y), width);
+    }
+  });
+  return true;
+}
+
+bool nv12ToRgb32(const cv::Mat &src, cv::Mat &dst, bool parallel) {
+  return nv12ToRgb32(src, dst, bestIsa(), parallel);
+}
+
+bool nv12ToRgb32(const cv::Mat &src, cv::Mat &dst, Isa isa, bool parallel) {
+  if (src.empty() || src.type() != CV_8UC1 || src.rows % 3 != 0) {
+    return false;
+  }
+  const detail::YuvRowKernel kernel = selectYuvKernel(true, isa);
+  const int height = src.rows * 2 / 3;
+  dst.create(height, src.cols, CV_8UC4);
+  const int width = src.cols;
+  forEachStripe(height, size_t(height) * width, parallel, [&](int firstRow, int lastRow) {
+    for (int y = firstRow; y < lastRow; ++y) {
+      // Cada fila del plano UV sirve a dos filas de luma
+      kernel(
+          src.ptr<unsigned char>(y), src.ptr<unsigned char>(height + y / 2),
+          dst.ptr<unsigned char>(y), width);
+    }
+  });
+  return true;
+}
+
+} // namespace PixelConvert
@@ -0,0 +1,39 @@
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+
+#include <QImage>
+#include <opencv2/core.hpp>
+
+// Conversión de frames de OpenCV al formato nativo de 32 bits de Qt en una sola pasada.
+//
+// QImage::Format_RGB32 y Format_ARGB32_Premultiplied guardan cada píxel como B,G,R,A en memoria
+// (little-endian), así que un buffer CV_8UC4 sirve directamente de QImage sin rgbSwapped() ni
+// conversiones posteriores al pintar. El kernel (AVX2, SSSE3 o escalar) se elige en tiempo de
+// ejecución según la CPU.
+namespace PixelConvert {
+
+enum class Isa { Scalar, Ssse3, Avx2 };
+
+Isa bestIsa();
+const char *isaName(Isa isa);
+
+// Formato de QImage que produce convertToRgb32() para un tipo de cv::Mat (Format_Invalid si no se
+// soporta): CV_8UC3 y CV_8UC1 -> Format_RGB32, CV_8UC4 -> Format_ARGB32_Premultiplied
+QImage::Format targetFormat(int matType);
+
+// Convierte BGR, BGRA o GRAY8 a 'dst' (CV_8UC4). Si 'dst' ya tiene el tamaño correcto no se
+// reserva memoria. Con 'parallel' las filas se reparten entre los hilos de OpenCV.
+bool convertToRgb32(const cv::Mat &src, cv::Mat &dst, bool parallel = true);
+bool convertToRgb32(const cv::Mat &src, cv::Mat &dst, Isa isa, bool parallel);
+
+// YUV de la cámara a Format_RGB32 (BT.601, rango limitado) en la misma pasada única.
+// YUYV: CV_8UC2 de ancho x alto (Y0 U Y1 V); NV12: CV_8UC1 de alto * 3 / 2 filas, el plano Y
+// seguido del UV entrelazado a media resolución. 'dst' sale con el tamaño de la imagen.
+bool yuyvToRgb32(const cv::Mat &src, cv::Mat &dst, bool parallel = true);
+bool yuyvToRgb32(const cv::Mat &src, cv::Mat &dst, Isa isa, bool parallel);
+bool nv12ToRgb32(const cv::Mat &src, cv::Mat &dst, bool parallel = true);
+bool nv12ToRgb32(const cv::Mat &src, cv::Mat &dst, Isa isa, bool parallel);
+
+} // namespace PixelConvert
+
+#endif // PIXELCONVERT_H
@@ -0,0 +1,159 @@
+#include "pixelconvert_p.h"
+
+#ifdef PIXELCONVERT_X86
+#include <immintrin.h>
+
+namespace PixelConvert {
+namespace detail {
+
+namespace {
+
+// Carga 8 píxeles BGR: los 4 primeros en la mitad baja y los 4 siguientes en la alta.
+// Cada carga lee 16 bytes aunque solo use 12, así que lee 4 bytes de más al final.
+inline __m256i loadBgr8(const unsigned char *src) {
+  const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+  const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 12));
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+inline __m256i premultiplyLanes(__m256i pixels16, __m256i alphaMask, __m256i colorMask) {
+  const __m256i alpha =
+      _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels16, _MM_SHUFFLE(3, 3, 3, 3)), 0xFF);
+  const __m256i factor = _mm256_or_si256(_mm256_and_si256(alpha, colorMask), alphaMask);
+  __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels16, factor), _mm256_set1_epi16(128));
+  t = _mm256_add_epi16(t, _mm256_srli_epi16(t, 8));
+  return _mm256_srli_epi16(t, 8);
+}
+
+// 16 píxeles YUV en 16 bits (píxeles 0-7 en la mitad baja, 8-15 en la alta) -> B,G,R,0xFF.
+// Igual que storeYuv8() de pixelconvert_ssse3.cpp, con el doble de ancho.
+inline void storeYuv16(__m256i y, __m256i u, __m256i v, unsigned char *dst) {
+  const __m256i luma = _mm256_mulhrs_epi16(
+      _mm256_slli_epi16(_mm256_sub_epi16(y, _mm256_set1_epi16(16)), 7),
+      _mm256_set1_epi16(kYuvLuma));
+  const __m256i cb = _mm256_slli_epi16(_mm256_sub_epi16(u, _mm256_set1_epi16(128)), 7);
+  const __m256i cr = _mm256_slli_epi16(_mm256_sub_epi16(v, _mm256_set1_epi16(128)), 7);
+  const __m256i blue =
+      _mm256_add_epi16(luma, _mm256_mulhrs_epi16(cb, _mm256_set1_epi16(kYuvUToB)));
+  const __m256i green = _mm256_sub_epi16(
+      _mm256_sub_epi16(luma, _mm256_mulhrs_epi16(cb, _mm256_set1_epi16(kYuvUToG))),
+      _mm256_mulhrs_epi16(cr, _mm256_set1_epi16(kYuvVToG)));
+  const __m256i red = _mm256_add_epi16(luma, _mm256_mulhrs_epi16(cr, _mm256_set1_epi16(kYuvVToR)));
+  const __m256i round = _mm256_set1_epi16(16);
+  const __m256i b = _mm256_srai_epi16(_mm256_add_epi16(blue, round), 5);
+  const __m256i g = _mm256_srai_epi16(_mm256_add_epi16(green, round), 5);
+  const __m256i r = _mm256_srai_epi16(_mm256_add_epi16(red, round), 5);
+  const __m256i bg = _mm256_unpacklo_epi8(_mm256_packus_epi16(b, b), _mm256_packus_epi16(g, g));
+  const __m256i ra = _mm256_unpacklo_epi8(_mm256_packus_epi16(r, r), _mm256_set1_epi8(-1));
+  // Cada mitad lleva sus 8 píxeles partidos en lo (0-3, 8-11) y hi (4-7, 12-15)
+  const __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+  const __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+inline void splitChroma(__m256i uv, __m256i &u, __m256i &v) {
+  const __m256i evens = _mm256_setr_epi8(
+      0, 1, 0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12, 13, 12, 13, 0, 1, 0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12,
+      13, 12, 13);
+  u = _mm256_shuffle_epi8(uv, evens);
+  v = _mm256_shuffle_epi8(uv, _mm256_add_epi8(evens, _mm256_set1_epi8(2)));
+}
+
+} // namespace
+
+void bgrToRgb32RowAvx2(const unsigned char *src, unsigned char *dst, int width) {
+  const __m256i expand = _mm256_setr_epi8(
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1,
+      9, 10, 11, -1);
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+  int x = 0;
+  // +2 píxeles de margen para que la última carga de 16 bytes no se salga de la fila
+  for (; x + 34 <= width; x += 32, src += 96, dst += 128) {
+    for (int i = 0; i < 4; ++i) {
+      const __m256i pixels = _mm256_shuffle_epi8(loadBgr8(src + 24 * i), expand);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i *>(dst + 32 * i), _mm256_or_si256(pixels, alpha));
+    }
+  }
+  bgrToRgb32RowSsse3(src, dst, width - x);
+}
+
+void bgraToArgb32PmRowAvx2(const unsigned char *src, unsigned char *dst, int width) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i alphaMask =
+      _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+  const __m256i colorMask =
+      _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+  int x = 0;
+  for (; x + 8 <= width; x += 8, src += 32, dst += 32) {
+    const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+    // unpack y packus trabajan por mitades de 128 bits, así que el orden se conserva
+    const __m256i lo =
+        premultiplyLanes(_mm256_unpacklo_epi8(pixels, zero), alphaMask, colorMask);
+    const __m256i hi =
+        premultiplyLanes(_mm256_unpackhi_epi8(pixels, zero), alphaMask, colorMask);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_packus_epi16(lo, hi));
+  }
+  bgraToArgb32PmRowSsse3(src, dst, width - x);
+}
+
+void grayToRgb32RowAvx2(const unsigned char *src, unsigned char *dst, int width) {
+  const __m256i expandLow = _mm256_setr_epi8(
+      0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1, 4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7,
+      7, 7, -1);
+  const __m256i expandHigh = _mm256_setr_epi8(
+      8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1, 12, 12, 12, -1, 13, 13, 13, -1, 14,
+      14, 14, -1, 15, 15, 15, -1);
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+  int x = 0;
+  for (; x + 16 <= width; x += 16, src += 16, dst += 64) {
+    const __m256i g = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst),
+        _mm256_or_si256(_mm256_shuffle_epi8(g, expandLow), alpha));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst + 32),
+        _mm256_or_si256(_mm256_shuffle_epi8(g, expandHigh), alpha));
+  }
+  grayToRgb32RowSsse3(src, dst, width - x);
+}
+
+void yuyvToRgb32RowAvx2(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width) {
+  const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+  int x = 0;
+  for (; x + 16 <= width; x += 16, luma += 32, dst += 64) {
+    // shuffle_epi8 no cruza mitades, pero cada mitad lleva sus parejas Y0 U Y1 V completas
+    const __m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(luma));
+    __m256i u;
+    __m256i v;
+    splitChroma(_mm256_srli_epi16(packed, 8), u, v);
+    storeYuv16(_mm256_and_si256(packed, lowBytes), u, v, dst);
+  }
+  yuyvToRgb32RowSsse3(luma, chroma, dst, width - x);
+}
+
+void nv12ToRgb32RowAvx2(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16, luma += 16, chroma += 16, dst += 64) {
+    const __m256i y =
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(luma)));
+    const __m256i uv =
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(chroma)));
+    __m256i u;
+    __m256i v;
+    splitChroma(uv, u, v);
+    storeYuv16(y, u, v, dst);
+  }
+  nv12ToRgb32RowSsse3(luma, chroma, dst, width - x);
+}
+
+} // namespace detail
+} // namespace PixelConvert
+
+#endif // PIXELCONVERT_X86
@@ -0,0 +1,82 @@
+#ifndef PIXELCONVERT_P_H
+#define PIXELCONVERT_P_H
+
+// Kernels por fila de pixelconvert. Cada variante vive en su propio fichero para poder compilarlo
+// con las opciones de su juego de instrucciones (-mssse3, -mavx2) sin afectar al resto.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXELCONVERT_X86 1
+#endif
+
+namespace PixelConvert {
+namespace detail {
+
+using RowKernel = void (*)(const unsigned char *src, unsigned char *dst, int width);
+// Fila de YUV: en YUYV 'luma' es la fila empaquetada y 'chroma' no se usa; en NV12 son la fila del
+// plano Y y la del plano UV que le corresponde
+using YuvRowKernel = void (*)(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width);
+
+void bgrToRgb32RowScalar(const unsigned char *src, unsigned char *dst, int width);
+void bgraToArgb32PmRowScalar(const unsigned char *src, unsigned char *dst, int width);
+void grayToRgb32RowScalar(const unsigned char *src, unsigned char *dst, int width);
+void yuyvToRgb32RowScalar(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width);
+void nv12ToRgb32RowScalar(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width);
+
+#ifdef PIXELCONVERT_X86
+void bgrToRgb32RowSsse3(const unsigned char *src, unsigned char *dst, int width);
+void bgraToArgb32PmRowSsse3(const unsigned char *src, unsigned char *dst, int width);
+void grayToRgb32RowSsse3(const unsigned char *src, unsigned char *dst, int width);
+void yuyvToRgb32RowSsse3(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width);
+void nv12ToRgb32RowSsse3(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width);
+
+void bgrToRgb32RowAvx2(const unsigned char *src, unsigned char *dst, int width);
+void bgraToArgb32PmRowAvx2(const unsigned char *src, unsigned char *dst, int width);
+void grayToRgb32RowAvx2(const unsigned char *src, unsigned char *dst, int width);
+void yuyvToRgb32RowAvx2(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width);
+void nv12ToRgb32RowAvx2(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width);
+#endif
+
+// c * a / 255 redondeado, igual que hacen los kernels SIMD
+inline unsigned char premultiply(unsigned int c, unsigned int a) {
+  const unsigned int t = c * a + 128;
+  return static_cast<unsigned char>((t + (t >> 8)) >> 8);
+}
+
+// YUV -> RGB con BT.601 de rango limitado en punto fijo de 16 bits, con los mismos pasos que
+// _mm_mulhrs_epi16 para que escalar y SIMD den exactamente lo mismo. Se trabaja en 1/32 de nivel:
+// Y' = 1.164 (Y - 16), R = Y' + 1.596 V', G = Y' - 0.391 U' - 0.813 V', B = Y' + 2.018 U'
+// (U' y V' centrados en 0). Ningún término intermedio se sale de int16.
+constexpr int kYuvLuma = 9535;  // 1.164 * 32 * 256
+constexpr int kYuvVToR = 13074; // 1.596 * 32 * 256
+constexpr int kYuvUToG = 3203;  // 0.391 * 32 * 256
+constexpr int kYuvVToG = 6660;  // 0.813 * 32 * 256
+constexpr int kYuvUToB = 16531; // 2.018 * 32 * 256
+
+inline int mulhrs(int a, int b) { return (a * b + 0x4000) >> 15; }
+
+inline unsigned char clampYuv(int value) {
+  value = (value + 16) >> 5;
+  return static_cast<unsigned char>(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+inline void yuvToRgb32(int y, int u, int v, unsigned char *dst) {
+  const int luma = mulhrs((y - 16) * 128, kYuvLuma);
+  const int cb = (u - 128) * 128;
+  const int cr = (v - 128) * 128;
+  dst[0] = clampYuv(luma + mulhrs(cb, kYuvUToB));
+  dst[1] = clampYuv(luma - mulhrs(cb, kYuvUToG) - mulhrs(cr, kYuvVToG));
+  dst[2] = clampYuv(luma + mulhrs(cr, kYuvVToR));
+  dst[3] = 0xFF;
+}
+
+} // namespace detail
+} // namespace PixelConvert
+
+#endif // PIXELCONVERT_P_H
@@ -0,0 +1,141 @@
+#include "pixelconvert_p.h"
+
+#ifdef PIXELCONVERT_X86
+#include <tmmintrin.h>
+
+namespace PixelConvert {
+namespace detail {
+
+namespace {
+
+// Multiplica B,G,R por A (y A por 255, que la deja igual) en 2 píxeles de 16 bits por canal
+inline __m128i premultiplyLanes(__m128i pixels16, __m128i alphaMask, __m128i colorMask) {
+  const __m128i alpha =
+      _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels16, _MM_SHUFFLE(3, 3, 3, 3)), 0xFF);
+  const __m128i factor = _mm_or_si128(_mm_and_si128(alpha, colorMask), alphaMask);
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels16, factor), _mm_set1_epi16(128));
+  t = _mm_add_epi16(t, _mm_srli_epi16(t, 8));
+  return _mm_srli_epi16(t, 8);
+}
+
+// 8 píxeles YUV (Y, U y V ya en 16 bits, U y V repetidos por pareja) -> 8 píxeles B,G,R,0xFF.
+// Los mismos pasos que yuvToRgb32() en pixelconvert_p.h.
+inline void storeYuv8(__m128i y, __m128i u, __m128i v, unsigned char *dst) {
+  const __m128i luma = _mm_mulhrs_epi16(
+      _mm_slli_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), 7), _mm_set1_epi16(kYuvLuma));
+  const __m128i cb = _mm_slli_epi16(_mm_sub_epi16(u, _mm_set1_epi16(128)), 7);
+  const __m128i cr = _mm_slli_epi16(_mm_sub_epi16(v, _mm_set1_epi16(128)), 7);
+  const __m128i blue = _mm_add_epi16(luma, _mm_mulhrs_epi16(cb, _mm_set1_epi16(kYuvUToB)));
+  const __m128i green = _mm_sub_epi16(
+      _mm_sub_epi16(luma, _mm_mulhrs_epi16(cb, _mm_set1_epi16(kYuvUToG))),
+      _mm_mulhrs_epi16(cr, _mm_set1_epi16(kYuvVToG)));
+  const __m128i red = _mm_add_epi16(luma, _mm_mulhrs_epi16(cr, _mm_set1_epi16(kYuvVToR)));
+  // Redondeo y vuelta a niveles enteros; packus satura a 0..255 como clampYuv()
+  const __m128i round = _mm_set1_epi16(16);
+  const __m128i b = _mm_srai_epi16(_mm_add_epi16(blue, round), 5);
+  const __m128i g = _mm_srai_epi16(_mm_add_epi16(green, round), 5);
+  const __m128i r = _mm_srai_epi16(_mm_add_epi16(red, round), 5);
+  const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+  const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_set1_epi8(-1));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(bg, ra));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+// De U0 V0 U1 V1 ... en 16 bits a U0 U0 U1 U1 ... y V0 V0 V1 V1 ...
+inline void splitChroma(__m128i uv, __m128i &u, __m128i &v) {
+  u = _mm_shuffle_epi8(uv, _mm_setr_epi8(0, 1, 0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12, 13, 12, 13));
+  v = _mm_shuffle_epi8(uv, _mm_setr_epi8(2, 3, 2, 3, 6, 7, 6, 7, 10, 11, 10, 11, 14, 15, 14, 15));
+}
+
+} // namespace
+
+void bgrToRgb32RowSsse3(const unsigned char *src, unsigned char *dst, int width) {
+  // 4 píxeles de 3 bytes -> 4 píxeles de 4 bytes; el cuarto byte se rellena con 0xFF
+  const __m128i expand = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  int x = 0;
+  for (; x + 16 <= width; x += 16, src += 48, dst += 64) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+    const __m128i p0 = _mm_shuffle_epi8(a, expand);
+    const __m128i p1 = _mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), expand);
+    const __m128i p2 = _mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), expand);
+    const __m128i p3 = _mm_shuffle_epi8(_mm_srli_si128(c, 4), expand);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_or_si128(p0, alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_or_si128(p1, alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 32), _mm_or_si128(p2, alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 48), _mm_or_si128(p3, alpha));
+  }
+  bgrToRgb32RowScalar(src, dst, width - x);
+}
+
+void bgraToArgb32PmRowSsse3(const unsigned char *src, unsigned char *dst, int width) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alphaMask = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+  const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+  int x = 0;
+  for (; x + 4 <= width; x += 4, src += 16, dst += 16) {
+    const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    const __m128i lo = premultiplyLanes(_mm_unpacklo_epi8(pixels, zero), alphaMask, colorMask);
+    const __m128i hi = premultiplyLanes(_mm_unpackhi_epi8(pixels, zero), alphaMask, colorMask);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(lo, hi));
+  }
+  bgraToArgb32PmRowScalar(src, dst, width - x);
+}
+
+void grayToRgb32RowSsse3(const unsigned char *src, unsigned char *dst, int width) {
+  const __m128i expand0 = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+  const __m128i expand1 = _mm_setr_epi8(4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+  const __m128i expand2 = _mm_setr_epi8(8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1);
+  const __m128i expand3 =
+      _mm_setr_epi8(12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  int x = 0;
+  for (; x + 16 <= width; x += 16, src += 16, dst += 64) {
+    const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(dst), _mm_or_si128(_mm_shuffle_epi8(g, expand0), alpha));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(dst + 16), _mm_or_si128(_mm_shuffle_epi8(g, expand1), alpha));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(dst + 32), _mm_or_si128(_mm_shuffle_epi8(g, expand2), alpha));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(dst + 48), _mm_or_si128(_mm_shuffle_epi8(g, expand3), alpha));
+  }
+  grayToRgb32RowScalar(src, dst, width - x);
+}
+
+void yuyvToRgb32RowSsse3(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width) {
+  const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+  int x = 0;
+  for (; x + 8 <= width; x += 8, luma += 16, dst += 32) {
+    const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(luma));
+    __m128i u;
+    __m128i v;
+    splitChroma(_mm_srli_epi16(packed, 8), u, v);
+    storeYuv8(_mm_and_si128(packed, lowBytes), u, v, dst);
+  }
+  yuyvToRgb32RowScalar(luma, chroma, dst, width - x);
+}
+
+void nv12ToRgb32RowSsse3(
+    const unsigned char *luma, const unsigned char *chroma, unsigned char *dst, int width) {
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+  for (; x + 8 <= width; x += 8, luma += 8, chroma += 8, dst += 32) {
+    const __m128i y = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(luma));
+    const __m128i uv = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(chroma));
+    __m128i u;
+    __m128i v;
+    splitChroma(_mm_unpacklo_epi8(uv, zero), u, v);
+    storeYuv8(_mm_unpacklo_epi8(y, zero), u, v, dst);
+  }
+  nv12ToRgb32RowScalar(luma, chroma, dst, width - x);
+}
+
+} // namespace detail
+} // namespace PixelConvert
+
+#endif // PIXELCONVERT_X86
@@ -0,0 +1,272 @@
+#include "pretriggerbuffer.h"
+#include "mjpeg.h"
+#include <QDebug>
+#include <QDir>
+#include <QTemporaryFile>
+#include <chrono>
+#include <cstring>
+#include <opencv2/imgcodecs.hpp>
+
+namespace {
+
+// Margen tras el final del clip para los frames capturados antes que aún estén en la cola
+constexpr qint64 kExportGraceNs = 1000000000;
+
+} // namespace
+
+PreTriggerBuffer::PreTriggerBuffer(const Config &config) : m_config(config) {}
+
+PreTriggerBuffer::~PreTriggerBuffer() { close(); }
+
+bool PreTriggerBuffer::open(const cv::Size &size, int type, double fps) {
+  Q_UNUSED(size);
+  Q_UNUSED(type);
+  if (m_map) {
+    return true;
+  }
+  if (m_config.path.isEmpty()) {
+    m_file = std::make_unique<QTemporaryFile>(QDir::tempPath() + "/pretrigger_XXXXXX.bin");
+    if (!static_cast<QTemporaryFile *>(m_file.get())->open()) {
+      qWarning() << "PreTriggerBuffer::open() - No se pudo crear el fichero temporal";
+      return false;
+    }
+  } else {
+    m_file = std::make_unique<QFile>(m_config.path);
+    if (!m_file->open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+      qWarning() << "PreTriggerBuffer::open() - No se pudo crear" << m_config.path;
+      return false;
+    }
+  }
+
+  // El fichero queda disperso: el disco solo se ocupa a medida que se escribe
+  m_capacity = qMax<qint64>(1 << 20, m_config.maxBytes);
+  if (!m_file->resize(m_capacity) || !(m_map = m_file->map(0, m_capacity))) {
+    qWarning() << "PreTriggerBuffer::open() - No se pudo proyectar" << m_file->fileName();
+    m_file.reset();
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_fps = fps > 0 ? fps : 30;
+  m_records.clear();
+  m_writeOffset = 0;
+  m_bytesUsed = 0;
+  m_closing = false;
+  return true;
+}
+
+void PreTriggerBuffer::close() {
+  std::thread exportThread;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closing = true;
+    exportThread = std::move(m_exportThread);
+  }
+  m_written.notify_all();
+  // El volcado en curso termina con lo que ya tenga
+  if (exportThread.joinable()) {
+    exportThread.join();
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_records.clear();
+  m_bytesUsed = 0;
+  m_clip.reset();
+  if (m_map) {
+    m_file->unmap(m_map);
+    m_map = nullptr;
+  }
+  m_file.reset(); // Un QTemporaryFile se borra aquí
+}
+
+QString PreTriggerBuffer::description() const {
+  return m_file ? m_file->fileName() : QStringLiteral("pre-grabación");
+}
+
+bool PreTriggerBuffer::write(const CapturedFrame &frame) {
+  if (!m_map) {
+    return false;
+  }
+
+  // La compresión se hace fuera del mutex: el volcado puede seguir leyendo mientras tanto
+  const uchar *data = nullptr;
+  qint64 size = 0;
+  int storedType = frame.image.type();
+  cv::Size frameSize = frame.image.size();
+  if (frame.encoding == FrameEncoding::Mjpeg) {
+    // Ya viene comprimido de la cámara: se guarda tal cual, sin volver a codificar
+    if (!frame.image.isContinuous()) {
+      return false;
+    }
+    data = frame.image.data;
+    size = static_cast<qint64>(frame.image.total() * frame.image.elemSize());
+    storedType = CV_8UC3;
+    frameSize = Mjpeg::peekSize(frame.image);
+  } else if (m_config.storage == Storage::Mjpeg) {
+    if (!cv::imencode(
+            ".jpg", frame.image, m_encoded, {cv::IMWRITE_JPEG_QUALITY, m_config.jpegQuality})) {
+      return false;
+    }
+    data = m_encoded.data();
+    size = static_cast<qint64>(m_encoded.size());
+    storedType = frame.image.channels() == 1 ? CV_8UC1 : CV_8UC3;
+  } else {
+    if (!frame.image.isContinuous()) {
+      return false;
+    }
+    data = frame.image.data;
+    size = static_cast<qint64>(frame.image.total() * frame.image.elemSize());
+  }
+  if (size <= 0 || size > m_capacity) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    qint64 offset = m_writeOffset;
+    if (offset + size > m_capacity) {
+      // No cabe al final: se vuelve al principio y lo que queda al final es lo más antiguo
+      while (!m_records.empty() && m_records.front().offset >= m_writeOffset) {
+        m_bytesUsed -= m_records.front().size;
+        m_records.pop_front();
+      }
+      offset = 0;
+    }
+    evictLocked(offset, size, frame.captureTimeNs);
+    std::memcpy(m_map + offset, data, static_cast<size_t>(size));
+
+    Record record;
+    record.id = m_nextId++;
+    record.offset = offset;
+    record.size = size;
+    record.captureTimeNs = frame.captureTimeNs;
+    record.sequence = frame.sequence;
+    record.frameSize = frameSize;
+    record.type = storedType;
+    m_records.push_back(record);
+    m_writeOffset = offset + size;
+    m_bytesUsed += size;
+  }
+  m_written.notify_all();
+  return true;
+}
+
+void PreTriggerBuffer::evictLocked(qint64 offset, qint64 size, qint64 newestNs) {
+  // Los registros siguen el orden del fichero a partir del más antiguo, así que solo el primero
+  // puede solaparse con la zona que se va a escribir
+  const qint64 windowNs = static_cast<qint64>(m_config.seconds * 1e9);
+  while (!m_records.empty()) {
+    const Record &oldest = m_records.front();
+    const bool overlaps = oldest.offset < offset + size && oldest.offset + oldest.size > offset;
+    const bool expired = newestNs - oldest.captureTimeNs > windowNs;
+    if (!overlaps && !expired) {
+      break;
+    }
+    m_bytesUsed -= oldest.size;
+    m_records.pop_front();
+  }
+}
+
+bool PreTriggerBuffer::trigger(std::unique_ptr<FrameSink> clip, double postSeconds) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_exporting || m_closing || m_records.empty() || !clip) {
+    return false;
+  }
+  if (m_exportThread.joinable()) {
+    m_exportThread.join(); // Volcado anterior ya terminado
+  }
+  m_clip = std::move(clip);
+  m_exporting = true;
+  m_exported = 0;
+  m_exportSkipped = 0;
+  const qint64 endNs = monotonicNowNs() + static_cast<qint64>(qMax(0.0, postSeconds) * 1e9);
+  m_exportThread = std::thread([this, endNs] { exportLoop(m_clip.get(), endNs); });
+  return true;
+}
+
+void PreTriggerBuffer::exportLoop(FrameSink *clip, qint64 endNs) {
+  bool opened = false;
+  bool written = false;
+  CapturedFrame frame;
+  std::vector<uchar> encoded;
+  const Storage storage = m_config.storage;
+
+  // Mismo reloj que monotonicNowNs()
+  const std::chrono::steady_clock::time_point deadline{
+      std::chrono::nanoseconds(endNs + kExportGraceNs)};
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const double fps = m_fps;
+  quint64 id = m_records.front().id;
+  for (;; ++id) {
+    if (written) {
+      ++m_exported;
+    }
+    // Esperar a que el frame exista; los anteriores a trigger() ya están. Si la captura se para
+    // (cámara detenida o desconectada, origen estático) no llega ninguno posterior a endNs: el
+    // clip se cierra igualmente al pasar el plazo
+    const bool available = m_written.wait_until(
+        lock, deadline, [this, id] { return m_closing || id < m_nextId; });
+    if (!available || id >= m_nextId || m_records.empty()) {
+      break;
+    }
+    if (id < m_records.front().id) {
+      // El volcado va más lento que la escritura y esos frames ya se han sobrescrito
+      m_exportSkipped += m_records.front().id - id;
+      id = m_records.front().id;
+    }
+    const Record record = m_records[static_cast<size_t>(id - m_records.front().id)];
+    if (record.captureTimeNs > endNs) {
+      break;
+    }
+
+    // Copia bajo el mutex (la zona se puede sobrescribir después); decodificación fuera
+    if (storage == Storage::Raw) {
+      frame.image.create(record.frameSize, record.type);
+      std::memcpy(frame.image.data, m_map + record.offset, static_cast<size_t>(record.size));
+    } else {
+      encoded.assign(m_map + record.offset, m_map + record.offset + record.size);
+    }
+    lock.unlock();
+
+    if (storage == Storage::Mjpeg) {
+      cv::imdecode(encoded, cv::IMREAD_UNCHANGED, &frame.image);
+    }
+    frame.sequence = record.sequence;
+    frame.captureTimeNs = record.captureTimeNs;
+    written = false;
+    if (!frame.image.empty()) {
+      if (!opened) {
+        opened = clip->open(frame.image.size(), frame.image.type(), fps);
+        if (!opened) {
+          qWarning() << "PreTriggerBuffer - No se pudo abrir el clip" << clip->description();
+          lock.lock();
+          break;
+        }
+      }
+      written = clip->write(frame);
+    }
+    lock.lock();
+  }
+  lock.unlock();
+
+  if (opened) {
+    clip->close();
+  }
+  lock.lock();
+  m_exporting = false;
+}
+
+PreTriggerBuffer::Stats PreTriggerBuffer::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Stats stats;
+  stats.frames = static_cast<int>(m_records.size());
+  if (!m_records.empty()) {
+    stats.seconds = (m_records.back().captureTimeNs - m_records.front().captureTimeNs) / 1e9;
+  }
+  stats.bytesUsed = m_bytesUsed;
+  stats.capacityBytes = m_capacity;
+  stats.exporting = m_exporting;
+  stats.exported = m_exported;
+  stats.exportSkipped = m_exportSkipped;
+  return stats;
+}
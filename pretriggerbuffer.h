@@ -0,0 +1,96 @@
+#ifndef PRETRIGGERBUFFER_H
+#define PRETRIGGERBUFFER_H
+
+#include "framesink.h"
+#include <QFile>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Almacén circular de los últimos segundos de vídeo para grabar incidentes "hacia atrás".
+//
+// Se alimenta como cualquier FrameSink (a través de un FrameRecorder, fuera del hilo de captura) y
+// guarda los frames en un fichero proyectado en memoria del tamaño del presupuesto: la memoria
+// queda acotada y es el sistema operativo quien decide qué páginas mantener en RAM. Los frames
+// más antiguos se descartan al pasar del límite de segundos o de bytes. Con Storage::Mjpeg cada
+// frame se guarda comprimido en JPEG, con lo que caben muchos más segundos en el mismo espacio.
+//
+// trigger() vuelca a un clip todo lo almacenado más los 'postSeconds' siguientes. El volcado corre
+// en su propio hilo, persiguiendo a la escritura, así que la captura y el llenado no se detienen.
+class PreTriggerBuffer : public FrameSink {
+public:
+  enum class Storage { Raw, Mjpeg };
+
+  struct Config {
+    double seconds = 10;
+    qint64 maxBytes = qint64(512) << 20;
+    Storage storage = Storage::Mjpeg;
+    int jpegQuality = 85;
+    QString path; // Vacío = fichero temporal que se borra al cerrar
+  };
+
+  struct Stats {
+    int frames = 0;
+    double seconds = 0;
+    qint64 bytesUsed = 0;
+    qint64 capacityBytes = 0;
+    bool exporting = false;
+    quint64 exported = 0;      // Frames escritos en el último clip
+    quint64 exportSkipped = 0; // Frames sobrescritos antes de poder volcarlos
+  };
+
+  explicit PreTriggerBuffer(const Config &config);
+  ~PreTriggerBuffer() override;
+
+  // --- FrameSink (hilo del FrameRecorder) ---
+  bool open(const cv::Size &size, int type, double fps) override;
+  bool write(const CapturedFrame &frame) override;
+  void close() override;
+  QString description() const override;
+  bool acceptsMjpeg() const override { return m_config.storage == Storage::Mjpeg; }
+
+  // --- Desde cualquier hilo ---
+  // false si aún no hay nada almacenado o ya hay un volcado en marcha
+  bool trigger(std::unique_ptr<FrameSink> clip, double postSeconds);
+  Stats stats() const;
+
+private:
+  struct Record {
+    quint64 id = 0;
+    qint64 offset = 0;
+    qint64 size = 0;
+    qint64 captureTimeNs = 0;
+    quint64 sequence = 0;
+    cv::Size frameSize;
+    int type = 0;
+  };
+
+  void evictLocked(qint64 offset, qint64 size, qint64 newestNs);
+  void exportLoop(FrameSink *clip, qint64 endNs);
+
+  const Config m_config;
+  std::unique_ptr<QFile> m_file;
+  uchar *m_map{nullptr};
+  qint64 m_capacity{0};
+  double m_fps{30};
+  std::vector<uchar> m_encoded; // Solo lo usa write()
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_written;
+  std::deque<Record> m_records; // Del más antiguo al más reciente
+  quint64 m_nextId{0};
+  qint64 m_writeOffset{0};
+  qint64 m_bytesUsed{0};
+  bool m_closing{false};
+
+  std::unique_ptr<FrameSink> m_clip;
+  std::thread m_exportThread;
+  bool m_exporting{false};
+  quint64 m_exported{0};
+  quint64 m_exportSkipped{0};
+};
+
+#endif // PRETRIGGERBUFFER_H
@@ -0,0 +1,202 @@
+#include "sharedframeclient.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+using namespace SharedFrames;
+
+namespace {
+
+// Intentos de leer un frame antes de rendirse si el productor lo sobrescribe mientras tanto
+constexpr int kReadAttempts = 4;
+
+} // namespace
+
+SharedFrameClient::SharedFrameClient(std::string name) : m_name(std::move(name)) {}
+
+SharedFrameClient::~SharedFrameClient() { close(); }
+
+bool SharedFrameClient::open() {
+  close();
+  const int fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  void *map = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(RingHeader)) {
+    map = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd); // La proyección sigue valiendo sin el descriptor
+  if (map == MAP_FAILED) {
+    return false;
+  }
+
+  auto *ring = static_cast<RingHeader *>(map);
+  // El productor escribe 'magic' el último: si no está, aún está preparando el segmento
+  const bool valid = ring->magic == kMagic && ring->version == kVersion && ring->slotCount > 1 &&
+                     ring->slotStride == slotStrideFor(ring->slotCapacity) &&
+                     segmentSize(ring->slotCount, ring->slotCapacity) <= uint64_t(info.st_size);
+  if (!valid) {
+    munmap(map, size_t(info.st_size));
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  m_ring = ring;
+  m_size = size_t(info.st_size);
+  // Se empieza por lo que se publique a partir de ahora
+  m_last = m_ring->published.load(std::memory_order_acquire);
+  return true;
+}
+
+void SharedFrameClient::close() {
+  if (m_ring) {
+    munmap(m_ring, m_size);
+    m_ring = nullptr;
+    m_size = 0;
+  }
+}
+
+bool SharedFrameClient::ensureOpen() {
+  if (m_ring && m_ring->closed.load(std::memory_order_acquire)) {
+    close(); // El productor lo ha dejado; puede que ya haya otro con el mismo nombre
+  }
+  return m_ring || open();
+}
+
+bool SharedFrameClient::read(uint64_t number, Frame &frame) {
+  const SlotHeader *slot = slotAt(m_ring, number);
+  const uint64_t version = slot->version.load(std::memory_order_acquire);
+  if ((version & 1) != 0 || slot->frameNumber != number || slot->bytes > m_ring->slotCapacity) {
+    return false;
+  }
+  frame.data = slotData(slot);
+  frame.bytes = size_t(slot->bytes);
+  frame.width = slot->width;
+  frame.height = slot->height;
+  frame.stride = slot->stride;
+  frame.format = slot->format;
+  frame.number = number;
+  frame.sequence = slot->sequence;
+  frame.captureTimeNs = slot->captureTimeNs;
+  frame.slot = slot;
+  frame.version = version;
+  return isValid(frame);
+}
+
+bool SharedFrameClient::next(Frame &frame) {
+  if (!ensureOpen()) {
+    return false;
+  }
+  for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+    const uint64_t published = m_ring->published.load(std::memory_order_acquire);
+    if (published <= m_last) {
+      return false;
+    }
+    // El slot del frame published + 1 puede estar escribiéndose ya: lo que comparta slot con él
+    // se da por perdido y se salta al más reciente
+    uint64_t number = m_last + 1;
+    if (published - number + 1 >= m_ring->slotCount) {
+      number = published;
+    }
+    if (read(number, frame)) {
+      m_skipped += number - m_last - 1;
+      m_last = number;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SharedFrameClient::waitNext(Frame &frame, int timeoutMs) {
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+  for (;;) {
+    const bool open = ensureOpen();
+    const uint32_t seen = open ? m_ring->notify.load(std::memory_order_acquire) : 0;
+    if (open && next(frame)) {
+      return true;
+    }
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    if (remaining <= 0) {
+      return false;
+    }
+    if (open) {
+      wait(seen, int(remaining));
+    } else {
+      // Sin productor todavía: se vuelve a intentar abrir de vez en cuando
+      std::this_thread::sleep_for(std::chrono::milliseconds(std::min<long long>(remaining, 50)));
+    }
+  }
+}
+
+void SharedFrameClient::wait(uint32_t seen, int timeoutMs) {
+#if defined(__linux__)
+  // Futex compartido entre procesos: el productor despierta a todos con cada frame
+  struct timespec timeout;
+  timeout.tv_sec = timeoutMs / 1000;
+  timeout.tv_nsec = long(timeoutMs % 1000) * 1000000;
+  syscall(SYS_futex, &m_ring->notify, FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+  // Sin futex: sondeo corto
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  while (m_ring->notify.load(std::memory_order_acquire) == seen &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+#endif
+}
+
+bool SharedFrameClient::latest(Frame &frame) {
+  if (!ensureOpen()) {
+    return false;
+  }
+  for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+    const uint64_t published = m_ring->published.load(std::memory_order_acquire);
+    if (published == 0) {
+      return false;
+    }
+    if (read(published, frame)) {
+      if (published > m_last) {
+        m_skipped += published - m_last - 1;
+        m_last = published;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SharedFrameClient::isValid(const Frame &frame) const {
+  if (!m_ring || !frame.slot) {
+    return false;
+  }
+  // Cierre del seqlock: las lecturas de los píxeles no pueden pasar de aquí
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return frame.slot->version.load(std::memory_order_relaxed) == frame.version;
+}
+
+bool SharedFrameClient::copy(Frame &frame, std::vector<uint8_t> &buffer) const {
+  if (!frame.slot) {
+    return false;
+  }
+  buffer.resize(frame.bytes);
+  std::memcpy(buffer.data(), slotData(frame.slot), frame.bytes);
+  if (!isValid(frame)) {
+    return false;
+  }
+  frame.data = buffer.data();
+  return true;
+}
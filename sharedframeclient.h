@@ -0,0 +1,82 @@
+#ifndef SHAREDFRAMECLIENT_H
+#define SHAREDFRAMECLIENT_H
+
+#include "sharedframelayout.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Lector del anillo de frames que publica SharedFramePublisher, para otros procesos del mismo
+// equipo. Proyecta el segmento de memoria compartida en solo lectura y entrega punteros a los
+// píxeles dentro de él, sin copiar ni bloquear al productor. Solo POSIX; sin Qt ni OpenCV.
+//
+//   SharedFrameClient client("/opencvtest");
+//   SharedFrameClient::Frame frame;
+//   while (client.waitNext(frame, 1000)) {
+//     procesar(frame.data, frame.width, frame.height, frame.stride);
+//     if (!client.isValid(frame)) {
+//       // El productor dio la vuelta al anillo mientras tanto: el resultado no vale
+//     }
+//   }
+//
+// Un frame sigue siendo válido hasta que el productor da la vuelta al anillo (slotCount - 1
+// frames después). Quien necesite más tiempo puede usar copy(), que copia y valida de una vez.
+// Cada objeto es de un solo hilo; varios procesos o hilos pueden leer a la vez con el suyo.
+class SharedFrameClient {
+public:
+  struct Frame {
+    const uint8_t *data = nullptr;
+    size_t bytes = 0;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    uint32_t format = 0; // SharedFrames::kFormat*
+    uint64_t number = 0; // Número de publicación
+    uint64_t sequence = 0;
+    int64_t captureTimeNs = 0;
+
+  private:
+    friend class SharedFrameClient;
+    const SharedFrames::SlotHeader *slot = nullptr;
+    uint64_t version = 0;
+  };
+
+  explicit SharedFrameClient(std::string name);
+  ~SharedFrameClient();
+  SharedFrameClient(const SharedFrameClient &) = delete;
+  SharedFrameClient &operator=(const SharedFrameClient &) = delete;
+
+  // false si el productor aún no ha creado el segmento. next() y waitNext() abren solos.
+  bool open();
+  void close();
+  bool isOpen() const { return m_ring != nullptr; }
+
+  // Frame siguiente al último leído. Si el productor ya lo ha sobrescrito se salta al más
+  // reciente y los perdidos se suman a skipped(). false si no hay ninguno nuevo.
+  bool next(Frame &frame);
+  // Como next(), pero espera hasta 'timeoutMs' a que se publique uno
+  bool waitNext(Frame &frame, int timeoutMs);
+  // El último publicado, aunque ya se haya leído
+  bool latest(Frame &frame);
+
+  // true si los píxeles de 'frame' no se han sobrescrito desde que se obtuvo
+  bool isValid(const Frame &frame) const;
+  // Copia los píxeles a 'buffer' (y deja frame.data apuntando a él); false si no dio tiempo
+  bool copy(Frame &frame, std::vector<uint8_t> &buffer) const;
+
+  uint64_t skipped() const { return m_skipped; }
+
+private:
+  bool ensureOpen();
+  bool read(uint64_t number, Frame &frame);
+  void wait(uint32_t seen, int timeoutMs);
+
+  std::string m_name;
+  SharedFrames::RingHeader *m_ring = nullptr;
+  size_t m_size = 0;
+  uint64_t m_last = 0;
+  uint64_t m_skipped = 0;
+};
+
+#endif // SHAREDFRAMECLIENT_H
@@ -0,0 +1,98 @@
+#ifndef SHAREDFRAMELAYOUT_H
+#define SHAREDFRAMELAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Formato en memoria del anillo de frames compartido entre procesos (SharedFramePublisher escribe,
+// SharedFrameClient lee). Solo C++ estándar: lo incluyen también clientes sin Qt ni OpenCV.
+//
+//   [RingHeader][slot 0][slot 1]...[slot n-1]
+//   slot = [SlotHeader][píxeles, slotCapacity bytes]
+//
+// Cada slot es un seqlock: el productor pone 'version' impar antes de escribir y par al terminar.
+// Un lector anota la versión, lee, y la vuelve a comprobar; si ha cambiado, el productor lo
+// sobrescribió mientras tanto y lo leído no vale. El productor nunca espera a nadie.
+namespace SharedFrames {
+
+constexpr uint32_t fourcc(char a, char b, char c, char d) {
+  return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) |
+         (uint32_t(uint8_t(d)) << 24);
+}
+
+constexpr uint32_t kMagic = fourcc('O', 'C', 'V', 'R');
+constexpr uint32_t kVersion = 1;
+
+// Mismos códigos que V4L2
+constexpr uint32_t kFormatGray8 = fourcc('G', 'R', 'E', 'Y');
+constexpr uint32_t kFormatBgr24 = fourcc('B', 'G', 'R', '3');
+constexpr uint32_t kFormatBgra32 = fourcc('B', 'G', 'R', '4');
+
+constexpr size_t kAlignment = 64; // Una línea de caché: cabeceras y píxeles no se solapan
+
+struct alignas(kAlignment) RingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slotCount;
+  uint32_t producerPid;
+  uint64_t slotStride;   // Bytes entre el principio de un slot y el siguiente
+  uint64_t slotCapacity; // Bytes de píxeles que caben en cada slot
+  // El productor ha cerrado o rehecho el segmento (p. ej. por un frame más grande): hay que
+  // volver a abrirlo por el nombre
+  std::atomic<uint32_t> closed;
+  // Sube con cada frame y al cerrar; los clientes esperan sobre él (futex en Linux), así que
+  // pueden proyectar el segmento en solo lectura
+  std::atomic<uint32_t> notify;
+  // Número del último frame publicado entero (el primero es el 1); 0 = ninguno todavía
+  alignas(kAlignment) std::atomic<uint64_t> published;
+};
+
+struct alignas(kAlignment) SlotHeader {
+  std::atomic<uint64_t> version; // Impar mientras se escribe
+  uint64_t frameNumber;          // Número de publicación (ver RingHeader::published)
+  uint64_t sequence;             // Número de frame desde que se abrió la cámara
+  int64_t captureTimeNs;         // CLOCK_MONOTONIC, comparable entre procesos del mismo equipo
+  int32_t width;
+  int32_t height;
+  int32_t stride; // Bytes por fila
+  uint32_t format;
+  uint64_t bytes;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "el anillo necesita atómicos sin lock");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "el anillo necesita atómicos sin lock");
+
+constexpr uint64_t alignUp(uint64_t value) {
+  return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+constexpr uint64_t slotStrideFor(uint64_t capacity) {
+  return sizeof(SlotHeader) + alignUp(capacity);
+}
+
+constexpr uint64_t segmentSize(uint32_t slotCount, uint64_t capacity) {
+  return sizeof(RingHeader) + uint64_t(slotCount) * slotStrideFor(capacity);
+}
+
+inline SlotHeader *slotAt(RingHeader *ring, uint64_t frameNumber) {
+  const uint64_t index = (frameNumber - 1) % ring->slotCount;
+  return reinterpret_cast<SlotHeader *>(
+      reinterpret_cast<uint8_t *>(ring) + sizeof(RingHeader) + index * ring->slotStride);
+}
+
+inline const SlotHeader *slotAt(const RingHeader *ring, uint64_t frameNumber) {
+  return slotAt(const_cast<RingHeader *>(ring), frameNumber);
+}
+
+inline uint8_t *slotData(SlotHeader *slot) {
+  return reinterpret_cast<uint8_t *>(slot) + sizeof(SlotHeader);
+}
+
+inline const uint8_t *slotData(const SlotHeader *slot) {
+  return reinterpret_cast<const uint8_t *>(slot) + sizeof(SlotHeader);
+}
+
+} // namespace SharedFrames
+
+#endif // SHAREDFRAMELAYOUT_H
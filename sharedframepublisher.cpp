@@ -0,0 +1,200 @@
+#include "sharedframepublisher.h"
+#include <QDebug>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(Q_OS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace SharedFrames;
+
+namespace {
+
+quint32 formatFor(int channels) {
+  switch (channels) {
+  case 1:
+    return kFormatGray8;
+  case 3:
+    return kFormatBgr24;
+  case 4:
+    return kFormatBgra32;
+  default:
+    return 0;
+  }
+}
+
+#if defined(Q_OS_UNIX)
+// Un segmento con el mismo nombre es de otra instancia salvo que su productor ya no exista o lo
+// haya cerrado (una ejecución anterior que no terminó bien). Uno sin cabecera completa también
+// se da por abandonado: el productor la escribe justo después de crearlo.
+bool isStale(const QByteArray &name) {
+  const int fd = shm_open(name.constData(), O_RDONLY, 0);
+  if (fd < 0) {
+    return errno == ENOENT; // Ya no está: se puede crear
+  }
+  struct stat info;
+  void *map = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(RingHeader)) {
+    map = mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return true;
+  }
+  const RingHeader *ring = static_cast<const RingHeader *>(map);
+  bool stale = ring->magic != kMagic || ring->closed.load(std::memory_order_acquire) != 0;
+  if (!stale) {
+    const pid_t pid = pid_t(ring->producerPid);
+    stale = pid <= 0 || (kill(pid, 0) != 0 && errno == ESRCH);
+  }
+  munmap(map, sizeof(RingHeader));
+  return stale;
+}
+#endif
+
+} // namespace
+
+SharedFramePublisher::SharedFramePublisher(const Config &config) : m_config(config) {}
+
+SharedFramePublisher::~SharedFramePublisher() { close(); }
+
+bool SharedFramePublisher::open(const cv::Size &size, int type, double fps) {
+  Q_UNUSED(fps);
+  return m_ring || create(quint64(size.area()) * CV_ELEM_SIZE(type));
+}
+
+bool SharedFramePublisher::create(quint64 capacity) {
+#if defined(Q_OS_UNIX)
+  release();
+  const QByteArray name = m_config.name.toLocal8Bit();
+  const quint32 slots = quint32(qBound(2, m_config.slots, 256));
+  const size_t size = size_t(segmentSize(slots, capacity));
+
+  // Solo el mismo usuario puede leer los frames
+  int fd = shm_open(name.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    if (!isStale(name)) {
+      qWarning() << "SharedFramePublisher -" << m_config.name << "ya lo publica otra instancia";
+      return false;
+    }
+    // Uno que haya quedado de una ejecución anterior que no terminó bien se sustituye
+    qDebug() << "SharedFramePublisher - Sustituyendo el segmento abandonado" << m_config.name;
+    shm_unlink(name.constData());
+    fd = shm_open(name.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    qWarning() << "SharedFramePublisher - No se pudo crear" << m_config.name << strerror(errno);
+    return false;
+  }
+  void *map = MAP_FAILED;
+  if (ftruncate(fd, off_t(size)) == 0) {
+    map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    qWarning() << "SharedFramePublisher - No se pudo proyectar" << m_config.name
+               << strerror(errno);
+    shm_unlink(name.constData());
+    return false;
+  }
+
+  // ftruncate() deja el segmento a cero: contadores, versiones y 'magic' parten de 0
+  m_ring = static_cast<RingHeader *>(map);
+  m_size = size;
+  m_ring->version = kVersion;
+  m_ring->slotCount = slots;
+  m_ring->producerPid = quint32(getpid());
+  m_ring->slotStride = slotStrideFor(capacity);
+  m_ring->slotCapacity = capacity;
+  // 'magic' lo último: un cliente que lo vea tiene ya el resto de la cabecera
+  std::atomic_thread_fence(std::memory_order_release);
+  m_ring->magic = kMagic;
+  m_nextFrame = 1;
+  qDebug() << "SharedFramePublisher - Publicando en" << m_config.name << slots << "slots de"
+           << capacity << "bytes";
+  return true;
+#else
+  Q_UNUSED(capacity);
+  qWarning() << "SharedFramePublisher - Memoria compartida POSIX no disponible";
+  return false;
+#endif
+}
+
+bool SharedFramePublisher::write(const CapturedFrame &frame) {
+  const cv::Mat &image = frame.image;
+  const quint32 format = formatFor(image.channels());
+  if (frame.encoding != FrameEncoding::Decoded || image.depth() != CV_8U || format == 0) {
+    return false;
+  }
+  const size_t rowBytes = size_t(image.cols) * image.elemSize();
+  const quint64 bytes = quint64(rowBytes) * image.rows;
+  if (!m_ring || bytes > m_ring->slotCapacity) {
+    // Otra resolución: segmento nuevo, los clientes lo ven por 'closed' y lo vuelven a abrir
+    if (!create(bytes)) {
+      return false;
+    }
+  }
+
+  const quint64 number = m_nextFrame++;
+  SlotHeader *slot = slotAt(m_ring, number);
+  // Escritura del seqlock: versión impar, datos, versión par
+  const quint64 version = slot->version.load(std::memory_order_relaxed);
+  slot->version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->frameNumber = number;
+  slot->sequence = frame.sequence;
+  slot->captureTimeNs = frame.captureTimeNs;
+  slot->width = image.cols;
+  slot->height = image.rows;
+  slot->stride = int(rowBytes);
+  slot->format = format;
+  slot->bytes = bytes;
+  uchar *data = slotData(slot);
+  if (image.isContinuous()) {
+    std::memcpy(data, image.data, size_t(bytes));
+  } else {
+    for (int y = 0; y < image.rows; ++y) {
+      std::memcpy(data + y * rowBytes, image.ptr(y), rowBytes);
+    }
+  }
+
+  slot->version.store(version + 2, std::memory_order_release);
+  m_ring->published.store(number, std::memory_order_release);
+  m_ring->notify.fetch_add(1, std::memory_order_release);
+#if defined(Q_OS_LINUX)
+  // Una llamada por frame, haya o no clientes esperando: el productor no lleva la cuenta de ellos
+  syscall(SYS_futex, &m_ring->notify, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+  return true;
+}
+
+void SharedFramePublisher::close() { release(); }
+
+void SharedFramePublisher::release() {
+#if defined(Q_OS_UNIX)
+  if (!m_ring) {
+    return;
+  }
+  // Los clientes que tengan el segmento proyectado lo siguen viendo hasta que lo suelten
+  m_ring->closed.store(1, std::memory_order_release);
+  m_ring->notify.fetch_add(1, std::memory_order_release);
+#if defined(Q_OS_LINUX)
+  syscall(SYS_futex, &m_ring->notify, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+  munmap(m_ring, m_size);
+  m_ring = nullptr;
+  m_size = 0;
+  shm_unlink(m_config.name.toLocal8Bit().constData());
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef SHAREDFRAMEPUBLISHER_H
+#define SHAREDFRAMEPUBLISHER_H
+
+#include "framesink.h"
+#include "sharedframelayout.h"
+
+// Publica los frames en un anillo de memoria compartida POSIX (shm_open) para que otros procesos
+// del mismo equipo (inspección, registro...) los lean con SharedFrameClient sin abrir la cámara.
+//
+// Se alimenta como cualquier FrameSink, a través de un FrameRecorder: la copia al segmento se hace
+// en el hilo de este, nunca en el de captura. Cada frame va a un slot con su número, instante de
+// captura, tamaño y formato; los lectores no bloquean nunca al productor (ver sharedframelayout.h)
+// y un lector lento solo se pierde frames él mismo. Los frames MJPEG se publican decodificados.
+//
+// El segmento se crea con el primer frame y se borra al cerrar. Si llega un frame que no cabe en
+// los slots (otra resolución) se rehace con el mismo nombre y los clientes lo vuelven a abrir.
+// Solo en sistemas POSIX; en el resto open() falla.
+class SharedFramePublisher : public FrameSink {
+public:
+  struct Config {
+    QString name = QStringLiteral("/opencvtest"); // Nombre POSIX: empieza por '/'
+    int slots = 8; // Un lector tiene slots - 1 frames de margen para usar uno sin copiarlo
+  };
+
+  explicit SharedFramePublisher(const Config &config);
+  ~SharedFramePublisher() override;
+
+  // --- FrameSink (hilo del FrameRecorder) ---
+  bool open(const cv::Size &size, int type, double fps) override;
+  bool write(const CapturedFrame &frame) override;
+  void close() override;
+  QString description() const override { return m_config.name; }
+
+private:
+  bool create(quint64 capacity);
+  void release();
+
+  const Config m_config;
+  SharedFrames::RingHeader *m_ring = nullptr;
+  size_t m_size = 0;
+  quint64 m_nextFrame = 1;
+};
+
+#endif // SHAREDFRAMEPUBLISHER_H
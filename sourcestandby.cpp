@@ -0,0 +1,162 @@
+#include "sourcestandby.h"
+#include <QDebug>
+
+SourceStandby::SourceStandby(int keepWarm) : m_keepWarm(qMax(0, keepWarm)) {}
+
+SourceStandby::~SourceStandby() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+    ++m_generation;
+  }
+  m_condition.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+  clear();
+}
+
+void SourceStandby::setKeepWarm(int count) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_keepWarm = qMax(0, count);
+  while (static_cast<int>(m_parked.size()) > m_keepWarm) {
+    m_parked.front().source->release();
+    m_parked.pop_front();
+  }
+}
+
+int SourceStandby::keepWarm() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_keepWarm;
+}
+
+void SourceStandby::openAsync(const CameraCommand &command, const QString &spec) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    if (m_hasResult.exchange(false) && m_result.source) {
+      // Abierto para una petición anterior que ya no interesa
+      parkLocked(m_result.spec, m_result.command.resolution, std::move(m_result.source));
+    }
+    m_request = command;
+    m_requestSpec = spec;
+    m_hasRequest = true;
+    if (!m_thread.joinable()) {
+      m_thread = std::thread([this] { openLoop(); });
+    }
+  }
+  m_condition.notify_all();
+}
+
+void SourceStandby::cancelPending() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_generation;
+  m_hasRequest = false;
+  if (m_hasResult.exchange(false) && m_result.source) {
+    parkLocked(m_result.spec, m_result.command.resolution, std::move(m_result.source));
+  }
+}
+
+bool SourceStandby::takeResult(Result &result) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_hasResult.exchange(false)) {
+    return false;
+  }
+  result = std::move(m_result);
+  m_result = Result();
+  return true;
+}
+
+std::unique_ptr<FrameSource> SourceStandby::takeWarm(const QString &spec, const QSize &resolution) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_parked.begin(); it != m_parked.end(); ++it) {
+    if (it->spec == spec && it->resolution == resolution) {
+      std::unique_ptr<FrameSource> source = std::move(it->source);
+      m_parked.erase(it);
+      return source;
+    }
+  }
+  return nullptr;
+}
+
+void SourceStandby::park(
+    const QString &spec, const QSize &resolution, std::unique_ptr<FrameSource> source) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  parkLocked(spec, resolution, std::move(source));
+}
+
+void SourceStandby::parkLocked(
+    const QString &spec, const QSize &resolution, std::unique_ptr<FrameSource> source) {
+  if (!source) {
+    return;
+  }
+  if (m_keepWarm <= 0) {
+    source->release();
+    return;
+  }
+  m_parked.push_back(Parked{spec, resolution, std::move(source)});
+  while (static_cast<int>(m_parked.size()) > m_keepWarm) {
+    m_parked.front().source->release(); // El menos reciente
+    m_parked.pop_front();
+  }
+}
+
+bool SourceStandby::releaseParked() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const bool any = !m_parked.empty();
+  for (Parked &parked : m_parked) {
+    parked.source->release();
+  }
+  m_parked.clear();
+  return any;
+}
+
+void SourceStandby::clear() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  ++m_generation;
+  m_hasRequest = false;
+  // open() no se puede interrumpir: se espera a que termine y su resultado se cierra también
+  m_condition.wait(lock, [this] { return !m_opening; });
+  if (m_hasResult.exchange(false) && m_result.source) {
+    m_result.source->release();
+  }
+  m_result = Result();
+  lock.unlock();
+  releaseParked();
+}
+
+void SourceStandby::openLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_condition.wait(lock, [this] { return m_stopping || m_hasRequest; });
+    if (m_stopping) {
+      return;
+    }
+    const CameraCommand command = m_request;
+    const QString spec = m_requestSpec;
+    const quint64 generation = m_generation;
+    m_hasRequest = false;
+    m_opening = true;
+    lock.unlock();
+
+    // Lo lento (driver, negociación de formato) ocurre aquí, fuera del hilo de captura
+    std::unique_ptr<FrameSource> source = FrameSource::create(spec, command.resolution);
+    if (source && !source->open()) {
+      qWarning() << "SourceStandby - No se pudo abrir el origen" << spec;
+      source.reset();
+    }
+
+    lock.lock();
+    m_opening = false;
+    if (generation != m_generation) {
+      // Se pidió otra cosa mientras tanto: a la reserva por si se vuelve a pedir
+      parkLocked(spec, command.resolution, std::move(source));
+    } else {
+      m_result.command = command;
+      m_result.spec = spec;
+      m_result.source = std::move(source);
+      m_hasResult.store(true, std::memory_order_release);
+    }
+    m_condition.notify_all(); // clear() puede estar esperando
+  }
+}
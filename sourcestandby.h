@@ -0,0 +1,85 @@
+#ifndef SOURCESTANDBY_H
+#define SOURCESTANDBY_H
+
+#include "cameracommandqueue.h"
+#include "framesource.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Orígenes abiertos fuera del hilo de captura, para cambiar de cámara sin dejar de capturar.
+//
+// openAsync() abre el origen en un hilo auxiliar mientras el actual sigue entregando frames; el
+// hilo de captura consulta hasResult() entre frames (una lectura atómica) y cambia de origen con
+// takeResult(). Una petición nueva sustituye a la que aún no ha empezado, y un resultado que ya
+// nadie quiere pasa a la reserva.
+//
+// La reserva mantiene abiertos, sin capturar, los 'keepWarm' últimos orígenes que se dejaron de
+// usar: volver a uno de ellos no pasa por el driver. Cada uno sigue ocupando su dispositivo (y el
+// ancho de banda USB que tenga reservado), y sus primeros frames al volver pueden ser los que el
+// driver retuvo al dejarlo.
+class SourceStandby {
+public:
+  struct Result {
+    CameraCommand command;
+    QString spec;
+    std::unique_ptr<FrameSource> source; // Nulo si no se pudo abrir
+  };
+
+  explicit SourceStandby(int keepWarm = 0);
+  ~SourceStandby();
+
+  void setKeepWarm(int count);
+  int keepWarm() const;
+
+  // --- Desde el hilo de captura ---
+  void openAsync(const CameraCommand &command, const QString &spec);
+  // Descarta la petición pendiente; si ya se está abriendo, el resultado irá a la reserva
+  void cancelPending();
+  bool hasResult() const { return m_hasResult.load(std::memory_order_acquire); }
+  bool takeResult(Result &result);
+
+  // Origen en reserva con la misma especificación y resolución, o nulo
+  std::unique_ptr<FrameSource> takeWarm(const QString &spec, const QSize &resolution);
+  // Deja 'source' abierto en la reserva; si no cabe, se cierra el más antiguo
+  void park(const QString &spec, const QSize &resolution, std::unique_ptr<FrameSource> source);
+
+  // Cierra los orígenes en reserva; false si no había ninguno
+  bool releaseParked();
+
+  // Espera a la apertura en curso y cierra todo lo que haya en reserva
+  void clear();
+
+private:
+  struct Parked {
+    QString spec;
+    QSize resolution;
+    std::unique_ptr<FrameSource> source;
+  };
+
+  void openLoop();
+  void parkLocked(
+      const QString &spec, const QSize &resolution, std::unique_ptr<FrameSource> source);
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::thread m_thread; // Se arranca con la primera petición
+  bool m_stopping{false};
+
+  bool m_hasRequest{false};
+  CameraCommand m_request;
+  QString m_requestSpec;
+  bool m_opening{false};
+  quint64 m_generation{0}; // Sube con cada petición o cancelación
+
+  Result m_result;
+  std::atomic<bool> m_hasResult{false};
+
+  int m_keepWarm;
+  std::deque<Parked> m_parked; // Del más antiguo al más reciente
+};
+
+#endif // SOURCESTANDBY_H
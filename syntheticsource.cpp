@@ -0,0 +1,139 @@
+#include "syntheticsource.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+namespace {
+
+constexpr int kBarCount = 8;
+constexpr int kCounterBits = 32;
+constexpr int kCounterBlock = 8;
+constexpr int kPixelsPerFrame = 4; // Desplazamiento de las barras por frame
+
+int barWidthFor(int width) { return qMax(1, width / kBarCount); }
+
+} // namespace
+
+SyntheticSource::SyntheticSource(const QSize &size, double fps, int type)
+    : m_size(size), m_type(type) {
+  m_pacer.setFps(fps);
+}
+
+bool SyntheticSource::open() {
+  if (m_size.isEmpty()) {
+    return false;
+  }
+  buildPattern();
+  m_frameIndex = 0;
+  m_pacer.reset();
+  m_opened = true;
+  return true;
+}
+
+void SyntheticSource::release() {
+  m_opened = false;
+  m_pattern.release();
+}
+
+bool SyntheticSource::grab() {
+  if (!m_opened) {
+    return false;
+  }
+  m_pacer.wait();
+  ++m_frameIndex;
+  return true;
+}
+
+bool SyntheticSource::retrieve(cv::Mat &image) {
+  if (!m_opened) {
+    return false;
+  }
+  renderFrame(m_pattern, m_frameIndex, image);
+  return true;
+}
+
+bool SyntheticSource::set(int propId, double value) {
+  switch (propId) {
+  case cv::CAP_PROP_FPS:
+    m_pacer.setFps(value);
+    return true;
+  case cv::CAP_PROP_FRAME_WIDTH:
+  case cv::CAP_PROP_FRAME_HEIGHT: {
+    const int size = static_cast<int>(value);
+    if (size <= 0) {
+      return false;
+    }
+    if (propId == cv::CAP_PROP_FRAME_WIDTH) {
+      m_size.setWidth(size);
+    } else {
+      m_size.setHeight(size);
+    }
+    if (m_opened) {
+      buildPattern();
+    }
+    return true;
+  }
+  }
+  return false;
+}
+
+double SyntheticSource::get(int propId) const {
+  switch (propId) {
+  case cv::CAP_PROP_FPS:
+    return m_pacer.fps();
+  case cv::CAP_PROP_FRAME_WIDTH:
+    return m_size.width();
+  case cv::CAP_PROP_FRAME_HEIGHT:
+    return m_size.height();
+  case cv::CAP_PROP_POS_FRAMES:
+    return static_cast<double>(m_frameIndex);
+  case cv::CAP_PROP_POS_MSEC:
+    return m_pacer.fps() > 0 ? m_frameIndex * 1000.0 / m_pacer.fps() : 0;
+  }
+  return 0;
+}
+
+QString SyntheticSource::description() const {
+  return QStringLiteral("Patrón sintético %1x%2@%3")
+      .arg(m_size.width())
+      .arg(m_size.height())
+      .arg(m_pacer.fps());
+}
+
+void SyntheticSource::buildPattern() {
+  static const cv::Scalar kColors[kBarCount] = {
+      {255, 255, 255}, {0, 255, 255}, {255, 255, 0}, {0, 255, 0},
+      {255, 0, 255},   {0, 0, 255},   {255, 0, 0},   {0, 0, 0}};
+
+  const int width = m_size.width();
+  const int barWidth = barWidthFor(width);
+  m_pattern.create(m_size.height(), width * 2, m_type);
+  for (int x = 0, bar = 0; x < m_pattern.cols; x += barWidth, ++bar) {
+    const cv::Scalar &bgr = kColors[bar % kBarCount];
+    cv::Scalar color(bgr[0], bgr[1], bgr[2], 255);
+    if (m_type == CV_8UC1) {
+      color = cv::Scalar(0.114 * bgr[0] + 0.587 * bgr[1] + 0.299 * bgr[2]);
+    }
+    cv::rectangle(
+        m_pattern, cv::Rect(x, 0, qMin(barWidth, m_pattern.cols - x), m_pattern.rows), color,
+        cv::FILLED);
+  }
+}
+
+void SyntheticSource::renderFrame(const cv::Mat &pattern, quint64 frameIndex, cv::Mat &image) {
+  const int width = pattern.cols / 2;
+  const int period = barWidthFor(width) * kBarCount;
+  const int offset = static_cast<int>((frameIndex * kPixelsPerFrame) % period);
+  pattern(cv::Rect(offset, 0, width, pattern.rows)).copyTo(image);
+
+  // Número de frame en binario para que los consumidores puedan comprobar la secuencia
+  const int bits = qMin(kCounterBits, width / kCounterBlock);
+  if (pattern.rows < kCounterBlock) {
+    return;
+  }
+  for (int i = 0; i < bits; ++i) {
+    const bool set = (frameIndex >> (kCounterBits - 1 - i)) & 1;
+    const cv::Scalar color = set ? cv::Scalar(255, 255, 255, 255) : cv::Scalar(0, 0, 0, 255);
+    cv::rectangle(
+        image, cv::Rect(i * kCounterBlock, 0, kCounterBlock, kCounterBlock), color, cv::FILLED);
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef SYNTHETICSOURCE_H
+#define SYNTHETICSOURCE_H
+
+#include "framesource.h"
+
+// Patrón de prueba determinista a cualquier resolución y ritmo: barras de color que se desplazan
+// y el número de frame codificado en binario en la esquina superior izquierda (32 bloques de
+// 8x8, el más significativo primero). Mismo índice, mismos píxeles.
+class SyntheticSource : public FrameSource {
+public:
+  SyntheticSource(const QSize &size, double fps, int type = CV_8UC3);
+
+  bool open() override;
+  bool isOpened() const override { return m_opened; }
+  void release() override;
+
+  bool grab() override;
+  bool retrieve(cv::Mat &image) override;
+
+  bool set(int propId, double value) override;
+  double get(int propId) const override;
+
+  QString description() const override;
+
+  static void renderFrame(const cv::Mat &pattern, quint64 frameIndex, cv::Mat &image);
+
+private:
+  QSize m_size;
+  const int m_type;
+  bool m_opened = false;
+  quint64 m_frameIndex = 0;
+  cv::Mat m_pattern; // Dos anchos de barras para recortar el desplazamiento sin dar la vuelta
+  FramePacer m_pacer;
+
+  void buildPattern();
+};
+
+#endif // SYNTHETICSOURCE_H
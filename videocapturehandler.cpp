@@ -1,186 +1,1055 @@
 #include "videocapturehandler.h"
+#include "framedecoder.h"
+#include "mjpeg.h"
+#include "pixelconvert.h"
+#include "yuvframe.h"
 #include <QDebug>
+#include <QMetaMethod>
 #include <QtMath>
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
 
-VideoCaptureHandler::VideoCaptureHandler(QObject *parent) : QThread(parent) {
+VideoCaptureHandler::VideoCaptureHandler(QObject *parent, int ringDepth, int poolSize)
+    : QThread(parent), m_ring(ringDepth), m_workerPool(&WorkStealingPool::shared()),
+      m_framePool(poolSize), m_previewPool(poolSize) {
   qDebug() << "VideoCaptureHandler::VideoCaptureHandler() - Constructor called.";
   qRegisterMetaType<CameraPropertiesSupport>();
   qRegisterMetaType<CameraPropertyRanges>();
+  qRegisterMetaType<FrameHandle>();
 }
 
 VideoCaptureHandler::~VideoCaptureHandler() {}
 
+CaptureStats VideoCaptureHandler::captureStats() const {
+  CaptureStats stats;
+  stats.captured = m_ring.publishedCount();
+  stats.dropped = m_ring.droppedCount();
+  stats.poolExhausted = m_framePool.exhaustedCount() + m_previewPool.exhaustedCount();
+  stats.processingDropped = m_pipeline.droppedCount();
+  stats.sourceLost = m_rateMonitor.lost();
+  stats.sourceDuplicates = m_rateMonitor.duplicates();
+  stats.skipped = m_skippedFrames.load(std::memory_order_relaxed);
+  stats.requestedFps = m_requestedFps.load(std::memory_order_relaxed);
+  stats.negotiatedFps = m_negotiatedFps.load(std::memory_order_relaxed);
+  stats.achievedFps = m_rateMonitor.achievedFps();
+  stats.driverTimestamps = m_driverTimestamps.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void VideoCaptureHandler::setTargetFrameRate(double fps) {
+  m_requestedFps = fps > 0 ? fps : 0;
+  // La negociación la hace el hilo de captura, entre dos frames (processCommands())
+  m_commands.pushProperty(cv::CAP_PROP_FPS, m_requestedFps);
+}
+
+void VideoCaptureHandler::setFrameCallback(FrameCallback callback) {
+  m_frameCallback = std::move(callback);
+}
+
+void VideoCaptureHandler::setPreviewCallback(FrameCallback callback) {
+  m_previewCallback = std::move(callback);
+}
+
+void VideoCaptureHandler::setHotSwap(bool enabled, int keepWarm) {
+  m_standby.setKeepWarm(enabled ? keepWarm : 0);
+  m_hotSwap = enabled;
+}
+
+void VideoCaptureHandler::setWorkerPool(WorkStealingPool *pool) { m_workerPool = pool; }
+
+void VideoCaptureHandler::setProcessingStages(const QVector<FramePipeline::Stage> &stages) {
+  m_pipeline.setStages(stages);
+}
+
+void VideoCaptureHandler::startRecording(
+    std::unique_ptr<FrameSink> sink, FrameRecorder::Policy policy) {
+  m_recorder.start(std::move(sink), policy);
+}
+
+void VideoCaptureHandler::startPreTrigger(const PreTriggerBuffer::Config &config) {
+  stopPreTrigger();
+  m_preTrigger = std::make_shared<PreTriggerBuffer>(config);
+  // Si la compresión no da abasto se pierden frames del almacén, nunca de la captura
+  m_preTriggerRecorder.start(m_preTrigger, FrameRecorder::Policy::DropNewest);
+}
+
+void VideoCaptureHandler::stopPreTrigger() {
+  m_preTriggerRecorder.stop();
+  m_preTrigger.reset();
+}
+
+void VideoCaptureHandler::startSharing(const SharedFramePublisher::Config &config) {
+  m_sharingRecorder.stop();
+  m_sharingRecorder.start(
+      std::make_shared<SharedFramePublisher>(config), FrameRecorder::Policy::DropNewest);
+}
+
+void VideoCaptureHandler::startStreaming(std::shared_ptr<FrameSink> sink) {
+  m_streamingRecorder.stop();
+  m_streamingRecorder.start(std::move(sink), FrameRecorder::Policy::DropNewest);
+}
+
+bool VideoCaptureHandler::triggerClip(std::unique_ptr<FrameSink> clip, double postSeconds) {
+  return m_preTrigger && m_preTrigger->trigger(std::move(clip), postSeconds);
+}
+
+PreTriggerBuffer::Stats VideoCaptureHandler::preTriggerStats() const {
+  return m_preTrigger ? m_preTrigger->stats() : PreTriggerBuffer::Stats();
+}
+
+int VideoCaptureHandler::addOutputStream(const OutputStreamConfig &config, FrameCallback callback) {
+  auto stream = std::make_shared<OutputStream>();
+  stream->config = config;
+  stream->config.decimation = qMax(1, config.decimation);
+  stream->callback = std::move(callback);
+  stream->pool = std::make_unique<FramePool>(qBound(1, config.poolSize, 64));
+
+  std::lock_guard<std::mutex> lock(m_streamsMutex);
+  releaseRetiredStreams();
+  stream->id = m_nextStreamId++;
+  m_streams.push_back(stream);
+  if (config.maxSize.isEmpty()) {
+    m_streamsWidth = -1;
+    m_streamsHeight = -1;
+  } else if (m_streamsWidth >= 0) {
+    m_streamsWidth = qMax(m_streamsWidth.load(), config.maxSize.width());
+    m_streamsHeight = qMax(m_streamsHeight.load(), config.maxSize.height());
+  }
+  m_streamsVersion.fetch_add(1, std::memory_order_release);
+  return stream->id;
+}
+
+void VideoCaptureHandler::removeOutputStream(int id) {
+  std::shared_ptr<OutputStream> removed;
+  {
+    std::lock_guard<std::mutex> lock(m_streamsMutex);
+    const auto it = std::find_if(
+        m_streams.begin(), m_streams.end(),
+        [id](const std::shared_ptr<OutputStream> &stream) { return stream->id == id; });
+    if (it == m_streams.end()) {
+      return;
+    }
+    removed = *it;
+    m_streams.erase(it);
+    int width = 0;
+    int height = 0;
+    for (const auto &stream : m_streams) {
+      const QSize &size = stream->config.maxSize;
+      width = size.isEmpty() || width < 0 ? -1 : qMax(width, size.width());
+      height = size.isEmpty() || height < 0 ? -1 : qMax(height, size.height());
+    }
+    m_streamsWidth = width;
+    m_streamsHeight = height;
+    m_streamsVersion.fetch_add(1, std::memory_order_release);
+  }
+  {
+    // Espera a que acabe la entrega en curso; las siguientes ya parten de m_streams sin él
+    std::lock_guard<std::mutex> lock(m_streamDeliveryMutex);
+    m_activeStreams.erase(
+        std::remove(m_activeStreams.begin(), m_activeStreams.end(), removed),
+        m_activeStreams.end());
+  }
+  removed->callback = nullptr; // Lo que captura el callback se suelta ya
+
+  // El pool tiene que sobrevivir a los frames que el consumidor aún no ha soltado
+  std::lock_guard<std::mutex> lock(m_streamsMutex);
+  m_retiredStreams.push_back(std::move(removed));
+  releaseRetiredStreams();
+}
+
+void VideoCaptureHandler::releaseRetiredStreams() {
+  m_retiredStreams.erase(
+      std::remove_if(
+          m_retiredStreams.begin(), m_retiredStreams.end(),
+          [](const std::shared_ptr<OutputStream> &stream) { return stream->pool->isIdle(); }),
+      m_retiredStreams.end());
+}
+
+OutputStreamStats VideoCaptureHandler::outputStreamStats(int id) const {
+  OutputStreamStats stats;
+  std::lock_guard<std::mutex> lock(m_streamsMutex);
+  for (const auto &stream : m_streams) {
+    if (stream->id == id) {
+      stats.delivered = stream->delivered.load(std::memory_order_relaxed);
+      stats.shared = stream->shared.load(std::memory_order_relaxed);
+      stats.dropped = stream->dropped.load(std::memory_order_relaxed);
+    }
+  }
+  return stats;
+}
+
+void VideoCaptureHandler::setPreviewSize(const QSize &size) {
+  m_previewWidth.store(size.width(), std::memory_order_relaxed);
+  m_previewHeight.store(size.height(), std::memory_order_relaxed);
+}
+
+void VideoCaptureHandler::stop() {
+  requestInterruption();
+  m_commands.wake();
+}
+
 void VideoCaptureHandler::requestCameraChange(int cameraId, const QSize &resolution) {
-  m_requestedWidth = resolution.width();
-  m_requestedHeight = resolution.height();
-  m_requestedCamera = cameraId;
+  m_commands.pushCameraChange(cameraId, resolution);
+}
+
+void VideoCaptureHandler::requestSourceChange(const QString &sourceSpec, const QSize &resolution) {
+  m_commands.pushCameraChange(NULL_CAMERA, resolution, sourceSpec);
 }
 
-// ... (Setters de foco y propiedades sin cambios) ...
 void VideoCaptureHandler::setAutoFocus(bool manual) {
-  m_requestedAutoFocus = manual ? true : false;
+  m_commands.pushProperty(cv::CAP_PROP_AUTOFOCUS, manual ? 1 : 0);
 }
 void VideoCaptureHandler::setAutoExposure(bool manual) {
-  m_requestedAutoExposure = manual ? true : false;
+  m_commands.pushProperty(cv::CAP_PROP_AUTO_EXPOSURE, manual ? 1 : 0);
+}
+void VideoCaptureHandler::setFocus(int value) {
+  m_commands.pushProperty(cv::CAP_PROP_FOCUS, value);
+}
+void VideoCaptureHandler::setBrightness(int value) {
+  m_commands.pushProperty(cv::CAP_PROP_BRIGHTNESS, value);
+}
+void VideoCaptureHandler::setContrast(int value) {
+  m_commands.pushProperty(cv::CAP_PROP_CONTRAST, value);
+}
+void VideoCaptureHandler::setSaturation(int value) {
+  m_commands.pushProperty(cv::CAP_PROP_SATURATION, value);
+}
+void VideoCaptureHandler::setSharpness(int value) {
+  m_commands.pushProperty(cv::CAP_PROP_SHARPNESS, value);
+}
+void VideoCaptureHandler::setExposure(int value) {
+  m_commands.pushProperty(cv::CAP_PROP_EXPOSURE, value);
 }
-void VideoCaptureHandler::setFocus(int value) { m_requestedFocus = value; }
-void VideoCaptureHandler::setBrightness(int value) { m_requestedBrightness = value; }
-void VideoCaptureHandler::setContrast(int value) { m_requestedContrast = value; }
-void VideoCaptureHandler::setSaturation(int value) { m_requestedSaturation = value; }
-void VideoCaptureHandler::setSharpness(int value) { m_requestedSharpness = value; }
-void VideoCaptureHandler::setExposure(int value) { m_requestedExposure = value; }
 
 PropertyRange VideoCaptureHandler::getPropertyRange(int propId) {
   PropertyRange range;
-  if (!m_VideoCapture.isOpened()) {
+  if (!m_source) {
     return range;
   }
 
-  double currentValue = m_VideoCapture.get(propId);
-  range.current = currentValue;
-
-  range.min = 0;
-  range.max = 255;
-  if (qFuzzyIsNull(range.current)) {
-    range.current = 126;
+  // Límites reales si el origen sabe consultarlos; si no, el rango genérico 0-255
+  const bool known = m_source->propertyRange(propId, range);
+  range.current = m_source->get(propId);
+  if (!known) {
+    range.min = 0;
+    range.max = 255;
+    if (qFuzzyIsNull(range.current)) {
+      range.current = 126;
+    }
   }
   return range;
 }
 
 void VideoCaptureHandler::run() {
+  m_stopConversion = false;
+  m_pipeline.start([this](const CapturedFrame &frame) { deliverFrame(frame); });
+
   while (!isInterruptionRequested()) {
-    int requestedCamId = m_requestedCamera.exchange(NO_OP_CAMERA);
-    if (requestedCamId != NO_OP_CAMERA) {
+    // Sin órdenes pendientes esto es una sola lectura atómica por frame
+    if (m_commands.hasPending()) {
+      processCommands();
+    }
+    // Origen abierto en segundo plano: se cambia aquí, entre dos frames
+    if (m_standby.hasResult()) {
+      swapToOpenedSource();
+    }
 
-      m_VideoCapture.release(); // Cerrar cámara anterior
+    if (m_source) {
+      // grab() bloquea hasta que el driver entrega el frame: marca el ritmo sin sleeps
+      CapturedFrame &frame = m_ring.producerFrame();
+      frame.timestamps.reset();
+      frame.timestamps.mark(FrameTiming::GrabStart);
+      if (m_source->grab()) {
+        frame.timestamps.mark(FrameTiming::Grabbed);
+        frame.captureTimeNs = frame.timestamps.ns[FrameTiming::Grabbed];
+        if (acceptGrabbedFrame(frame.captureTimeNs) && m_source->retrieve(frame.image) &&
+            !frame.image.empty()) {
+          frame.encoding = m_source->encoding();
+          frame.timestamps.mark(FrameTiming::Retrieved);
+          m_timing.record(frame.timestamps, FrameTiming::Grab, FrameTiming::Retrieve);
+          frame.sequence = ++m_frameSequence;
+          // Antes de publicar: después el frame ya es del consumidor. Si el grabador se queda
+          // una referencia, producerFrame() dará un buffer nuevo en lugar de sobrescribirlo.
+          m_recorder.push(frame);
+          m_preTriggerRecorder.push(frame);
+          m_sharingRecorder.push(frame);
+          m_streamingRecorder.push(frame);
+          m_ring.publish();
+          scheduleConversion();
+          if (m_probePending) {
+            probeCapabilities(); // Una vez por apertura, con el primer frame ya en camino
+          }
+        }
+      } else {
+        QThread::msleep(10); // Cámara desconectada o sin datos: evitar un bucle activo
+      }
+    } else {
+      m_commands.waitForCommands(); // Sin cámara: dormir hasta la siguiente orden o stop()
+    }
+  }
+
+  // Esperar a que termine la tarea de conversión pendiente antes de soltar nada
+  m_stopConversion = true;
+  while (m_conversionTasks.load(std::memory_order_acquire) > 0 ||
+         m_probeTasks.load(std::memory_order_acquire) > 0) {
+    QThread::msleep(1);
+  }
+  m_pipeline.stop();
 
-      if (requestedCamId >= START_CAMERA) {
+  if (m_source) {
+    m_source->release();
+    m_source.reset();
+  }
+  m_standby.clear();
+  qDebug() << "VideoCaptureHandler::run() - Hilo terminado y cámara liberada.";
+}
 
-        // Cargar la resolución solicitada
-        int reqWidth = m_requestedWidth.load();
-        int reqHeight = m_requestedHeight.load();
+void VideoCaptureHandler::processCommands() {
+  m_commands.takeAll(m_commandBatch);
+  for (const CameraCommand &command : m_commandBatch) {
+    switch (command.type) {
+    case CameraCommand::Type::ChangeCamera:
+      openSource(command);
+      break;
+    case CameraCommand::Type::SetProperty:
+      if (m_source && command.propertyId == cv::CAP_PROP_FPS) {
+        negotiateFrameRate(); // El valor ya está en m_requestedFps
+      } else if (m_source) {
+        m_source->set(command.propertyId, command.value);
+      }
+      break;
+    }
+  }
+}
 
-        if (!m_VideoCapture.open(requestedCamId, cv::CAP_DSHOW)) {
-          qWarning() << "No se pudo abrir la cámara" << requestedCamId;
-          emit cameraOpenFailed(
-              requestedCamId, "Error al abrir la cámara con CAP_ANY y CAP_DSHOW.");
-        }
+void VideoCaptureHandler::openSource(const CameraCommand &command) {
+  // Una apertura en segundo plano que aún no ha terminado queda sustituida por esta orden
+  m_standby.cancelPending();
 
-        if (m_VideoCapture.isOpened()) {
-          // Aplicar la resolución solicitada
-          if (reqWidth > 0 && reqHeight > 0) {
-            m_VideoCapture.set(cv::CAP_PROP_FRAME_WIDTH, reqWidth);
-            m_VideoCapture.set(cv::CAP_PROP_FRAME_HEIGHT, reqHeight);
-            qDebug() << "Solicitando resolución:" << reqWidth << "x" << reqHeight;
-          }
+  const int cameraId = command.cameraId;
+  if (command.sourceSpec.isEmpty() && cameraId < START_CAMERA) {
+    // Parar no es cambiar de cámara: no se deja nada en reserva, que seguiría abierto con el LED
+    // encendido y su ancho de banda USB. clear() cierra también lo que se estuviera abriendo.
+    if (m_source) {
+      m_source->release();
+      m_source.reset();
+    }
+    m_standby.clear();
+    m_currentCameraId = NULL_CAMERA;
+    return;
+  }
+
+  const QString spec =
+      command.sourceSpec.isEmpty() ? FrameSource::cameraSpec(cameraId) : command.sourceSpec;
+  if (std::unique_ptr<FrameSource> warm = m_standby.takeWarm(spec, command.resolution)) {
+    closeSource();
+    adoptSource(command, spec, std::move(warm)); // Ya estaba abierto: cambio inmediato
+    return;
+  }
+  if (m_hotSwap && m_source && spec != m_sourceSpec) {
+    // El origen actual sigue capturando hasta que el nuevo esté listo (swapToOpenedSource())
+    m_standby.openAsync(command, spec);
+    return;
+  }
+  openBlocking(command, spec);
+}
+
+void VideoCaptureHandler::openBlocking(const CameraCommand &command, const QString &spec) {
+  // Un dispositivo no se puede abrir dos veces: el actual se cierra sin pasar por la reserva
+  if (m_source) {
+    m_source->release();
+    m_source.reset();
+  }
+  std::unique_ptr<FrameSource> source = FrameSource::create(spec, command.resolution);
+  bool opened = source && source->open();
+  if (!opened && source && m_standby.releaseParked()) {
+    // Puede que el dispositivo siguiera abierto en la reserva con otra resolución o modo
+    opened = source->open();
+  }
+  if (!opened) {
+    reportOpenFailure(command.cameraId, spec);
+    m_currentCameraId = command.cameraId;
+    m_frameSequence = 0;
+    return;
+  }
+  adoptSource(command, spec, std::move(source));
+}
+
+void VideoCaptureHandler::swapToOpenedSource() {
+  SourceStandby::Result result;
+  if (!m_standby.takeResult(result)) {
+    return;
+  }
+  if (!result.source) {
+    // Suele ser el mismo dispositivo en otro modo (camera:0 -> mjpeg:0), que no se puede abrir
+    // mientras el actual lo tiene: se hace el cambio con corte
+    openBlocking(result.command, result.spec);
+    return;
+  }
+  closeSource();
+  adoptSource(result.command, result.spec, std::move(result.source));
+}
+
+void VideoCaptureHandler::closeSource() {
+  if (!m_source) {
+    return;
+  }
+  if (m_hotSwap) {
+    m_standby.park(m_sourceSpec, m_sourceResolution, std::move(m_source));
+  } else {
+    m_source->release();
+  }
+  m_source.reset();
+}
+
+void VideoCaptureHandler::reportOpenFailure(int cameraId, const QString &spec) {
+  qWarning() << "No se pudo abrir el origen" << spec;
+  emit cameraOpenFailed(cameraId, tr("Error al abrir el origen de vídeo '%1'.").arg(spec));
+}
+
+void VideoCaptureHandler::adoptSource(
+    const CameraCommand &command, const QString &spec, std::unique_ptr<FrameSource> source) {
+  m_source = std::move(source);
+  m_sourceSpec = spec;
+  m_sourceResolution = command.resolution;
+
+  m_nativeFps = m_source->get(cv::CAP_PROP_FPS);
+  negotiateFrameRate();
+
+  // Dispositivo ya conocido: la GUI tiene sus controles sin esperar a ningún sondeo
+  m_deviceKey = m_source->deviceKey();
+  m_capabilitiesCached = !m_deviceKey.isEmpty() &&
+                         DeviceCapabilityCache::shared().find(m_deviceKey, m_capabilities);
+  if (m_capabilitiesCached) {
+    emit propertiesSupported(m_capabilities.support);
+    emit rangesSupported(m_capabilities.ranges);
+  }
+  m_probePending = true;
+  {
+    // Hasta tener los rangos del origen nuevo no se mueve nada (configureAutoControls())
+    std::lock_guard<std::mutex> lock(m_analysisMutex);
+    m_controlsConfigured = false;
+    m_sourceGeneration.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  m_currentCameraId = command.cameraId;
+  m_frameSequence = 0;
+}
+
+void VideoCaptureHandler::negotiateFrameRate() {
+  const double requested = m_requestedFps.load(std::memory_order_relaxed);
+  const double target = requested > 0 ? requested : m_nativeFps;
+  if (target > 0 && qAbs(m_source->get(cv::CAP_PROP_FPS) - target) > 0.01) {
+    // En V4L2 esto es VIDIOC_S_PARM: el driver redondea al intervalo más cercano que admita el
+    // modo actual, por eso se vuelve a leer
+    m_source->set(cv::CAP_PROP_FPS, target);
+  }
+  const double negotiated = m_source->get(cv::CAP_PROP_FPS);
+  m_negotiatedFps = negotiated > 0 ? negotiated : 0;
+  if (requested > 0 && negotiated > 0 && qAbs(negotiated - requested) > 0.5) {
+    qDebug() << "VideoCaptureHandler - Pedidos" << requested << "fps, el origen da" << negotiated;
+  }
+  m_rateMonitor.reset(negotiated);
+  m_nextDueNs = 0;
+  m_decimationCounter = 0;
+  updateRecordingRate();
+}
+
+void VideoCaptureHandler::updateRecordingRate() {
+  const double requested = m_requestedFps.load(std::memory_order_relaxed);
+  const double negotiated = m_negotiatedFps.load(std::memory_order_relaxed);
+  double fps = negotiated;
+  if (requested > 0) {
+    fps = negotiated > 0 ? qMin(requested, negotiated) : requested;
+  }
+  fps /= m_appliedDecimation;
+  m_recorder.setFrameRate(fps);
+  m_preTriggerRecorder.setFrameRate(fps);
+  m_sharingRecorder.setFrameRate(fps);
+  m_streamingRecorder.setFrameRate(fps);
+}
+
+bool VideoCaptureHandler::acceptGrabbedFrame(qint64 grabbedNs) {
+  // Mejor la marca del driver: la de grab() lleva encima el retraso con el que se leyó el buffer,
+  // y no deja distinguir un frame repetido
+  const qint64 driverNs = m_source->timestampNs();
+  m_driverTimestamps.store(driverNs > 0, std::memory_order_relaxed);
+  const qint64 timestampNs = driverNs > 0 ? driverNs : grabbedNs;
+  if (m_rateMonitor.update(timestampNs) == FrameRateMonitor::Arrival::Duplicate) {
+    return false;
+  }
+
+  // Límite de fps por si el origen da más de lo pedido (la negociación falló o el driver solo
+  // admite algunos ritmos): el siguiente frame toca un periodo después del último entregado,
+  // con un cuarto de periodo de margen para el jitter
+  const double requested = m_requestedFps.load(std::memory_order_relaxed);
+  if (requested > 0) {
+    const qint64 periodNs = qint64(1e9 / requested);
+    if (m_nextDueNs != 0 && timestampNs < m_nextDueNs - periodNs / 4) {
+      m_skippedFrames.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    // Sin acumular retraso: si el origen va más lento de lo pedido se sigue a su ritmo
+    m_nextDueNs = m_nextDueNs != 0 && timestampNs - m_nextDueNs < periodNs
+                      ? m_nextDueNs + periodNs
+                      : timestampNs + periodNs;
+  } else {
+    m_nextDueNs = 0;
+  }
+
+  const int decimation = m_decimation.load(std::memory_order_relaxed);
+  if (decimation != m_appliedDecimation) {
+    m_appliedDecimation = decimation;
+    m_decimationCounter = 0;
+    updateRecordingRate();
+  }
+  if (decimation > 1 && m_decimationCounter++ % decimation != 0) {
+    m_skippedFrames.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void VideoCaptureHandler::probeCapabilities() {
+  m_probePending = false;
+  FrameSource::CapabilityProbe probe = m_source->capabilityProbe();
+  if (!probe) {
+    probeOnCaptureThread();
+    return;
+  }
+  // El sondeo va al pool con su propio acceso al dispositivo: ni la quincena de consultas de los
+  // controles ni la enumeración de formatos retrasan los frames siguientes
+  const quint64 generation = m_sourceGeneration.load(std::memory_order_relaxed);
+  m_probeTasks.fetch_add(1, std::memory_order_relaxed);
+  m_workerPool->submit([this, probe = std::move(probe), generation,
+                        cached = m_capabilitiesCached, capabilities = m_capabilities,
+                        spec = m_sourceSpec, key = m_deviceKey]() mutable {
+    DeviceCapabilities probed;
+    if (!probe(probed)) {
+      qWarning() << "VideoCaptureHandler - No se pudo sondear el origen" << spec;
+    } else if (cached) {
+      applyCachedCapabilities(generation, std::move(capabilities), probed.ranges);
+    } else if (applyCapabilities(generation, probed, true) && !key.isEmpty()) {
+      DeviceCapabilityCache::shared().store(spec, key, probed);
+    }
+    m_probeTasks.fetch_sub(1, std::memory_order_release);
+  });
+}
+
+// Soporte, límites y formatos no cambian entre aperturas; los valores actuales sí pueden
+void VideoCaptureHandler::applyCachedCapabilities(
+    quint64 generation, DeviceCapabilities cached, const CameraPropertyRanges &probed) {
+  for (PropertyRange CameraPropertyRanges::*range :
+       {&CameraPropertyRanges::brightness, &CameraPropertyRanges::contrast,
+        &CameraPropertyRanges::saturation, &CameraPropertyRanges::sharpness,
+        &CameraPropertyRanges::exposure, &CameraPropertyRanges::focus}) {
+    (cached.ranges.*range).current = (probed.*range).current;
+  }
+  applyCapabilities(generation, cached, false);
+}
+
+bool VideoCaptureHandler::applyCapabilities(
+    quint64 generation, const DeviceCapabilities &capabilities, bool emitSupport) {
+  std::lock_guard<std::mutex> lock(m_analysisMutex);
+  if (generation != m_sourceGeneration.load(std::memory_order_relaxed)) {
+    return false; // Sondeo de un origen que ya no está abierto
+  }
+  if (emitSupport) {
+    emit propertiesSupported(capabilities.support);
+  }
+  emit rangesSupported(capabilities.ranges);
+  configureAutoControls(capabilities);
+  return true;
+}
+
+// Ficheros y patrones responden a get() sin ir al dispositivo; con DirectShow o MSMF la única vía
+// es el propio cv::VideoCapture, que no admite consultas a la vez que grab() en otro hilo
+void VideoCaptureHandler::probeOnCaptureThread() {
+  const quint64 generation = m_sourceGeneration.load(std::memory_order_relaxed);
+  if (m_capabilitiesCached) {
+    CameraPropertyRanges probed;
+    probed.brightness.current = m_source->get(cv::CAP_PROP_BRIGHTNESS);
+    probed.contrast.current = m_source->get(cv::CAP_PROP_CONTRAST);
+    probed.saturation.current = m_source->get(cv::CAP_PROP_SATURATION);
+    probed.sharpness.current = m_source->get(cv::CAP_PROP_SHARPNESS);
+    probed.exposure.current = m_source->get(cv::CAP_PROP_EXPOSURE);
+    probed.focus.current = m_source->get(cv::CAP_PROP_FOCUS);
+    applyCachedCapabilities(generation, m_capabilities, probed);
+    return;
+  }
+
+  CameraPropertyRanges &ranges = m_capabilities.ranges;
+  const std::pair<int, PropertyRange *> properties[] = {
+      {cv::CAP_PROP_BRIGHTNESS, &ranges.brightness},
+      {cv::CAP_PROP_CONTRAST, &ranges.contrast},
+      {cv::CAP_PROP_SATURATION, &ranges.saturation},
+      {cv::CAP_PROP_SHARPNESS, &ranges.sharpness},
+      {cv::CAP_PROP_EXPOSURE, &ranges.exposure},
+      {cv::CAP_PROP_FOCUS, &ranges.focus}};
+
+  // 1. Comprobación de propiedades soportadas
+  CameraPropertiesSupport &support = m_capabilities.support;
+  support.brightness = (m_source->get(cv::CAP_PROP_BRIGHTNESS) != 0);
+  support.contrast = (m_source->get(cv::CAP_PROP_CONTRAST) != 0);
+  support.saturation = (m_source->get(cv::CAP_PROP_SATURATION) != 0);
+  support.sharpness = (m_source->get(cv::CAP_PROP_SHARPNESS) != 0);
+  support.autoExposure = (m_source->get(cv::CAP_PROP_AUTO_EXPOSURE) != 0);
+  support.autoFocus = (m_source->get(cv::CAP_PROP_AUTOFOCUS) != 0);
+  // Si el driver da el rango real de la propiedad, es que la admite; si no, la comprobación de
+  // siempre, que no funciona en todas las cámaras
+  PropertyRange driverRange;
+  support.exposure = m_source->propertyRange(cv::CAP_PROP_EXPOSURE, driverRange) ||
+                     (m_source->get(cv::CAP_PROP_EXPOSURE) != 0);
+  support.focus = m_source->propertyRange(cv::CAP_PROP_FOCUS, driverRange) ||
+                  (m_source->get(cv::CAP_PROP_FOCUS) == 0);
+
+  // 2. Rangos y modos de captura
+  for (const auto &property : properties) {
+    *property.second = getPropertyRange(property.first);
+  }
+  m_capabilities.formats = m_source->captureFormats();
+  applyCapabilities(generation, m_capabilities, true);
+
+  // La escritura a disco no frena la captura
+  if (!m_deviceKey.isEmpty()) {
+    m_workerPool->submit(
+        [spec = m_sourceSpec, key = m_deviceKey, capabilities = m_capabilities] {
+          DeviceCapabilityCache::shared().store(spec, key, capabilities);
+        });
+  }
+}
+
+void VideoCaptureHandler::configureAutoControls(const DeviceCapabilities &capabilities) {
+  m_autoExposure.setRange(capabilities.ranges.exposure);
+  m_autoFocus.setRange(capabilities.ranges.focus);
+  m_canControlExposure = capabilities.support.exposure;
+  m_canControlFocus = capabilities.support.focus;
+  if (m_softwareFocus && m_canControlFocus) {
+    m_autoFocus.trigger();
+  }
+  m_controlsConfigured = true;
+}
+
+void VideoCaptureHandler::analyzeFrame(const CapturedFrame &frame) {
+  const bool exposure = m_softwareExposure.load(std::memory_order_relaxed);
+  const bool focus = m_softwareFocus.load(std::memory_order_relaxed);
+  if (!exposure && !focus && !m_statisticsEnabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_analysisMutex);
+    m_statistics.setRoi(m_statisticsRoi);
+  }
+  if (!m_statistics.compute(Yuv::luma(frame.image, frame.encoding), m_frameStatistics)) {
+    return;
+  }
+  m_frameStatistics.sequence = frame.sequence;
+  // La nitidez depende de la escala: si cambia la reducción de MJPEG (la vista previa o un flujo
+  // cambian de tamaño) no se puede comparar con la referencia del enfoque
+  const bool rescaled = m_analysisSize != cv::Size() && m_analysisSize != frame.image.size();
+  m_analysisSize = frame.image.size();
+
+  double exposureValue = 0;
+  double focusValue = 0;
+  bool moveExposure = false;
+  bool moveFocus = false;
+  {
+    std::lock_guard<std::mutex> lock(m_analysisMutex);
+    m_lastStatistics = m_frameStatistics;
+    if (rescaled) {
+      m_autoFocus.rescale();
+    }
+    if (m_controlsConfigured) {
+      moveExposure = exposure && m_canControlExposure &&
+                     m_autoExposure.update(m_frameStatistics, exposureValue);
+      moveFocus = focus && m_canControlFocus && m_autoFocus.update(m_frameStatistics, focusValue);
+    }
+  }
+  // Por la cola de órdenes, como los sliders: el hilo de captura los aplica entre frames
+  if (moveExposure) {
+    setExposure(qRound(exposureValue));
+  }
+  if (moveFocus) {
+    setFocus(qRound(focusValue));
+  }
+}
+
+void VideoCaptureHandler::setStatisticsEnabled(bool enabled) { m_statisticsEnabled = enabled; }
+
+void VideoCaptureHandler::setStatisticsRoi(const QRectF &roi) {
+  std::lock_guard<std::mutex> lock(m_analysisMutex);
+  m_statisticsRoi = roi;
+}
+
+void VideoCaptureHandler::setSoftwareAutoExposure(bool enabled, double targetLuma) {
+  std::lock_guard<std::mutex> lock(m_analysisMutex);
+  m_autoExposure.setTarget(targetLuma);
+  m_softwareExposure = enabled;
+}
+
+void VideoCaptureHandler::setSoftwareAutoFocus(bool enabled) {
+  std::lock_guard<std::mutex> lock(m_analysisMutex);
+  if (enabled && !m_softwareFocus) {
+    m_autoFocus.trigger();
+  }
+  m_softwareFocus = enabled;
+}
+
+void VideoCaptureHandler::triggerAutoFocus() {
+  std::lock_guard<std::mutex> lock(m_analysisMutex);
+  m_autoFocus.trigger();
+}
 
-          // 1. Comprobación de propiedades y emite qué propiedades son soportadas
-          CameraPropertiesSupport support;
-          support.brightness = (m_VideoCapture.get(cv::CAP_PROP_BRIGHTNESS) != 0);
-          support.contrast = (m_VideoCapture.get(cv::CAP_PROP_CONTRAST) != 0);
-          support.saturation = (m_VideoCapture.get(cv::CAP_PROP_SATURATION) != 0);
-          support.sharpness = (m_VideoCapture.get(cv::CAP_PROP_SHARPNESS) != 0);
-          support.autoExposure = (m_VideoCapture.get(cv::CAP_PROP_AUTO_EXPOSURE) != 0);
-          support.exposure = (m_VideoCapture.get(cv::CAP_PROP_EXPOSURE) != 0);
-          support.autoFocus = (m_VideoCapture.get(cv::CAP_PROP_AUTOFOCUS) != 0);
-          support.focus = (m_VideoCapture.get(cv::CAP_PROP_FOCUS) == 0); // No funciona en todas
-
-          emit propertiesSupported(support);
-
-          CameraPropertyRanges ranges;
-          ranges.brightness = getPropertyRange(cv::CAP_PROP_BRIGHTNESS);
-          ranges.contrast = getPropertyRange(cv::CAP_PROP_CONTRAST);
-          ranges.saturation = getPropertyRange(cv::CAP_PROP_SATURATION);
-          ranges.sharpness = getPropertyRange(cv::CAP_PROP_SHARPNESS);
-          ranges.exposure = getPropertyRange(cv::CAP_PROP_EXPOSURE);
-          ranges.focus = getPropertyRange(cv::CAP_PROP_FOCUS);
-          emit rangesSupported(ranges);
-
-          m_requestedAutoFocus = STOP_CAMERA;
-          m_requestedFocus = STOP_CAMERA;
-          m_requestedBrightness = STOP_CAMERA;
-          m_requestedContrast = STOP_CAMERA;
-          m_requestedSaturation = STOP_CAMERA;
-          m_requestedSharpness = STOP_CAMERA;
-          m_requestedAutoExposure = STOP_CAMERA;
-          m_requestedExposure = STOP_CAMERA;
+ImageAnalysis VideoCaptureHandler::imageAnalysis() const {
+  std::lock_guard<std::mutex> lock(m_analysisMutex);
+  ImageAnalysis analysis;
+  analysis.statistics = m_lastStatistics;
+  analysis.exposureEnabled = m_softwareExposure && m_canControlExposure;
+  analysis.exposureConverged = m_autoExposure.isConverged();
+  analysis.exposure = m_autoExposure.value();
+  analysis.focusEnabled = m_softwareFocus && m_canControlFocus;
+  analysis.focusState = m_autoFocus.state();
+  analysis.focus = m_autoFocus.value();
+  return analysis;
+}
+
+void VideoCaptureHandler::scheduleConversion() {
+  // Como mucho una tarea por cámara: así el anillo sigue teniendo un único consumidor
+  if (!m_conversionScheduled.exchange(true)) {
+    m_conversionTasks.fetch_add(1, std::memory_order_relaxed);
+    m_workerPool->submit([this] { convertPending(); });
+  }
+}
+
+void VideoCaptureHandler::convertPending() {
+  // Un frame por tarea para repartir el pool con las demás cámaras; si la conversión va lenta se
+  // salta a lo más reciente en vez de acumular retraso. Sin etapas de procesado, el pipeline
+  // llama a deliverFrame() aquí mismo.
+  if (!m_stopConversion && m_ring.popLatest(m_convertFrame)) {
+    CapturedFrame *frame = &m_convertFrame;
+    if (m_convertFrame.encoding == FrameEncoding::Mjpeg) {
+      // La decodificación MJPEG también se hace aquí y no en el hilo de captura. Solo la
+      // vista previa: basta con la escala más pequeña que siga cubriendo el tamaño mostrado.
+      // Los flujos de salida también cuentan: ninguno debe recibir menos de lo que pidió.
+      QSize target(m_previewWidth.load(), m_previewHeight.load());
+      const int streamsWidth = m_streamsWidth.load(std::memory_order_relaxed);
+      if (streamsWidth != 0) {
+        target = target.expandedTo(QSize(streamsWidth, m_streamsHeight.load()));
+      }
+      const cv::Size fullSize = Mjpeg::peekSize(m_convertFrame.image);
+      const bool fullWanted = m_pipeline.hasStages() || streamsWidth < 0;
+      const int reduction = fullWanted ? 1 : Mjpeg::reductionFor(fullSize, target);
+      frame = FrameDecoder::toBgr(m_convertFrame, m_decodedFrame, reduction) ? &m_decodedFrame
+                                                                             : nullptr;
+    } else if (Yuv::isYuv(m_convertFrame.encoding) && m_pipeline.hasStages()) {
+      // Las etapas trabajan en BGR; sin ellas el frame sigue en YUV hasta deliverFrame()
+      frame = FrameDecoder::toBgr(m_convertFrame, m_decodedFrame) ? &m_decodedFrame : nullptr;
+    }
+    if (frame) {
+      if (detectChanges(*frame)) {
+        const qint64 startNs = monotonicNowNs();
+        const bool delivered = m_pipeline.push(*frame);
+        if (frame->changes) {
+          m_changedDeliverNs.fetch_add(monotonicNowNs() - startNs, std::memory_order_relaxed);
+          if (delivered) {
+            m_changeDetector.commit(*frame->changes);
+          }
         }
-        m_currentCameraId = requestedCamId;
-      } else if (requestedCamId == STOP_CAMERA) {
-        m_currentCameraId = NULL_CAMERA;
       }
+      analyzeFrame(*frame); // Después de entregarlo: no añade latencia a la imagen
     }
+  }
 
-    if (m_VideoCapture.isOpened()) {
-      int reqValue = STOP_CAMERA;
-      reqValue = m_requestedBrightness.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_BRIGHTNESS, reqValue);
-      reqValue = m_requestedContrast.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_CONTRAST, reqValue);
-      reqValue = m_requestedSaturation.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_SATURATION, reqValue);
-      reqValue = m_requestedSharpness.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_SHARPNESS, reqValue);
-      reqValue = m_requestedAutoExposure.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_AUTO_EXPOSURE, reqValue);
-      reqValue = m_requestedExposure.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_EXPOSURE, reqValue);
-      reqValue = m_requestedAutoFocus.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_AUTOFOCUS, reqValue);
-      reqValue = m_requestedFocus.exchange(STOP_CAMERA);
-      if (reqValue != STOP_CAMERA)
-        m_VideoCapture.set(cv::CAP_PROP_FOCUS, reqValue);
-
-      m_VideoCapture >> m_frame;
-      if (!m_frame.empty()) {
-        m_pixmap = cvMatToQPixmap(m_frame);
-        emit newPixmapCaptured(m_pixmap);
-      }
-      QThread::msleep(10);
-    } else {
-      QThread::msleep(100);
+  m_conversionScheduled.store(false);
+  // Un frame publicado justo antes de bajar la marca no debe quedarse sin convertir
+  if (!m_stopConversion && m_ring.hasFrames()) {
+    scheduleConversion();
+  }
+  m_conversionTasks.fetch_sub(1, std::memory_order_release); // Último acceso a this
+}
+
+// Frames seguidos sin cambios tras los que se entrega uno igualmente: así la vista previa se
+// adapta a un cambio de tamaño de la ventana aunque la escena siga quieta
+static constexpr int kMaxUnchangedFrames = 15;
+
+std::shared_ptr<ChangeMask> VideoCaptureHandler::acquireChangeMask() {
+  for (std::shared_ptr<ChangeMask> &mask : m_changeMasks) {
+    if (!mask) {
+      mask = std::make_shared<ChangeMask>();
+      return mask;
+    }
+    // Solo aquí se reparten referencias, así que con una sola (la nuestra) nadie la puede coger
+    // entretanto. La barrera empareja con la liberación de la última copia en otro hilo.
+    if (mask.use_count() == 1) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return mask; // update() reutiliza la memoria de 'tiles' si no cambia la rejilla
     }
   }
+  // Todas en uso: el pipeline va muy retrasado; una de paso
+  return std::make_shared<ChangeMask>();
+}
 
-  m_VideoCapture.release();
-  qDebug() << "VideoCaptureHandler::run() - Hilo terminado y cámara liberada.";
+bool VideoCaptureHandler::detectChanges(CapturedFrame &frame) {
+  frame.changes.reset();
+  if (!m_changeDetection.load(std::memory_order_relaxed)) {
+    if (m_changeDetectorPrimed) {
+      m_changeDetector.reset(); // Al reactivarla se empieza de cero
+      m_changeDetectorPrimed = false;
+    }
+    return true;
+  }
+  m_changeDetector.setThreshold(m_changeThreshold.load(std::memory_order_relaxed));
+  const qint64 startNs = monotonicNowNs();
+  std::shared_ptr<ChangeMask> mask = acquireChangeMask();
+  const bool changed = m_changeDetector.update(Yuv::luma(frame.image, frame.encoding), *mask);
+  m_changeDetectorPrimed = true;
+  m_changeDetectNs.fetch_add(monotonicNowNs() - startNs, std::memory_order_relaxed);
+
+  if (!changed && ++m_unchangedRun < kMaxUnchangedFrames) {
+    m_unchangedFrames.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  m_unchangedRun = 0;
+  m_changedFrames.fetch_add(1, std::memory_order_relaxed);
+  frame.changes = std::move(mask);
+  return true;
+}
+
+void VideoCaptureHandler::setChangeDetection(bool enabled, double threshold) {
+  m_changeThreshold.store(threshold, std::memory_order_relaxed);
+  m_changeDetection.store(enabled, std::memory_order_relaxed);
+}
+
+ChangeDetectionStats VideoCaptureHandler::changeDetectionStats() const {
+  ChangeDetectionStats stats;
+  stats.unchanged = m_unchangedFrames.load(std::memory_order_relaxed);
+  stats.delivered = m_changedFrames.load(std::memory_order_relaxed);
+  stats.detectMs = m_changeDetectNs.load(std::memory_order_relaxed) / 1e6;
+  // Coste de un frame entregado: la conversión (o la entrada al pipeline) más cada etapa
+  double perFrameMs = 0;
+  if (stats.delivered > 0) {
+    perFrameMs = m_changedDeliverNs.load(std::memory_order_relaxed) / 1e6 / stats.delivered;
+  }
+  for (const FramePipeline::StageStats &stage : m_pipeline.stageStats()) {
+    perFrameMs += stage.averageMs;
+  }
+  stats.savedMs = stats.unchanged * perFrameMs;
+  return stats;
 }
 
-QImage VideoCaptureHandler::cvMatToQImage(const cv::Mat &inMat) {
-  switch (inMat.type()) {
-  case CV_8UC4: {
-    QImage image(
-        inMat.data, inMat.cols, inMat.rows, static_cast<int>(inMat.step), QImage::Format_ARGB32);
-    return image;
+void VideoCaptureHandler::deliverFrame(const CapturedFrame &frame) {
+  static const QMetaMethod frameSignal =
+      QMetaMethod::fromSignal(&VideoCaptureHandler::newFrameCaptured);
+  static const QMetaMethod pixmapSignal =
+      QMetaMethod::fromSignal(&VideoCaptureHandler::newPixmapCaptured);
+  const cv::Mat &image = frame.image;
+  const bool yuv = Yuv::isYuv(frame.encoding);
+  const QImage::Format format =
+      yuv ? QImage::Format_RGB32 : PixelConvert::targetFormat(image.type());
+  if (format == QImage::Format_Invalid) {
+    qWarning() << "VideoCaptureHandler::deliverFrame() - cv::Mat image type not handled:"
+               << image.type();
+    return;
+  }
+
+  // Solo se convierte lo que alguien va a usar: la resolución completa para el callback y las
+  // señales, y la vista previa ya reducida al tamaño en pantalla
+  const bool pixmapWanted = isSignalConnected(pixmapSignal);
+  const bool fullWanted = m_frameCallback || isSignalConnected(frameSignal) || pixmapWanted;
+  const cv::Size imageSize = yuv ? Yuv::imageSize(image, frame.encoding) : image.size();
+  const cv::Size previewSize = previewSizeFor(imageSize);
+  const bool previewScaled = m_previewCallback && previewSize != imageSize;
+
+  FrameTimestamps timestamps = frame.timestamps;
+  timestamps.mark(FrameTiming::Processed);
+
+  FrameHandle full;
+  if (fullWanted || (m_previewCallback && !previewScaled)) {
+    full = cvMatToFrame(image, frame.encoding, format, m_framePool);
   }
-  case CV_8UC3: {
-    QImage image(
-        inMat.data, inMat.cols, inMat.rows, static_cast<int>(inMat.step), QImage::Format_RGB888);
-    return image.rgbSwapped();
+  FrameHandle preview = full;
+  m_pyramid.reset(image, frame.encoding);
+  if (previewScaled) {
+    // Promedio de áreas antes de convertir: hay menos píxeles que convertir y la GUI pinta la
+    // imagen tal cual, sin escalar, sea cual sea la resolución de la cámara. El YUV se reduce
+    // sin salir de YUV, a tamaño par.
+    const cv::Mat &scaled = m_pyramid.scaled(previewSize);
+    if (!scaled.empty()) {
+      preview = cvMatToFrame(scaled, frame.encoding, format, m_previewPool);
+    }
   }
-  case CV_8UC1: {
-    QImage image(
-        inMat.data, inMat.cols, inMat.rows, static_cast<int>(inMat.step),
-        QImage::Format_Grayscale8);
+  timestamps.mark(FrameTiming::Converted);
+  m_timing.record(timestamps, FrameTiming::Process, FrameTiming::Convert);
 
-    return image;
+  for (FrameHandle *handle : {&full, &preview}) {
+    if (!handle->isNull()) {
+      handle->setSequence(frame.sequence);
+      handle->setCaptureTimeNs(frame.captureTimeNs);
+      handle->setTimestamps(timestamps);
+    }
   }
-  default:
-    qWarning() << "ASM::cvMatToQImage() - cv::Mat image type not handled in "
-                  "switch:"
-               << inMat.type();
+
+  if (!full.isNull()) {
+    if (m_frameCallback) {
+      m_frameCallback(full);
+    }
+    emit newFrameCaptured(full);
+    if (pixmapWanted) {
+      emit newPixmapCaptured(QPixmap::fromImage(full.image()));
+    }
+  }
+  if (m_previewCallback && !preview.isNull()) {
+    m_previewCallback(preview);
+  }
+
+  // Lo ya convertido se ofrece a los flujos de salida antes de convertir nada más
+  m_produced.clear();
+  if (format == QImage::Format_RGB32 || format == QImage::Format_ARGB32_Premultiplied) {
+    for (const FrameHandle &handle : {full, preview}) {
+      if (!handle.isNull()) {
+        m_produced.push_back(
+            {cv::Size(handle.mat().cols, handle.mat().rows), OutputStreamConfig::Format::Rgb32,
+             handle});
+      }
+    }
+  }
+  deliverStreams(frame, imageSize, timestamps);
+  m_produced.clear(); // Los buffers vuelven a sus pools en cuanto los sueltan los consumidores
+  m_pyramid.clear();
+}
+
+namespace {
+
+// Lleva 'image' (ya al tamaño final, en la codificación del frame) al formato del flujo,
+// directamente en 'dst', el buffer del pool con el tipo de FramePool::matTypeFor()
+void convertForStream(
+    const cv::Mat &image, FrameEncoding encoding, OutputStreamConfig::Format format, cv::Mat &dst,
+    bool parallel) {
+  const bool yuv = Yuv::isYuv(encoding);
+  switch (format) {
+  case OutputStreamConfig::Format::Rgb32:
+    if (yuv) {
+      Yuv::toRgb32(image, encoding, dst, parallel);
+    } else {
+      PixelConvert::convertToRgb32(image, dst, parallel);
+    }
     break;
+  case OutputStreamConfig::Format::Bgr:
+    if (yuv) {
+      cv::cvtColor(
+          image, dst,
+          encoding == FrameEncoding::Nv12 ? cv::COLOR_YUV2BGR_NV12 : cv::COLOR_YUV2BGR_YUY2);
+    } else if (image.channels() == 3) {
+      image.copyTo(dst);
+    } else {
+      cv::cvtColor(image, dst, image.channels() == 4 ? cv::COLOR_BGRA2BGR : cv::COLOR_GRAY2BGR);
+    }
+    break;
+  case OutputStreamConfig::Format::Gray: {
+    // Con YUV no hay conversión de color: la luma ya está en la imagen
+    const cv::Mat luma = yuv ? Yuv::luma(image, encoding) : image;
+    if (luma.channels() == 1) {
+      luma.copyTo(dst);
+    } else if (luma.channels() == 2) {
+      cv::extractChannel(luma, dst, 0);
+    } else {
+      cv::cvtColor(luma, dst, luma.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    }
+    break;
+  }
+  }
+}
+
+} // namespace
+
+void VideoCaptureHandler::deliverStreams(
+    const CapturedFrame &frame, const cv::Size &imageSize, const FrameTimestamps &timestamps) {
+  std::lock_guard<std::mutex> deliveryLock(m_streamDeliveryMutex);
+  const quint64 version = m_streamsVersion.load(std::memory_order_acquire);
+  if (version != m_activeStreamsVersion) {
+    std::lock_guard<std::mutex> lock(m_streamsMutex);
+    m_activeStreams = m_streams;
+    m_activeStreamsVersion = version;
+  }
+
+  for (const std::shared_ptr<OutputStream> &stream : m_activeStreams) {
+    const OutputStreamConfig &config = stream->config;
+    if (stream->seen++ % quint64(config.decimation) != 0) {
+      continue;
+    }
+    cv::Size size = imageSize;
+    if (!config.maxSize.isEmpty()) {
+      const QSize fitted =
+          QSize(imageSize.width, imageSize.height).scaled(config.maxSize, Qt::KeepAspectRatio);
+      if (fitted.width() < imageSize.width && !fitted.isEmpty()) {
+        size = cv::Size(fitted.width(), fitted.height());
+      }
+    }
+    if (Yuv::isYuv(frame.encoding) && size != imageSize) {
+      size = cv::Size(qMax(2, size.width & ~1), qMax(2, size.height & ~1));
+    }
+
+    FrameHandle output;
+    for (const ProducedFrame &produced : m_produced) {
+      if (produced.size == size && produced.format == config.format) {
+        output = produced.frame;
+        stream->shared.fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+    }
+    if (output.isNull()) {
+      const cv::Mat &scaled = m_pyramid.scaled(size);
+      if (scaled.empty()) {
+        continue;
+      }
+      QImage::Format qtFormat = QImage::Format_Grayscale8;
+      if (config.format == OutputStreamConfig::Format::Bgr) {
+        qtFormat = QImage::Format_BGR888;
+      } else if (config.format == OutputStreamConfig::Format::Rgb32) {
+        qtFormat = Yuv::isYuv(frame.encoding) ? QImage::Format_RGB32
+                                              : PixelConvert::targetFormat(scaled.type());
+      }
+      if (qtFormat == QImage::Format_Invalid) {
+        continue;
+      }
+      output = stream->pool->acquire(size.width, size.height, qtFormat);
+      if (output.isNull()) {
+        stream->dropped.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      convertForStream(scaled, frame.encoding, config.format, output.mat(), m_parallelConversion);
+      output.setSequence(frame.sequence);
+      output.setCaptureTimeNs(frame.captureTimeNs);
+      output.setTimestamps(timestamps);
+      m_produced.push_back({size, config.format, output});
+    }
+    stream->delivered.fetch_add(1, std::memory_order_relaxed);
+    stream->callback(output);
   }
-  return QImage();
 }
 
-QPixmap VideoCaptureHandler::cvMatToQPixmap(const cv::Mat &inMat) {
-  return QPixmap::fromImage(cvMatToQImage(inMat));
-}
\ No newline at end of file
+cv::Size VideoCaptureHandler::previewSizeFor(const cv::Size &frameSize) const {
+  const QSize target(m_previewWidth.load(), m_previewHeight.load());
+  const QSize fitted = QSize(frameSize.width, frameSize.height).scaled(target, Qt::KeepAspectRatio);
+  // Sin tamaño conocido o si la pantalla es mayor que el frame no se escala
+  if (target.isEmpty() || fitted.width() >= frameSize.width || fitted.isEmpty()) {
+    return frameSize;
+  }
+  return cv::Size(fitted.width(), fitted.height());
+}
+
+FrameHandle VideoCaptureHandler::cvMatToFrame(
+    const cv::Mat &image, FrameEncoding encoding, QImage::Format format, FramePool &pool) {
+  const bool yuv = Yuv::isYuv(encoding);
+  const cv::Size size = yuv ? Yuv::imageSize(image, encoding) : image.size();
+  FrameHandle frame = pool.acquire(size.width, size.height, format);
+  if (!frame.isNull()) {
+    // Una sola pasada directamente al buffer del pool, en el formato nativo de 32 bits de Qt
+    if (yuv) {
+      Yuv::toRgb32(image, encoding, frame.mat(), m_parallelConversion);
+    } else {
+      PixelConvert::convertToRgb32(image, frame.mat(), m_parallelConversion);
+    }
+  }
+  return frame;
+}
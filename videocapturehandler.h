@@ -1,13 +1,34 @@
 #ifndef VIDEOCAPTUREHANDLER_H
 #define VIDEOCAPTUREHANDLER_H
 
+#include "autocontrol.h"
+#include "cameracommandqueue.h"
+#include "devicecapabilities.h"
+#include "framepipeline.h"
+#include "framepool.h"
+#include "framepyramid.h"
+#include "frameratemonitor.h"
+#include "framerecorder.h"
+#include "pretriggerbuffer.h"
+#include "sharedframepublisher.h"
+#include "sourcestandby.h"
+#include "framering.h"
+#include "framesource.h"
+#include "frametiming.h"
+#include "workstealingpool.h"
 #include <QImage>
 #include <QMetaType>
 #include <QPixmap>
+#include <QRectF>
 #include <QSize>
 #include <QThread>
+#include <array>
 #include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 #define ID_CAMERA_DEFAULT 0
 
@@ -17,45 +38,172 @@
 
 #define NULL_CAMERA -1
 
-// ... (Struct CameraPropertiesSupport sin cambios, excepto por el comentario) ...
-// Estructura para informar qué propiedades de cámara son soportadas (bool)
-struct CameraPropertiesSupport {
-  bool autoFocus = false;
-  bool focus = true;
-  bool autoExposure = false;
-  bool exposure = false;
-  bool brightness = false;
-  bool contrast = false;
-  bool saturation = false;
-  bool sharpness = false;
+// Contadores de captura: frames leídos de la cámara y frames que el consumidor no llegó a leer
+struct CaptureStats {
+  quint64 captured = 0;
+  quint64 dropped = 0;
+  quint64 poolExhausted = 0; // Frames sin buffer libre en el pool (los consumidores no los sueltan)
+  quint64 processingDropped = 0; // Frames que no entraron en el pipeline por ir retrasado
+  // Según las marcas de tiempo del origen (FrameRateMonitor)
+  quint64 sourceLost = 0;       // Huecos: frames que el driver o la cámara no llegaron a dar
+  quint64 sourceDuplicates = 0; // Frames repetidos, que no se entregan
+  quint64 skipped = 0;          // Leídos pero no entregados por el diezmado o el límite de fps
+  double requestedFps = 0;      // 0 = el que dé el origen
+  double negotiatedFps = 0;     // El que dice el origen tras pedírselo; 0 = no lo dice
+  double achievedFps = 0;       // Medido en el último segundo, antes de diezmar
+  bool driverTimestamps = false; // Marcas del driver; si no, el instante de grab()
 };
-Q_DECLARE_METATYPE(CameraPropertiesSupport)
 
-// --- NUEVO: Estructuras para rangos dinámicos de propiedades ---
-struct PropertyRange {
-  double min = 0;
-  double max = 255;
-  double current = 0; // Valor actual o por defecto
+// Frames que la detección de cambios ahorró convertir y pintar
+struct ChangeDetectionStats {
+  quint64 unchanged = 0; // Frames descartados por no haber cambiado
+  quint64 delivered = 0; // Frames entregados con la detección activa
+  double detectMs = 0;   // Tiempo total de detección
+  double savedMs = 0;    // Estimación: frames descartados x coste medio de entregar uno
 };
 
-struct CameraPropertyRanges {
-  PropertyRange brightness;
-  PropertyRange contrast;
-  PropertyRange saturation;
-  PropertyRange sharpness;
-  PropertyRange focus;
-  PropertyRange exposure;
+// Último resultado de las estadísticas de imagen y estado de los controles por software
+struct ImageAnalysis {
+  ImageStatistics statistics; // samples == 0 si aún no hay ninguno
+  bool exposureEnabled = false;
+  bool exposureConverged = false;
+  double exposure = 0;
+  bool focusEnabled = false;
+  SoftwareAutoFocus::State focusState = SoftwareAutoFocus::State::Idle;
+  double focus = 0;
+};
+
+// Recibe cada frame convertido directamente en el hilo de conversión, sin pasar por la cola de
+// eventos de Qt (sin reservas de memoria por frame)
+using FrameCallback = std::function<void(const FrameHandle &frame)>;
+
+// Flujo de salida a la medida de un consumidor (VideoCaptureHandler::addOutputStream())
+struct OutputStreamConfig {
+  enum class Format {
+    Rgb32, // Como la vista previa: Format_RGB32 (o ARGB32 premultiplicado con BGRA)
+    Bgr,   // Format_BGR888, mat() CV_8UC3 como lo usa OpenCV
+    Gray,  // Format_Grayscale8, mat() CV_8UC1; con YUV es la luma tal cual
+  };
+  QSize maxSize; // Vacío = resolución completa; si no, se reduce sin deformar
+  Format format = Format::Rgb32;
+  int decimation = 1; // Se entrega uno de cada N frames
+  int poolSize = 4;   // Frames que el consumidor puede retener a la vez
+};
+
+struct OutputStreamStats {
+  quint64 delivered = 0;
+  quint64 shared = 0;  // Entregados sin convertir: otro flujo o la vista previa ya lo había hecho
+  quint64 dropped = 0; // Sin buffer libre en su pool: el consumidor va retrasado
 };
-Q_DECLARE_METATYPE(CameraPropertyRanges)
-// --- FIN NUEVO ---
 
 class VideoCaptureHandler : public QThread {
   Q_OBJECT
 public:
-  VideoCaptureHandler(QObject *parent = nullptr);
+  VideoCaptureHandler(QObject *parent = nullptr, int ringDepth = 4, int poolSize = 8);
   ~VideoCaptureHandler();
 
+  CaptureStats captureStats() const;
+
+  // Deben configurarse antes de start(). setFrameCallback() recibe los frames a resolución
+  // completa y setPreviewCallback() los recibe ya reducidos al tamaño de setPreviewSize().
+  void setFrameCallback(FrameCallback callback);
+  void setPreviewCallback(FrameCallback callback);
+  void setWorkerPool(WorkStealingPool *pool);
+
+  // Reparte cada conversión entre varios hilos. Con muchas cámaras a la vez conviene desactivarlo:
+  // el paralelismo ya lo da convertir varias cámaras en el pool compartido.
+  void setParallelConversion(bool enabled) { m_parallelConversion = enabled; }
+
+  // Ritmo pedido al origen (0 = el suyo). Se negocia con CAP_PROP_FPS al abrirlo, después de
+  // formato y resolución, y se puede cambiar en marcha. El ritmo lo marca la lectura bloqueante
+  // del driver; si da más de lo pedido, lo que sobra se descarta por marca de tiempo sin llegar a
+  // leerlo (retrieve), que es lo que cuesta CPU.
+  void setTargetFrameRate(double fps);
+  // Entrega uno de cada 'n' frames: los demás se sacan del driver para que no se le acaben los
+  // buffers, pero no se decodifican ni llegan a ningún consumidor, tampoco a la grabación. Para
+  // diezmar solo a un consumidor está OutputStreamConfig::decimation.
+  void setCaptureDecimation(int n) { m_decimation = qMax(1, n); }
+
+  // Tamaño en píxeles al que se va a mostrar (se puede cambiar en marcha). La vista previa se
+  // escala a este tamaño en el hilo de conversión, y con orígenes MJPEG se decodifica ya reducida
+  // cuando no hay etapas de procesado que necesiten la resolución completa.
+  void setPreviewSize(const QSize &size);
+
+  // Flujos de salida, cada uno con su tamaño, formato y diezmado (p.ej. 640 px para mostrar,
+  // 1/4 en gris para análisis, resolución completa para guardar): en vez de que cada consumidor
+  // reduzca el frame completo por su cuenta, cada tamaño se calcula una vez por frame con una
+  // pirámide compartida con la vista previa (FramePyramid), y dos flujos iguales o iguales a la
+  // vista previa reciben el mismo buffer. El callback se llama en el hilo de conversión. Se
+  // pueden añadir y quitar en marcha; addOutputStream() devuelve el id para los demás métodos.
+  // removeOutputStream() espera a que termine la entrega en curso: al volver, el callback ya no
+  // se llama y se ha destruido. Por eso no se puede llamar desde el propio callback.
+  int addOutputStream(const OutputStreamConfig &config, FrameCallback callback);
+  void removeOutputStream(int id);
+  OutputStreamStats outputStreamStats(int id) const;
+
+  // Etapas de procesado entre la captura y la conversión; se pueden cambiar en marcha
+  void setProcessingStages(const QVector<FramePipeline::Stage> &stages);
+  QVector<FramePipeline::StageStats> processingStats() const { return m_pipeline.stageStats(); }
+
+  // Histogramas por etapa; el hilo de captura y la conversión registran hasta Convert, y el
+  // consumidor (FramePresenter) puede registrar el resto sobre el mismo objeto
+  FrameTimingStats &timingStats() { return m_timing; }
+
+  // Graba los frames capturados (antes del procesado) sin frenar la captura; ver FrameRecorder
+  void startRecording(
+      std::unique_ptr<FrameSink> sink,
+      FrameRecorder::Policy policy = FrameRecorder::Policy::DropNewest);
+  void stopRecording() { m_recorder.stop(); }
+  FrameRecorder::Stats recordingStats() const { return m_recorder.stats(); }
+
+  // Pre-grabación: mantiene los últimos segundos en un PreTriggerBuffer y triggerClip() los
+  // vuelca, junto con los 'postSeconds' siguientes, a 'clip'. Solo desde el hilo de la GUI.
+  void startPreTrigger(const PreTriggerBuffer::Config &config);
+  void stopPreTrigger();
+  bool triggerClip(std::unique_ptr<FrameSink> clip, double postSeconds);
+  PreTriggerBuffer::Stats preTriggerStats() const;
+
+  // Publica los frames capturados en memoria compartida para otros procesos del equipo, que los
+  // leen con SharedFrameClient. La copia va en el hilo de un FrameRecorder, como la grabación, y
+  // si no da abasto se pierden frames de la publicación, nunca de la captura.
+  void startSharing(const SharedFramePublisher::Config &config);
+  void stopSharing() { m_sharingRecorder.stop(); }
+  FrameRecorder::Stats sharingStats() const { return m_sharingRecorder.stats(); }
+
+  // Entrega los frames capturados, sin decodificar si vienen en MJPEG, a un destino de streaming
+  // (MjpegServer::sink()); igual que la grabación, nunca frena la captura
+  void startStreaming(std::shared_ptr<FrameSink> sink);
+  void stopStreaming() { m_streamingRecorder.stop(); }
+
+  // Estadísticas por frame (histograma de luma, percentiles, nitidez) en la tarea de conversión,
+  // después de entregar el frame. Se calculan también, aunque no se pidan, con la exposición o el
+  // enfoque por software, que mueven la cámara con setExposure()/setFocus() como los sliders (la
+  // cámara debe tener sus modos automáticos desactivados). Se pueden cambiar en marcha.
+  void setStatisticsEnabled(bool enabled);
+  void setStatisticsRoi(const QRectF &roi); // Relativa al frame (0..1); vacía = todo
+  void setSoftwareAutoExposure(bool enabled, double targetLuma = 110);
+  void setSoftwareAutoFocus(bool enabled); // Al activarlo empieza una búsqueda
+  void triggerAutoFocus();
+  ImageAnalysis imageAnalysis() const;
+
+  // Detección de cambios (ChangeDetector) en la tarea de conversión: los frames sin cambios no
+  // pasan por el procesado ni se convierten ni se pintan (sí se graban y se analizan). Los que
+  // se entregan llevan en CapturedFrame::changes las teselas cambiadas, para las etapas con
+  // maskedFunction. Se puede cambiar en marcha.
+  void setChangeDetection(bool enabled, double threshold = 4.0);
+  ChangeDetectionStats changeDetectionStats() const;
+
+  // Cambio de origen sin corte: el nuevo se abre en un hilo auxiliar mientras el actual sigue
+  // capturando, y se cambia entre dos frames. Además se mantienen abiertos los 'keepWarm' últimos
+  // orígenes usados, con lo que volver a uno de ellos es inmediato (ver SourceStandby).
+  void setHotSwap(bool enabled, int keepWarm = 2);
+
+  // Detiene el hilo aunque esté esperando órdenes con la cámara cerrada
+  void stop();
+
   void requestCameraChange(int cameraId, const QSize &resolution);
+  // Cualquier origen admitido por FrameSource::create() (v4l2:0, file:..., synthetic:...)
+  void requestSourceChange(const QString &sourceSpec, const QSize &resolution);
 
   void setAutoFocus(bool manual);
   void setAutoExposure(bool manual);
@@ -67,6 +215,8 @@ public:
   void setExposure(int value);
 
 signals:
+  void newFrameCaptured(const FrameHandle &frame);
+  // Compatibilidad: solo se construye el QPixmap si hay alguien conectado
   void newPixmapCaptured(const QPixmap &pixmap);
   void propertiesSupported(CameraPropertiesSupport support);
   void rangesSupported(const CameraPropertyRanges &ranges);
@@ -76,27 +226,174 @@ protected:
   void run() override;
 
 private:
-  QPixmap m_pixmap;
-  cv::Mat m_frame;
-  cv::VideoCapture m_VideoCapture;
+  std::unique_ptr<FrameSource> m_source; // Nulo si no hay nada abierto
+
+  // Ritmo del origen. Salvo los atómicos, todo esto solo lo toca el hilo de captura.
+  FrameRateMonitor m_rateMonitor;
+  std::atomic<double> m_requestedFps{0};
+  std::atomic<double> m_negotiatedFps{0};
+  std::atomic<int> m_decimation{1};
+  std::atomic<quint64> m_skippedFrames{0};
+  std::atomic<bool> m_driverTimestamps{false};
+  double m_nativeFps{0}; // El del origen al abrirlo, para volver a él con setTargetFrameRate(0)
+  int m_appliedDecimation{1};
+  quint64 m_decimationCounter{0};
+  qint64 m_nextDueNs{0}; // Límite de fps: marca a partir de la cual toca el siguiente frame
+  void negotiateFrameRate();
+  void updateRecordingRate(); // Ritmo de los frames entregados, para los FrameRecorder
+  bool acceptGrabbedFrame(qint64 grabbedNs); // false si no hay que leerlo ni entregarlo
+
+  // El hilo de captura (run) solo hace grab()/retrieve() sobre el anillo; la conversión y el
+  // envío a los consumidores se hacen como tareas en el pool compartido, de una en una por
+  // cámara, para no frenar la lectura de la cámara
+  FrameRing m_ring;
+  quint64 m_frameSequence{0};
+
+  WorkStealingPool *m_workerPool;
+  CapturedFrame m_convertFrame; // Solo lo usa la tarea de conversión en curso
+  CapturedFrame m_decodedFrame; // Ídem, para frames MJPEG decodificados
+  ChangeDetector m_changeDetector; // Ídem
+  // Ídem. Máscaras que se reutilizan entre frames en lugar de reservar una nueva cada vez; una
+  // está libre cuando ya no la tiene ningún frame en el pipeline
+  std::array<std::shared_ptr<ChangeMask>, 8> m_changeMasks;
+  std::shared_ptr<ChangeMask> acquireChangeMask();
+  int m_unchangedRun{0};           // Ídem: frames seguidos sin entregar
+  bool m_changeDetectorPrimed{false};
+  std::atomic<bool> m_changeDetection{false};
+  std::atomic<double> m_changeThreshold{4.0};
+  std::atomic<quint64> m_unchangedFrames{0};
+  std::atomic<quint64> m_changedFrames{0};
+  std::atomic<qint64> m_changeDetectNs{0};
+  std::atomic<qint64> m_changedDeliverNs{0}; // Coste de entregar los frames cambiados
+  std::atomic<int> m_previewWidth{0};
+  std::atomic<int> m_previewHeight{0};
+  std::atomic<bool> m_conversionScheduled{false};
+  std::atomic<int> m_conversionTasks{0};
+  std::atomic<bool> m_stopConversion{false};
+  std::atomic<bool> m_parallelConversion{true};
+
+  // Buffers de salida ya convertidos, compartidos sin copia con los consumidores
+  FramePool m_framePool;
+  FrameCallback m_frameCallback;
+  // Vista previa: otro pool para que alternar tamaños no obligue a reservar buffers
+  FramePool m_previewPool;
+  FrameCallback m_previewCallback;
+  FramePyramid m_pyramid; // Reducciones del frame entregado; solo la usa deliverFrame()
+
+  struct OutputStream {
+    int id = 0;
+    OutputStreamConfig config;
+    FrameCallback callback;
+    std::unique_ptr<FramePool> pool;
+    quint64 seen = 0; // Solo desde deliverFrame(), para el diezmado
+    std::atomic<quint64> delivered{0};
+    std::atomic<quint64> shared{0};
+    std::atomic<quint64> dropped{0};
+  };
+  // Lo que ya se ha convertido en el frame en curso, para no repetirlo entre flujos
+  struct ProducedFrame {
+    cv::Size size;
+    OutputStreamConfig::Format format;
+    FrameHandle frame;
+  };
+  mutable std::mutex m_streamsMutex;
+  std::vector<std::shared_ptr<OutputStream>> m_streams; // Protegido por m_streamsMutex
+  int m_nextStreamId{1};
+  std::atomic<quint64> m_streamsVersion{0};
+  // Cogido durante toda la entrega a los flujos; removeOutputStream() lo espera. Nunca junto con
+  // m_streamsMutex salvo en ese orden.
+  std::mutex m_streamDeliveryMutex;
+  // Copia de m_streams para deliverFrame(), que solo se renueva cuando cambia la versión
+  std::vector<std::shared_ptr<OutputStream>> m_activeStreams; // Protegido por el anterior
+  quint64 m_activeStreamsVersion{0};
+  // Flujos quitados cuyos consumidores aún retienen frames de su pool (ver FramePool::isIdle());
+  // protegido por m_streamsMutex
+  std::vector<std::shared_ptr<OutputStream>> m_retiredStreams;
+  void releaseRetiredStreams(); // Con m_streamsMutex cogido
+  std::vector<ProducedFrame> m_produced;
+  // Mayor tamaño pedido por los flujos, para no decodificar MJPEG más reducido de la cuenta;
+  // -1 = alguno quiere la resolución completa
+  std::atomic<int> m_streamsWidth{0};
+  std::atomic<int> m_streamsHeight{0};
+
+  FramePipeline m_pipeline;
+  FrameTimingStats m_timing;
+  FrameRecorder m_recorder;
+  FrameRecorder m_preTriggerRecorder{4};
+  FrameRecorder m_sharingRecorder{4};
+  FrameRecorder m_streamingRecorder{2};
+  std::shared_ptr<PreTriggerBuffer> m_preTrigger;
+
+  void scheduleConversion();
+  void convertPending();
+  void analyzeFrame(const CapturedFrame &frame);
+  bool detectChanges(CapturedFrame &frame); // false si no hay que entregarlo
+  // Con los rangos del origen abierto; hay que tener m_analysisMutex
+  void configureAutoControls(const DeviceCapabilities &capabilities);
+
+  // m_statistics, m_frameStatistics y m_analysisSize solo los usa la tarea de conversión; el
+  // resto de la analítica se comparte con la GUI y el hilo de captura bajo m_analysisMutex
+  FrameStatistics m_statistics;
+  ImageStatistics m_frameStatistics;
+  cv::Size m_analysisSize; // Tamaño del último frame analizado (MJPEG llega más o menos reducido)
+  mutable std::mutex m_analysisMutex;
+  ImageStatistics m_lastStatistics;
+  QRectF m_statisticsRoi;
+  SoftwareAutoExposure m_autoExposure;
+  SoftwareAutoFocus m_autoFocus;
+  bool m_controlsConfigured{false};
+  bool m_canControlExposure{false};
+  bool m_canControlFocus{false};
+  std::atomic<bool> m_statisticsEnabled{false};
+  std::atomic<bool> m_softwareExposure{false};
+  std::atomic<bool> m_softwareFocus{false};
+  void deliverFrame(const CapturedFrame &frame);
+  void deliverStreams(
+      const CapturedFrame &frame, const cv::Size &imageSize, const FrameTimestamps &timestamps);
 
   int m_currentCameraId{ID_CAMERA_DEFAULT};
 
-  std::atomic<int> m_requestedCamera{NO_OP_CAMERA};
-  std::atomic<int> m_requestedWidth{0};
-  std::atomic<int> m_requestedHeight{0};
-
-  std::atomic<int> m_requestedAutoFocus{STOP_CAMERA};
-  std::atomic<int> m_requestedFocus{STOP_CAMERA};
-  std::atomic<int> m_requestedAutoExposure{STOP_CAMERA};
-  std::atomic<int> m_requestedExposure{STOP_CAMERA};
-  std::atomic<int> m_requestedBrightness{STOP_CAMERA};
-  std::atomic<int> m_requestedContrast{STOP_CAMERA};
-  std::atomic<int> m_requestedSaturation{STOP_CAMERA};
-  std::atomic<int> m_requestedSharpness{STOP_CAMERA};
-
-  QImage cvMatToQImage(const cv::Mat &inMat);
-  QPixmap cvMatToQPixmap(const cv::Mat &inMat);
+  // Órdenes de la GUI; el hilo de captura las consume entre frames o esperando si no hay cámara
+  CameraCommandQueue m_commands;
+  std::vector<CameraCommand> m_commandBatch;
+
+  void processCommands();
+  void openSource(const CameraCommand &command);
+  void openBlocking(const CameraCommand &command, const QString &spec);
+  void swapToOpenedSource();
+  void adoptSource(
+      const CameraCommand &command, const QString &spec, std::unique_ptr<FrameSource> source);
+  // Al cambiar de origen: a la reserva con el cambio sin corte activo; si no, se cierra
+  void closeSource();
+  void reportOpenFailure(int cameraId, const QString &spec);
+
+  SourceStandby m_standby;
+  std::atomic<bool> m_hotSwap{false};
+  QSize m_sourceResolution;
+
+  // Capacidades del origen abierto. Con el dispositivo en DeviceCapabilityCache se emiten al
+  // abrir sin consultar nada; el sondeo completo (o la relectura de los valores actuales, si
+  // venían de la caché) espera a que el primer frame ya esté en camino.
+  QString m_sourceSpec;
+  QString m_deviceKey;
+  DeviceCapabilities m_capabilities;
+  bool m_capabilitiesCached{false};
+  bool m_probePending{false};
+  // Cambia con cada origen adoptado (bajo m_analysisMutex), para descartar sondeos de uno anterior
+  std::atomic<quint64> m_sourceGeneration{0};
+  std::atomic<int> m_probeTasks{0}; // Sondeos en el pool que aún usan 'this'
+  void probeCapabilities();
+  void probeOnCaptureThread(); // Para orígenes sin FrameSource::capabilityProbe()
+  // Desde cualquier hilo; false si entretanto se ha adoptado otro origen
+  bool applyCapabilities(
+      quint64 generation, const DeviceCapabilities &capabilities, bool emitSupport);
+  // Capacidades de la caché con los valores actuales de 'probed'
+  void applyCachedCapabilities(
+      quint64 generation, DeviceCapabilities cached, const CameraPropertyRanges &probed);
+
+  FrameHandle cvMatToFrame(
+      const cv::Mat &image, FrameEncoding encoding, QImage::Format format, FramePool &pool);
+  cv::Size previewSizeFor(const cv::Size &frameSize) const;
 
   PropertyRange getPropertyRange(int propId);
 };
@@ -0,0 +1,35 @@
+#include "videofilesink.h"
+#include <QDebug>
+#include <opencv2/imgproc.hpp>
+
+VideoFileSink::VideoFileSink(const QString &path, int fourcc) : m_path(path), m_fourcc(fourcc) {
+  if (m_fourcc == 0) {
+    m_fourcc = m_path.endsWith(".mp4", Qt::CaseInsensitive)
+                   ? cv::VideoWriter::fourcc('m', 'p', '4', 'v')
+                   : cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+  }
+}
+
+bool VideoFileSink::open(const cv::Size &size, int type, double fps) {
+  m_size = size;
+  const bool isColor = CV_MAT_CN(type) != 1;
+  if (!m_writer.open(m_path.toStdString(), m_fourcc, fps, size, isColor)) {
+    qWarning() << "VideoFileSink::open() - No se pudo crear" << m_path;
+    return false;
+  }
+  return true;
+}
+
+bool VideoFileSink::write(const CapturedFrame &frame) {
+  // VideoWriter no admite cambios de tamaño a mitad de fichero
+  if (!m_writer.isOpened() || frame.image.size() != m_size) {
+    return false;
+  }
+  if (frame.image.type() == CV_8UC4) {
+    cv::cvtColor(frame.image, m_bgr, cv::COLOR_BGRA2BGR);
+    m_writer.write(m_bgr);
+  } else {
+    m_writer.write(frame.image);
+  }
+  return true;
+}
@@ -0,0 +1,27 @@
+#ifndef VIDEOFILESINK_H
+#define VIDEOFILESINK_H
+
+#include "framesink.h"
+#include <opencv2/videoio.hpp>
+
+// Fichero de vídeo a través de cv::VideoWriter. Sin fourcc explícito se elige por la extensión:
+// .mp4 -> mp4v, cualquier otra (.avi, .mkv) -> MJPG, que cuesta poco de codificar.
+class VideoFileSink : public FrameSink {
+public:
+  explicit VideoFileSink(const QString &path, int fourcc = 0);
+
+  bool open(const cv::Size &size, int type, double fps) override;
+  bool write(const CapturedFrame &frame) override;
+  void close() override { m_writer.release(); }
+
+  QString description() const override { return m_path; }
+
+private:
+  const QString m_path;
+  int m_fourcc;
+  cv::Size m_size;
+  cv::VideoWriter m_writer;
+  cv::Mat m_bgr; // Conversión de BGRA a BGR reutilizada entre frames
+};
+
+#endif // VIDEOFILESINK_H
@@ -0,0 +1,95 @@
+#include "workstealingpool.h"
+#include <algorithm>
+
+namespace {
+// Índice del hilo actual dentro de su pool (-1 fuera de un pool)
+thread_local const WorkStealingPool *t_pool = nullptr;
+thread_local int t_workerIndex = -1;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threadCount) {
+  if (threadCount <= 0) {
+    threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  for (int i = 0; i < threadCount; ++i) {
+    m_workers.push_back(std::make_unique<Worker>());
+  }
+  for (int i = 0; i < threadCount; ++i) {
+    m_workers[i]->thread = std::thread([this, i] { workerLoop(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_stopping = true;
+  }
+  m_sleepCondition.notify_all();
+  for (auto &worker : m_workers) {
+    worker->thread.join();
+  }
+}
+
+WorkStealingPool &WorkStealingPool::shared() {
+  static WorkStealingPool pool;
+  return pool;
+}
+
+void WorkStealingPool::submit(Task task) {
+  const int count = threadCount();
+  const int index = t_pool == this ? t_workerIndex
+                                   : static_cast<int>(m_nextWorker.fetch_add(1) % count);
+  {
+    std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+    m_workers[index]->tasks.push_back(std::move(task));
+  }
+  m_queuedTasks.fetch_add(1, std::memory_order_release);
+  { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+  m_sleepCondition.notify_one();
+}
+
+bool WorkStealingPool::takeTask(int index, Task &task) {
+  // Primero la cola propia, por el final
+  {
+    Worker &own = *m_workers[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  // Después se roba por el principio de las demás, empezando por la siguiente
+  const int count = threadCount();
+  for (int offset = 1; offset < count; ++offset) {
+    Worker &victim = *m_workers[(index + offset) % count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::workerLoop(int index) {
+  t_pool = this;
+  t_workerIndex = index;
+  Task task;
+  while (true) {
+    if (takeTask(index, task)) {
+      m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+      task();
+      task = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_sleepCondition.wait(lock, [this] {
+      return m_stopping || m_queuedTasks.load(std::memory_order_acquire) > 0;
+    });
+    if (m_stopping) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos con robo de trabajo, compartido por todas las cámaras.
+//
+// Cada hilo tiene su propia cola: saca sus tareas por el final (lo más reciente, aún en caché) y,
+// cuando se queda sin trabajo, roba por el principio de la cola de otro hilo. Así N cámaras
+// comparten tantos hilos como núcleos en lugar de un hilo de conversión por cámara.
+class WorkStealingPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingPool(int threadCount = 0); // 0 = un hilo por núcleo
+  ~WorkStealingPool();
+
+  static WorkStealingPool &shared();
+
+  // Desde un hilo del pool la tarea va a su propia cola; desde fuera se reparte por turnos
+  void submit(Task task);
+
+  int threadCount() const { return static_cast<int>(m_workers.size()); }
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::thread thread;
+  };
+
+  void workerLoop(int index);
+  bool takeTask(int index, Task &task);
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::atomic<unsigned> m_nextWorker{0};
+  std::atomic<int> m_queuedTasks{0};
+
+  std::mutex m_sleepMutex;
+  std::condition_variable m_sleepCondition;
+  bool m_stopping{false};
+};
+
+#endif // WORKSTEALINGPOOL_H
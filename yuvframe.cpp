@@ -0,0 +1,81 @@
+#include "yuvframe.h"
+#include "framedecoder.h"
+#include "pixelconvert.h"
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// Plano UV de un NV12 visto como CV_8UC2 de la mitad de ancho y alto, sin copiar
+cv::Mat chromaPlane(const cv::Mat &data) {
+  const int height = data.rows * 2 / 3;
+  return cv::Mat(
+      height / 2, data.cols / 2, CV_8UC2, const_cast<uchar *>(data.ptr<uchar>(height)),
+      data.step);
+}
+
+bool isValid(const cv::Mat &data, FrameEncoding encoding) {
+  switch (encoding) {
+  case FrameEncoding::Yuyv:
+    return !data.empty() && data.type() == CV_8UC2 && data.cols % 2 == 0;
+  case FrameEncoding::Nv12:
+    return !data.empty() && data.type() == CV_8UC1 && data.rows % 3 == 0 && data.cols % 2 == 0;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+cv::Size Yuv::imageSize(const cv::Mat &data, FrameEncoding encoding) {
+  if (encoding == FrameEncoding::Nv12) {
+    return cv::Size(data.cols, data.rows * 2 / 3);
+  }
+  return data.size();
+}
+
+cv::Mat Yuv::luma(const cv::Mat &data, FrameEncoding encoding) {
+  if (encoding == FrameEncoding::Nv12) {
+    return data.rowRange(0, data.rows * 2 / 3);
+  }
+  return data;
+}
+
+bool Yuv::toRgb32(const cv::Mat &data, FrameEncoding encoding, cv::Mat &out, bool parallel) {
+  if (encoding == FrameEncoding::Nv12) {
+    return PixelConvert::nv12ToRgb32(data, out, parallel);
+  }
+  return encoding == FrameEncoding::Yuyv && PixelConvert::yuyvToRgb32(data, out, parallel);
+}
+
+bool Yuv::toBgr(const cv::Mat &data, FrameEncoding encoding, cv::Mat &out) {
+  if (!isValid(data, encoding)) {
+    return false;
+  }
+  FrameDecoder::detachShared(out);
+  cv::cvtColor(
+      data, out, encoding == FrameEncoding::Nv12 ? cv::COLOR_YUV2BGR_NV12 : cv::COLOR_YUV2BGR_YUY2);
+  return !out.empty();
+}
+
+bool Yuv::resize(const cv::Mat &data, FrameEncoding encoding, cv::Size size, cv::Mat &out) {
+  size = cv::Size(qMax(2, size.width & ~1), qMax(2, size.height & ~1));
+  if (!isValid(data, encoding)) {
+    return false;
+  }
+  FrameDecoder::detachShared(out);
+  if (encoding == FrameEncoding::Yuyv) {
+    // Cada pareja Y0 U Y1 V como un píxel de 4 canales: al promediar por canal las Y pares, las
+    // impares, la U y la V se reducen cada una por su lado y el resultado sigue siendo YUYV
+    const cv::Mat pairs(data.rows, data.cols / 2, CV_8UC4, data.data, data.step);
+    out.create(size.height, size.width, CV_8UC2);
+    cv::Mat outPairs(size.height, size.width / 2, CV_8UC4, out.data, out.step);
+    cv::resize(pairs, outPairs, outPairs.size(), 0, 0, cv::INTER_AREA);
+    return true;
+  }
+  out.create(size.height * 3 / 2, size.width, CV_8UC1);
+  cv::Mat outLuma = out.rowRange(0, size.height);
+  cv::Mat outChroma = chromaPlane(out);
+  cv::resize(luma(data, encoding), outLuma, size, 0, 0, cv::INTER_AREA);
+  cv::resize(chromaPlane(data), outChroma, outChroma.size(), 0, 0, cv::INTER_AREA);
+  return true;
+}
@@ -0,0 +1,38 @@
+#ifndef YUVFRAME_H
+#define YUVFRAME_H
+
+#include "capturedframe.h"
+#include <opencv2/core.hpp>
+
+// Frames YUV tal y como los entrega la cámara (CAP_PROP_CONVERT_RGB a 0), sin pasar por BGR.
+//
+// La luma ya está en la imagen: las estadísticas y el detector de cambios la leen directamente, y
+// la vista previa se convierte a RGB32 en una sola pasada sobre el buffer de presentación
+// (PixelConvert::yuyvToRgb32/nv12ToRgb32). Solo se pasa a BGR para quien necesita píxeles BGR
+// (etapas de procesado, grabación).
+namespace Yuv {
+
+inline bool isYuv(FrameEncoding encoding) {
+  return encoding == FrameEncoding::Yuyv || encoding == FrameEncoding::Nv12;
+}
+
+// Tamaño de la imagen en píxeles (en NV12 el cv::Mat tiene también las filas del plano UV)
+cv::Size imageSize(const cv::Mat &data, FrameEncoding encoding);
+
+// Luma sin copiar: en NV12 el plano Y (CV_8UC1); en YUYV la propia imagen, CV_8UC2 con la Y en el
+// canal 0, que es como la leen FrameStatistics y ChangeDetector
+cv::Mat luma(const cv::Mat &data, FrameEncoding encoding);
+
+// A Format_RGB32 (CV_8UC4) en una pasada
+bool toRgb32(const cv::Mat &data, FrameEncoding encoding, cv::Mat &out, bool parallel = true);
+
+// A BGR. Reutiliza el buffer de 'out' si nadie más lo está usando.
+bool toBgr(const cv::Mat &data, FrameEncoding encoding, cv::Mat &out);
+
+// Reduce por promedio de áreas sin salir de YUV, para convertir menos píxeles. 'size' se
+// redondea a par; 'out' tiene la misma codificación que 'data'.
+bool resize(const cv::Mat &data, FrameEncoding encoding, cv::Size size, cv::Mat &out);
+
+} // namespace Yuv
+
+#endif // YUVFRAME_H